@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_CHANGE_POLICY_H
+#define MIRAL_WINDOW_CHANGE_POLICY_H
+
+#include "miral/version.h"
+
+#include <cstdint>
+
+namespace miral
+{
+struct WindowInfo;
+
+/// An attribute of a window that can be changed by WindowManagerTools::modify_window()
+enum class WindowChange : uint32_t
+{
+    name                    = 1u << 0,
+    type                    = 1u << 1,
+    parent                  = 1u << 2,
+    state                   = 1u << 3,
+    top_left                = 1u << 4,
+    size                    = 1u << 5,
+    min_width               = 1u << 6,
+    min_height              = 1u << 7,
+    max_width               = 1u << 8,
+    max_height              = 1u << 9,
+    width_inc               = 1u << 10,
+    height_inc              = 1u << 11,
+    min_aspect              = 1u << 12,
+    max_aspect              = 1u << 13,
+    output_id               = 1u << 14,
+    preferred_orientation   = 1u << 15,
+    confine_pointer         = 1u << 16,
+    shell_chrome            = 1u << 17,
+    userdata                = 1u << 18,
+    input_shape             = 1u << 19,
+};
+
+/// The set of attributes changed by a modification
+class WindowChanges
+{
+public:
+    void insert(WindowChange change) { changes |= static_cast<uint32_t>(change); }
+
+    void insert(WindowChanges const& other) { changes |= other.changes; }
+
+    auto contains(WindowChange change) const -> bool { return changes & static_cast<uint32_t>(change); }
+
+    auto empty() const -> bool { return !changes; }
+
+private:
+    uint32_t changes{0};
+};
+
+/**
+ *  Advise the attributes of a window changed by modify_window().
+ *
+ *  \note This interface is intended to be implemented by a WindowManagementPolicy
+ *  implementation, we can't add these functions directly to that interface without
+ *  breaking ABI (the vtab could be incompatible).
+ *  When initializing the window manager this interface will be detected by
+ *  dynamic_cast and registered accordingly.
+ */
+class WindowChangePolicy
+{
+public:
+/** @name notification of WM events that the policy may need to track.
+ * These calls happen "under lock". They should not call
+ * WindowManagerTools::invoke_under_lock()
+ *  @{ */
+
+    /** Notification that a modification has changed a window.
+     *  This follows the changes (and any advise_move_to(), advise_resize() and
+     *  advise_state_change() they cause), and only happens if something changed.
+     *  For WindowManagerTools::modify_windows() it follows all the changes to all
+     *  the windows.
+     *
+     * @param window_info   the window
+     * @param changes       the attributes that changed
+     */
+    virtual void advise_window_changed(WindowInfo const& window_info, WindowChanges const& changes);
+
+/** @} */
+
+    virtual ~WindowChangePolicy() = default;
+    WindowChangePolicy() = default;
+    WindowChangePolicy(WindowChangePolicy const&) = delete;
+    WindowChangePolicy& operator=(WindowChangePolicy const&) = delete;
+};
+#if MIRAL_VERSION >= MIR_VERSION_NUMBER(2, 0, 0)
+#error "We've presumably broken ABI - please roll this interface into WindowManagementPolicy"
+#endif
+}
+
+#endif //MIRAL_WINDOW_CHANGE_POLICY_H
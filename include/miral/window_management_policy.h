@@ -34,14 +34,21 @@ struct WindowInfo;
 
 using namespace mir::geometry;
 
-/// The interface through which the window management policy is determined.
+/** The interface through which the window management policy is determined.
+ *
+ * \note All calls to the policy are made while holding the window manager lock
+ * exclusively, bracketed by advise_begin() and advise_end(). (This includes the
+ * work done in a WindowManagerTools::invoke_under_lock() callback.) The policy
+ * is never called while the lock is held in shared mode by
+ * WindowManagerTools::invoke_under_shared_lock().
+ */
 class WindowManagementPolicy
 {
 public:
-    /// before any related calls begin
+    /// before any related calls begin (the lock is held exclusively)
     virtual void advise_begin();
 
-    /// after any related calls end
+    /// after any related calls end (the lock is still held exclusively)
     virtual void advise_end();
 
     /** Customize initial window placement
@@ -169,8 +176,12 @@ public:
      *  These windows are ordered with parents before children,
      *  and form a single tree rooted at the first element.
      *
+     *  Raising a window raises the tree of its topmost ancestor, and this is advised once
+     *  for the whole tree (not once for each ancestor). The windows are in the order they
+     *  are stacked: the raised window and each of its ancestors follow their siblings.
+     *
      * @param windows   the windows
-     * \note The relative Z-order of these windows will be maintained, they will be raised en bloc.
+     * \note The windows will be raised en bloc, in this order.
      */
     virtual void advise_raise(std::vector<Window> const& windows);
 /** @} */
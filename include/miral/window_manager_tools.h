@@ -24,8 +24,13 @@
 
 #include <mir/geometry/displacement.h>
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace mir
 {
@@ -54,6 +59,44 @@ class Workspace;
 
 class WindowManagerToolsImplementation;
 
+/// Counts of the pointer motion events handled by the window manager
+struct PointerMotionCounts
+{
+    uint64_t received;  ///< motion events received
+    uint64_t merged;    ///< motion events merged (while the window manager was busy) instead of handled
+    uint64_t coalesced; ///< merged events handled in their place
+};
+
+/// The latency of calls to a window management policy hook. The durations are
+/// accurate to about 6% (they are the upper bounds of histogram buckets).
+struct PolicyHookLatency
+{
+    std::string hook;                   ///< the name of the hook (e.g. "handle_pointer_event")
+    uint64_t calls;                     ///< calls timed
+    std::chrono::nanoseconds total;     ///< time spent in all calls
+    std::chrono::nanoseconds median;
+    std::chrono::nanoseconds p90;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds p999;
+    std::chrono::nanoseconds max;
+};
+
+/// The time a window manager entry point spent waiting for, and then holding, the
+/// window manager's lock. (With the same accuracy as PolicyHookLatency.)
+struct LockLatency
+{
+    std::string entry_point;            ///< the name of the entry point (e.g. "add_surface")
+    uint64_t acquisitions;              ///< times the lock was taken
+    std::chrono::nanoseconds wait_total;
+    std::chrono::nanoseconds wait_median;
+    std::chrono::nanoseconds wait_p99;
+    std::chrono::nanoseconds wait_max;
+    std::chrono::nanoseconds hold_total;
+    std::chrono::nanoseconds hold_median;
+    std::chrono::nanoseconds hold_p99;
+    std::chrono::nanoseconds hold_max;
+};
+
 /// Window management functions for querying and updating MirAL's model
 class WindowManagerTools
 {
@@ -110,6 +153,12 @@ public:
      */
     auto info_for(Window const& window) const -> WindowInfo&;
 
+    /** execute functor for each window (in no particular order)
+     *
+     * @param functor the functor
+     */
+    void for_each_window(std::function<void(WindowInfo& info)> const& functor);
+
     /** retrieve metadata for a persistent surface id
      *
      * @param id        the persistent surface id
@@ -160,6 +209,11 @@ public:
     /// Find the topmost window at the cursor
     auto window_at(mir::geometry::Point cursor) const -> Window;
 
+    /// Find the visible windows that intersect rect, topmost first
+    /// \note the stacking order is that set by the window manager (windows are stacked
+    /// as they are added and raised)
+    auto windows_intersecting(mir::geometry::Rectangle const& rect) const -> std::vector<Window>;
+
     /// Find the active display area
     auto active_display() -> mir::geometry::Rectangle const;
 
@@ -172,6 +226,20 @@ public:
     /// Apply modifications to a window
     void modify_window(Window const& window, WindowSpecification const& modifications);
 
+    /** Apply modifications to several windows (in order) as one change.
+     *  All the modifications are checked before any are applied, so if one is invalid
+     *  none are applied. The active window is only changed (and raised) once all the
+     *  windows have been modified, and each window changed is then advised to
+     *  WindowChangePolicy::advise_window_changed() once.
+     *  \note The other notifications of each modification (such as advise_state_change(),
+     *  advise_move_to() and advise_resize()) are not deferred: they are made as each
+     *  modification is applied, as they are for modify_window().
+     *
+     * @param modifications the windows and the modifications for each
+     * @throw               runtime_error if any of the modifications is invalid
+     */
+    void modify_windows(std::vector<std::pair<Window, WindowSpecification>> const& modifications);
+
     /// Set a default size and position to reflect state change
     void place_and_size_for_state(WindowSpecification& modifications, WindowInfo const& window_info) const;
 
@@ -234,6 +302,32 @@ public:
      */
     void invoke_under_lock(std::function<void()> const& callback);
 
+    /** Multi-thread support for readers
+     *  Allows threads that don't hold a lock on the model to acquire a shared lock and
+     *  query the model concurrently with other readers.
+     *  The callback may only use the member functions that do not update the model
+     *  (count_applications(), find_application(), for_each_application(), info_for(),
+     *  for_each_window(), active_window(), window_at(), active_display(), info_for_window_id(),
+     *  id_for_window(), place_and_size_for_state(), for_each_workspace_containing() and
+     *  for_each_window_in_workspace()) and must not modify the info objects it is given.
+     *  The WindowManagementPolicy is not called while a shared lock is held.
+     *  This should NOT be used by a thread that has called the WindowManagementPolicy methods (and
+     *  already holds the lock).
+     */
+    void invoke_under_shared_lock(std::function<void()> const& callback);
+
+    /// Counts of the pointer motion handled so far. Motion is only merged if enabled
+    /// with the "window-management-coalesce-motion" option.
+    auto pointer_motion_counts() const -> PointerMotionCounts;
+
+    /// The latencies of the policy hooks called so far (those that have been called).
+    /// Hooks are only timed if enabled with the "window-management-hook-latency" option.
+    auto policy_latencies() const -> std::vector<PolicyHookLatency>;
+
+    /// The latencies of the entry points that have taken the lock so far. The lock is
+    /// only timed if enabled with the "window-management-lock-latency" option.
+    auto lock_latencies() const -> std::vector<LockLatency>;
+
 private:
     WindowManagerToolsImplementation* tools;
 };
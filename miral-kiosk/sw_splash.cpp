@@ -18,12 +18,13 @@
 
 #include "sw_splash.h"
 
+#include "../miral-shell/pixels/pixels.h"
+
 #include <mir/client/window.h>
 
 #include <mir_toolkit/mir_buffer_stream.h>
 
 #include <chrono>
-#include <cstring>
 #include <thread>
 #include <mutex>
 #include <mir/client/window_spec.h>
@@ -71,17 +72,7 @@ auto create_window(MirConnection* connection, MirPixelFormat pixel_format) -> mi
 
 void render_pattern(MirGraphicsRegion *region, uint8_t pattern[])
 {
-    char *row = region->vaddr;
-
-    for (int j = 0; j < region->height; j++)
-    {
-        uint32_t *pixel = (uint32_t*)row;
-
-        for (int i = 0; i < region->width; i++)
-            memcpy(pixel+i, pattern, sizeof pixel[i]);
-
-        row += region->stride;
-    }
+    pixels::fill(*region, pixels::pixel(pattern));
 }
 }
 
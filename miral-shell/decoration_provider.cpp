@@ -18,8 +18,8 @@
 
 #include "decoration_provider.h"
 #include "titlebar_config.h"
+#include "pixels/pixels.h"
 
-#include <mir/client/display_config.h>
 #include <mir/client/window_spec.h>
 
 #include <mir_toolkit/mir_buffer_stream.h>
@@ -27,17 +27,22 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
 #include <locale>
 #include <codecvt>
 #include <string>
 #include <cstring>
 #include <sstream>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #include <iostream>
 
 namespace
 {
 int const title_bar_height = 12;
+FT_UInt const title_pixel_size = 10;
 char const* const wallpaper_name = "wallpaper";
 
 void null_window_callback(MirWindow*, void*) {}
@@ -48,6 +53,36 @@ struct preferred_codecvt : std::codecvt_byname<wchar_t, char, std::mbstate_t>
     ~preferred_codecvt() = default;
 };
 
+// A rendered glyph
+struct Glyph
+{
+    int left;
+    int top;
+    int advance_x;
+    int advance_y;
+    unsigned int width;
+    unsigned int rows;
+    std::vector<unsigned char> coverage;    ///< width*rows (no padding)
+};
+
+// The glyph coverage of a title, laid out as it is drawn in a titlebar
+struct TitleRun
+{
+    int width;
+    int height;
+    std::vector<int> glyph_ends;            ///< the right edge of each glyph
+    std::vector<unsigned char> coverage;    ///< width*height
+
+    // Glyphs that don't fit are not drawn (rather than drawing part of them)
+    auto visible_width(int region_width) const -> int
+    {
+        int result = 0;
+        for (auto const end : glyph_ends)
+            if (end <= region_width && end > result) result = end;
+        return result;
+    }
+};
+
 struct Printer
 {
     Printer();
@@ -55,6 +90,7 @@ struct Printer
     Printer(Printer const&) = delete;
     Printer& operator=(Printer const&) = delete;
 
+    /// Paint a titlebar: the background at intensity, with the title
     void print(MirGraphicsRegion const& region, std::string const& title, int const intensity);
     void printhelp(MirGraphicsRegion const& region);
 
@@ -64,9 +100,27 @@ private:
     bool working = false;
     FT_Library lib;
     FT_Face face;
+    FT_UInt pixel_size = 0;
+
+    // Glyphs are rendered once, and titles laid out once: repainting a titlebar
+    // (e.g. when focus changes) only blends the coverage into the buffer
+    std::map<std::tuple<FT_Face, FT_UInt, wchar_t>, Glyph> glyphs;
+    std::map<std::pair<std::string, int>, TitleRun> title_runs;
+    static std::size_t const max_title_runs = 256;
+
+    auto glyph(FT_UInt size, wchar_t ch) -> Glyph const&;
+    auto title_run(std::string const& title, int height) -> TitleRun const&;
+    auto find_title_run(std::string const& title, int height) -> TitleRun const*;
 };
 
-void paint_surface(MirWindow* surface, std::string const& title, int const intensity)
+auto same(TitlebarContent const& lhs, TitlebarContent const& rhs) -> bool
+{
+    return lhs.intensity == rhs.intensity && lhs.width == rhs.width && lhs.height == rhs.height && lhs.title == rhs.title;
+}
+
+// Software buffer streams don't report the buffer age, so the whole buffer is
+// painted unless the titlebar would look the same as it does now
+void paint_surface(MirWindow* surface, std::string const& title, int const intensity, TitlebarContent& shown)
 {
     MirBufferStream* buffer_stream = mir_window_get_buffer_stream(surface);
 
@@ -78,17 +132,19 @@ void paint_surface(MirWindow* surface, std::string const& title, int const inten
     MirGraphicsRegion region;
     mir_buffer_stream_get_graphics_region(buffer_stream, &region);
 
-    char* row = region.vaddr;
+    TitlebarContent const wanted{title, intensity, region.width, region.height};
 
-    for (int j = 0; j != region.height; ++j)
-    {
-        memset(row, intensity, 4*region.width);
-        row += region.stride;
-    }
+    // E.g. a focus change that leaves the titlebar as it was
+    if (same(shown, wanted))
+        return;
+
+    // FreeType faces mustn't be shared between threads, so each has its own
+    thread_local Printer printer;
 
-    static Printer printer;
     printer.print(region, title, intensity);
 
+    shown = wanted;
+
     mir_buffer_stream_swap_buffers_sync(buffer_stream);
 }
 
@@ -104,7 +160,8 @@ Printer::Printer()
         return;
     }
 
-    FT_Set_Pixel_Sizes(face, 0, 10);
+    FT_Set_Pixel_Sizes(face, 0, title_pixel_size);
+    pixel_size = title_pixel_size;
     working = true;
 }
 
@@ -117,50 +174,121 @@ Printer::~Printer()
     }
 }
 
-void Printer::print(MirGraphicsRegion const& region, std::string const& title_, int const intensity)
-try
+auto Printer::glyph(FT_UInt size, wchar_t ch) -> Glyph const&
 {
-    if (!working)
-        return;
+    auto const key = std::make_tuple(face, size, ch);
+
+    auto const cached = glyphs.find(key);
+    if (cached != glyphs.end())
+        return cached->second;
+
+    if (size != pixel_size)
+    {
+        FT_Set_Pixel_Sizes(face, 0, size);
+        pixel_size = size;
+    }
+
+    FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
+    auto const slot = face->glyph;
+    FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL);
+
+    auto const& bitmap = slot->bitmap;
+    Glyph result{
+        slot->bitmap_left, slot->bitmap_top,
+        static_cast<int>(slot->advance.x >> 6), static_cast<int>(slot->advance.y >> 6),
+        bitmap.width, bitmap.rows, std::vector<unsigned char>(bitmap.width*bitmap.rows)};
+
+    for (auto row = 0u; row != bitmap.rows; ++row)
+        memcpy(result.coverage.data() + row*bitmap.width, bitmap.buffer + row*bitmap.pitch, bitmap.width);
+
+    return glyphs.emplace(key, std::move(result)).first->second;
+}
+
+auto Printer::title_run(std::string const& title_, int height) -> TitleRun const&
+{
+    auto const key = std::make_pair(title_, height);
+
+    auto const cached = title_runs.find(key);
+    if (cached != title_runs.end())
+        return cached->second;
+
+    // Titles can change a lot (e.g. terminals), so don't keep them all
+    if (title_runs.size() == max_title_runs)
+        title_runs.clear();
 
-    auto title = converter.from_bytes(title_);
+    auto const title = converter.from_bytes(title_);
 
     int base_x = 2;
-    int base_y = region.height-2;
+    int base_y = height-2;
+
+    TitleRun run{0, height, {}, {}};
+    std::vector<Glyph const*> placed;
 
     for (auto const& ch : title)
     {
-        FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
-        auto const glyph = face->glyph;
-        FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
+        auto const& g = glyph(title_pixel_size, ch);
+        placed.push_back(&g);
 
-        auto const& bitmap = glyph->bitmap;
-        auto const x = base_x + glyph->bitmap_left;
+        run.glyph_ends.push_back(base_x + g.left + static_cast<int>(g.width));
+        run.width = std::max(run.width, run.glyph_ends.back());
 
-        if (static_cast<int>(x + bitmap.width) <= region.width)
-        {
-            unsigned char* src = bitmap.buffer;
+        base_x += g.advance_x;
+    }
 
-            auto const y = base_y - glyph->bitmap_top;
-            char* dest = region.vaddr + y*region.stride + 4*x;
+    run.coverage.resize(run.width*height);
+    base_x = 2;
 
-            for (auto row = 0u; row != std::min(bitmap.rows, glyph->bitmap_top+2u); ++row)
-            {
-                for (auto col = 0u; col != bitmap.width; ++col)
-                    memset(dest+ 4*col, (intensity*(0xff^src[col]))/0xff, 4);
+    for (auto const g : placed)
+    {
+        auto const x = base_x + g->left;
+        auto const y = base_y - g->top;
 
-                src += bitmap.pitch;
-                dest += region.stride;
-            }
+        // The glyph is clipped to two pixels below the baseline (the bottom of the titlebar)
+        for (auto row = 0; row < std::min(static_cast<int>(g->rows), g->top+2); ++row)
+        {
+            if (y + row < 0 || y + row >= height) continue;
+
+            auto const src = g->coverage.data() + row*g->width;
+            auto const dest = run.coverage.data() + (y + row)*run.width;
+
+            for (auto col = 0; col != static_cast<int>(g->width); ++col)
+                if (x + col >= 0) dest[x + col] = std::max(dest[x + col], src[col]);
         }
 
-        base_x += glyph->advance.x >> 6;
-        base_y += glyph->advance.y >> 6;
+        base_x += g->advance_x;
+        base_y += g->advance_y;
+    }
+
+    return title_runs.emplace(key, std::move(run)).first->second;
+}
+
+auto Printer::find_title_run(std::string const& title, int height) -> TitleRun const*
+{
+    if (working)
+    try
+    {
+        return &title_run(title, height);
+    }
+    catch (...)
+    {
+        std::cerr << "WARNING: failed render title: \"" <<  title << "\"\n";
     }
+
+    return nullptr;
 }
-catch (...)
+
+void Printer::print(MirGraphicsRegion const& region, std::string const& title, int const intensity)
 {
-    std::cerr << "WARNING: failed render title: \"" <<  title_ << "\"\n";
+    auto const run = find_title_run(title, region.height);
+    auto const visible_width = run ? run->visible_width(region.width) : 0;
+
+    // Every byte of the pixel (including any "x" byte) is intensity, and the title is black
+    auto const background = 0x01010101u*intensity;
+
+    if (visible_width)
+        pixels::blend(pixels::columns(region, 0, visible_width), run->coverage.data(), run->width, 0, background);
+
+    pixels::fill(pixels::columns(region, visible_width, region.width - visible_width), background);
 }
 
 void Printer::printhelp(MirGraphicsRegion const& region)
@@ -194,24 +322,20 @@ void Printer::printhelp(MirGraphicsRegion const& region)
     unsigned int help_height = 0;
     unsigned int line_height = 0;
 
+    auto const fwidth = static_cast<FT_UInt>(std::min(region.width / 60, 20));
+
     for (auto const* rawline : helptext)
     {
         int line_width = 0;
 
         auto const line = converter.from_bytes(rawline);
 
-        auto const fwidth = std::min(region.width / 60, 20);
-
-        FT_Set_Pixel_Sizes(face, fwidth, 0);
-
         for (auto const& ch : line)
         {
-            FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
-            auto const glyph = face->glyph;
-            FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
+            auto const& g = glyph(fwidth, ch);
 
-            line_width += glyph->advance.x >> 6;
-            line_height = std::max(line_height, glyph->bitmap.rows + glyph->bitmap.rows/2);
+            line_width += g.advance_x;
+            line_height = std::max(line_height, g.rows + g.rows/2);
         }
 
         if (help_width < line_width) help_width = line_width;
@@ -228,26 +352,22 @@ void Printer::printhelp(MirGraphicsRegion const& region)
 
         for (auto const& ch : line)
         {
-            FT_Load_Glyph(face, FT_Get_Char_Index(face, ch), FT_LOAD_DEFAULT);
-            auto const glyph = face->glyph;
-            FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
+            auto const& g = glyph(fwidth, ch);
+            auto const x = base_x + g.left;
 
-            auto const& bitmap = glyph->bitmap;
-            auto const x = base_x + glyph->bitmap_left;
-
-            if (static_cast<int>(x + bitmap.width) <= region.width)
+            if (static_cast<int>(x + g.width) <= region.width)
             {
-                unsigned char* src = bitmap.buffer;
+                unsigned char const* src = g.coverage.data();
 
-                auto const y = base_y - glyph->bitmap_top;
+                auto const y = base_y - g.top;
                 char* dest = region.vaddr + y * region.stride + 4 * x;
 
-                for (auto row = 0u; row != bitmap.rows; ++row)
+                for (auto row = 0u; row != g.rows; ++row)
                 {
-                    for (auto col = 0u; col != 4 * bitmap.width; ++col)
+                    for (auto col = 0u; col != 4 * g.width; ++col)
                         dest[col] |= src[col / 4]/2;
 
-                    src += bitmap.pitch;
+                    src += g.width;
                     dest += region.stride;
 
                     if (dest > region.vaddr + region.height * region.stride)
@@ -255,7 +375,7 @@ void Printer::printhelp(MirGraphicsRegion const& region)
                 }
             }
 
-            base_x += glyph->advance.x >> 6;
+            base_x += g.advance_x;
         }
         base_y += line_height;
     }
@@ -265,13 +385,34 @@ void Printer::printhelp(MirGraphicsRegion const& region)
 using namespace mir::client;
 using namespace mir::geometry;
 
-DecorationProvider::DecorationProvider(miral::WindowManagerTools const& tools) : tools{tools}
+namespace
 {
+void render_pattern(MirGraphicsRegion const* region, uint8_t const pattern[])
+{
+    pixels::fill(*region, pixels::pixel(pattern));
+
+    static Printer printer;
+    printer.printhelp(*region);
+}
+}
 
+DecorationProvider::DecorationProvider(
+    miral::WindowManagerTools const& tools,
+    miral::ActiveOutputsMonitor& outputs_monitor) :
+    tools{tools},
+    outputs_monitor{outputs_monitor},
+    wallpaper{wallpaper_name, [](MirGraphicsRegion const& region)
+        {
+            static uint8_t const pattern[4] = { 0x00, 0x00, 0x00, 0x00 };
+            render_pattern(&region, pattern);
+        }}
+{
+    outputs_monitor.add_listener(this);
 }
 
 DecorationProvider::~DecorationProvider()
 {
+    outputs_monitor.delete_listener(this);
 }
 
 void DecorationProvider::stop()
@@ -291,61 +432,43 @@ void DecorationProvider::stop()
                      WindowSpec::for_normal_window(connection, 100, 100, mir_pixel_format_xrgb_8888)
                          .set_name(wallpaper_name).create_window();
 #endif
-                wallpaper.erase(begin(wallpaper), end(wallpaper));
+                wallpaper.clear();
             }
             connection.reset();
         });
     stop_work();
 }
 
-namespace
-{
-void render_pattern(MirGraphicsRegion* region, uint8_t const pattern[])
+void DecorationProvider::operator()(Connection connection)
 {
-    char* row = region->vaddr;
+    this->connection = connection;
 
-    for (int j = 0; j < region->height; j++)
-    {
-        uint32_t* pixel = (uint32_t*)row;
+    wallpaper.update(this->connection);
 
-        for (int i = 0; i < region->width; i++)
-            memcpy(pixel + i, pattern, sizeof pixel[i]);
+    start_work(titlebar::decoration_threads());
 
-        row += region->stride;
+    if (titlebar::report_decoration_timing())
+    {
+        using namespace std::chrono;
+        auto const stats = statistics();
+        auto const as_us = [](nanoseconds duration) { return duration_cast<microseconds>(duration).count(); };
+
+        std::cerr << "decorations: threads=" << titlebar::decoration_threads()
+                  << ", work=" << stats.completed << ", superseded=" << stats.superseded
+                  << ", max queue depth=" << stats.max_queue_depth
+                  << ", mean time=" << (stats.completed ? as_us(stats.total_time)/stats.completed : 0)
+                  << "us, max time=" << as_us(stats.max_time) << "us\n";
     }
-
-    static Printer printer;
-    printer.printhelp(*region);
-}
 }
 
-void DecorationProvider::operator()(Connection connection)
+void DecorationProvider::advise_output_end()
 {
-    this->connection = connection;
-
-    DisplayConfig const display_conf{this->connection};
-
-    display_conf.for_each_output([this](MirOutput const* output)
-         {
-             wallpaper.push_back(
-                 WindowSpec::for_gloss(this->connection, 100, 100)
-                     .set_pixel_format(mir_pixel_format_xrgb_8888)
-                     .set_buffer_usage(mir_buffer_usage_software)
-                     .set_fullscreen_on_output(mir_output_get_id(output))
-                     .set_name(wallpaper_name).create_window());
-
-             MirGraphicsRegion graphics_region;
-             MirBufferStream* buffer_stream = mir_window_get_buffer_stream(wallpaper.back());
-
-             mir_buffer_stream_get_graphics_region(buffer_stream, &graphics_region);
-
-             static uint8_t const pattern[4] = { 0x00, 0x00, 0x00, 0x00 };
-
-             render_pattern(&graphics_region, pattern);
-             mir_buffer_stream_swap_buffers_sync(buffer_stream);
-         });
-
-    start_work();
+    // Outputs can change again before the wallpaper is updated
+    enqueue_work(&wallpaper, [this]
+        {
+            if (connection)
+                wallpaper.update(connection);
+        });
 }
 
 void DecorationProvider::operator()(std::weak_ptr<mir::scene::Session> const& session)
@@ -390,12 +513,16 @@ void DecorationProvider::paint_titlebar_for(miral::WindowInfo const& info, int i
 
         if (auto surface = data->titlebar.load())
         {
-            enqueue_work([this, surface, title, intensity]{ paint_surface(surface, title, intensity); });
+            enqueue_work(surface, [surface, title, intensity, data]
+                { paint_surface(surface, title, intensity, data->shown); });
         }
         else
         {
-            data->on_create = [this, title, intensity](MirWindow* surface)
-                { enqueue_work([this, surface, title, intensity]{ paint_surface(surface, title, intensity); }); };
+            data->on_create = [this, title, intensity, data](MirWindow* surface)
+                {
+                    enqueue_work(surface, [surface, title, intensity, data]
+                        { paint_surface(surface, title, intensity, data->shown); });
+                };
         }
     }
 }
@@ -513,8 +640,8 @@ void DecorationProvider::repaint_titlebar_for(miral::WindowInfo const& window_in
 
         if (auto surface = data->titlebar.load())
         {
-            enqueue_work([this, surface, title, intensity=data->intensity.load()]
-                             { paint_surface(surface, title, intensity); });
+            enqueue_work(surface, [surface, title, intensity=data->intensity.load(), data]
+                             { paint_surface(surface, title, intensity, data->shown); });
         }
     }
 }
@@ -563,35 +690,129 @@ Worker::~Worker()
 {
 }
 
+auto Worker::next_work() -> WorkQueue::iterator
+{
+    if (unkeyed_in_progress)
+        return end(work_queue);
+
+    for (auto i = begin(work_queue); i != end(work_queue); ++i)
+    {
+        if (!i->key)
+            return (i == begin(work_queue) && work_in_progress == 0) ? i : end(work_queue);
+
+        if (keys_in_progress.find(i->key) == end(keys_in_progress))
+            return i;
+    }
+
+    return end(work_queue);
+}
+
 void Worker::do_work()
 {
-    while (!work_done)
+    for (;;)
     {
-        WorkQueue::value_type work;
+        void const* key;
+        std::function<void()> work;
         {
             std::unique_lock<decltype(work_mutex)> lock{work_mutex};
-            work_cv.wait(lock, [this] { return !work_queue.empty(); });
-            work = work_queue.front();
-            work_queue.pop();
+
+            WorkQueue::iterator next;
+            work_cv.wait(lock, [&] { return work_done || (next = next_work()) != end(work_queue); });
+
+            if (work_done)
+                return;
+
+            key = next->key;
+            if (key)
+            {
+                auto const keyed = keyed_work.find(key);
+                work = std::move(keyed->second);
+                keyed_work.erase(keyed);
+                keys_in_progress.insert(key);
+            }
+            else
+            {
+                work = std::move(next->functor);
+                unkeyed_in_progress = true;
+            }
+
+            work_queue.erase(next);
+            ++work_in_progress;
         }
 
+        auto const start = std::chrono::steady_clock::now();
         work();
+        auto const duration = std::chrono::steady_clock::now() - start;
+
+        {
+            std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+
+            if (key)
+                keys_in_progress.erase(key);
+            else
+                unkeyed_in_progress = false;
+
+            --work_in_progress;
+
+            ++stats.completed;
+            stats.total_time += duration;
+            stats.max_time = std::max<std::chrono::nanoseconds>(stats.max_time, duration);
+        }
+
+        work_cv.notify_all();
     }
 }
 
 void Worker::enqueue_work(std::function<void()> const& functor)
 {
     std::lock_guard<decltype(work_mutex)> lock{work_mutex};
-    work_queue.push(functor);
+    work_queue.push_back({nullptr, functor});
+    stats.max_queue_depth = std::max(stats.max_queue_depth, work_queue.size());
+    work_cv.notify_one();
+}
+
+void Worker::enqueue_work(void const* key, std::function<void()> const& functor)
+{
+    std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+
+    auto const pending = keyed_work.find(key);
+    if (pending != keyed_work.end())
+    {
+        pending->second = functor;
+        ++stats.superseded;
+        return;
+    }
+
+    keyed_work.emplace(key, functor);
+    work_queue.push_back({key, {}});
+    stats.max_queue_depth = std::max(stats.max_queue_depth, work_queue.size());
     work_cv.notify_one();
 }
 
-void Worker::start_work()
+void Worker::start_work(int threads)
 {
+    std::vector<std::thread> pool;
+
+    for (auto i = 1; i < threads; ++i)
+        pool.emplace_back([this] { do_work(); });
+
     do_work();
+
+    for (auto& thread : pool)
+        thread.join();
 }
 
 void Worker::stop_work()
 {
-    enqueue_work([this] { work_done = true; });
+    enqueue_work([this]
+        {
+            std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+            work_done = true;
+        });
+}
+
+auto Worker::statistics() const -> Statistics
+{
+    std::lock_guard<decltype(work_mutex)> lock{work_mutex};
+    return stats;
 }
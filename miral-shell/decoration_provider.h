@@ -20,6 +20,9 @@
 #define MIRAL_SHELL_DECORATION_PROVIDER_H
 
 
+#include "wallpaper.h"
+
+#include <miral/active_outputs.h>
 #include <miral/window_manager_tools.h>
 
 #include <mir/client/connection.h>
@@ -29,35 +32,78 @@
 #include <mir_toolkit/client_types.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <map>
 #include <mutex>
-#include <condition_variable>
-#include <queue>
+#include <set>
+#include <string>
 
+// Runs work on a pool of threads. Work with a key runs in the order queued
+// for that key, and concurrently with work for other keys. Work without a
+// key runs alone, after all the work queued before it.
 class Worker
 {
 public:
     ~Worker();
 
-    void start_work();
+    /// Run work on threads threads (including the caller) until stop_work()
+    void start_work(int threads = 1);
     void enqueue_work(std::function<void()> const& functor);
+    /// Work for the same key that hasn't started yet is replaced by functor
+    /// (which keeps the place in the queue of the work it replaces)
+    void enqueue_work(void const* key, std::function<void()> const& functor);
     void stop_work();
 
+    struct Statistics
+    {
+        std::size_t completed;
+        std::size_t superseded;
+        std::size_t max_queue_depth;
+        std::chrono::nanoseconds total_time;
+        std::chrono::nanoseconds max_time;
+    };
+
+    auto statistics() const -> Statistics;
+
 private:
-    using WorkQueue = std::queue<std::function<void()>>;
+    struct Work
+    {
+        void const* key;
+        std::function<void()> functor;
+    };
+
+    using WorkQueue = std::deque<Work>;
+    using KeyedWork = std::map<void const*, std::function<void()>>;
 
     std::mutex mutable work_mutex;
     std::condition_variable work_cv;
     WorkQueue work_queue;
+    KeyedWork keyed_work;
+    std::set<void const*> keys_in_progress;
+    int work_in_progress = 0;
+    bool unkeyed_in_progress = false;
     bool work_done = false;
+    Statistics stats{0, 0, 0, {}, {}};
 
     void do_work();
+    auto next_work() -> WorkQueue::iterator;
 };
 
-class DecorationProvider : Worker
+// What a titlebar shows (so a paint that wouldn't change it can be skipped)
+struct TitlebarContent
+{
+    std::string title;
+    int intensity;
+    int width;
+    int height;
+};
+
+class DecorationProvider : Worker, miral::ActiveOutputsListener
 {
 public:
-    DecorationProvider(miral::WindowManagerTools const& tools);
+    DecorationProvider(miral::WindowManagerTools const& tools, miral::ActiveOutputsMonitor& outputs_monitor);
     ~DecorationProvider();
 
     void operator()(mir::client::Connection connection);
@@ -85,6 +131,7 @@ private:
         std::atomic<int> intensity{0xff};
         std::function<void(MirWindow* surface)> on_create{[](MirWindow*){}};
         miral::Window window;
+        TitlebarContent shown{{}, 0, 0, 0};   ///< only used when painting titlebar
 
         ~Data();
     };
@@ -93,9 +140,10 @@ private:
     using TitleMap = std::map<std::string, std::weak_ptr<mir::scene::Surface>>;
 
     miral::WindowManagerTools tools;
+    miral::ActiveOutputsMonitor& outputs_monitor;
     std::mutex mutable mutex;
     mir::client::Connection connection;
-    std::vector<mir::client::Window> wallpaper;
+    Wallpaper wallpaper;
     std::weak_ptr<mir::scene::Session> weak_session;
 
     SurfaceMap window_to_titlebar;
@@ -105,6 +153,8 @@ private:
     Data* find_titlebar_data(miral::Window const& window);
     miral::Window find_titlebar_window(miral::Window const& window) const;
     void repaint_titlebar_for(miral::WindowInfo const& window_info);
+
+    void advise_output_end() override;
 };
 
 
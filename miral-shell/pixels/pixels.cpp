@@ -0,0 +1,257 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "pixels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MIRAL_PIXELS_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+// x/0xff for x in [0, 0xfffe] (which covers a blend of two channels)
+inline auto div255(unsigned x) -> unsigned
+{
+    return (x + 1 + (x >> 8)) >> 8;
+}
+
+void fill_row_scalar(uint32_t* row, int width, uint32_t value)
+{
+    std::fill_n(row, width, value);
+}
+
+auto blend_pixel(unsigned coverage, uint32_t foreground, uint32_t background) -> uint32_t
+{
+    if (coverage == 0) return background;
+    if (coverage == 0xff) return foreground;
+
+    uint32_t result = 0;
+
+    for (auto shift = 0; shift != 32; shift += 8)
+    {
+        auto const fg = (foreground >> shift) & 0xff;
+        auto const bg = (background >> shift) & 0xff;
+        result |= div255(bg*(0xff - coverage) + fg*coverage) << shift;
+    }
+
+    return result;
+}
+
+void blend_row_scalar(uint32_t* row, unsigned char const* coverage, int width, uint32_t foreground, uint32_t background)
+{
+    for (auto i = 0; i != width; ++i)
+        row[i] = blend_pixel(coverage[i], foreground, background);
+}
+
+#if defined(__SSE2__)
+void fill_row_sse2(uint32_t* row, int width, uint32_t value)
+{
+    auto const pixels = _mm_set1_epi32(value);
+
+    auto i = 0;
+    for (; i + 4 <= width; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), pixels);
+
+    fill_row_scalar(row + i, width - i, value);
+}
+
+// Blends eight channels (two pixels) held as 16-bit values
+inline auto blend_channels_sse2(__m128i coverage, __m128i foreground, __m128i background) -> __m128i
+{
+    auto const x = _mm_add_epi16(
+        _mm_mullo_epi16(background, _mm_sub_epi16(_mm_set1_epi16(0xff), coverage)),
+        _mm_mullo_epi16(foreground, coverage));
+
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+void blend_row_sse2(uint32_t* row, unsigned char const* coverage, int width, uint32_t foreground, uint32_t background)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const fg = _mm_unpacklo_epi8(_mm_set1_epi32(foreground), zero);
+    auto const bg = _mm_unpacklo_epi8(_mm_set1_epi32(background), zero);
+
+    auto i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+        int32_t four;
+        memcpy(&four, coverage + i, sizeof four);
+
+        // Each coverage byte repeated for the four channels of its pixel
+        auto c = _mm_cvtsi32_si128(four);
+        c = _mm_unpacklo_epi8(c, c);
+        c = _mm_unpacklo_epi16(c, c);
+
+        auto const lo = blend_channels_sse2(_mm_unpacklo_epi8(c, zero), fg, bg);
+        auto const hi = blend_channels_sse2(_mm_unpackhi_epi8(c, zero), fg, bg);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_packus_epi16(lo, hi));
+    }
+
+    blend_row_scalar(row + i, coverage + i, width - i, foreground, background);
+}
+#endif
+
+#if defined(MIRAL_PIXELS_AVX2)
+__attribute__((target("avx2")))
+void fill_row_avx2(uint32_t* row, int width, uint32_t value)
+{
+    auto const pixels = _mm256_set1_epi32(value);
+
+    auto i = 0;
+    for (; i + 8 <= width; i += 8)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), pixels);
+
+    fill_row_scalar(row + i, width - i, value);
+}
+
+// Blends sixteen channels (four pixels) with coverage held as bytes
+__attribute__((target("avx2")))
+inline auto blend_channels_avx2(__m128i coverage, __m256i foreground, __m256i background) -> __m256i
+{
+    auto const c = _mm256_cvtepu8_epi16(coverage);
+    auto const x = _mm256_add_epi16(
+        _mm256_mullo_epi16(background, _mm256_sub_epi16(_mm256_set1_epi16(0xff), c)),
+        _mm256_mullo_epi16(foreground, c));
+
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+void blend_row_avx2(uint32_t* row, unsigned char const* coverage, int width, uint32_t foreground, uint32_t background)
+{
+    auto const fg = _mm256_cvtepu8_epi16(_mm_set1_epi32(foreground));
+    auto const bg = _mm256_cvtepu8_epi16(_mm_set1_epi32(background));
+
+    auto i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        // Each coverage byte repeated for the four channels of its pixel
+        auto c = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(coverage + i));
+        c = _mm_unpacklo_epi8(c, c);
+
+        auto const lo = blend_channels_avx2(_mm_unpacklo_epi16(c, c), fg, bg);
+        auto const hi = blend_channels_avx2(_mm_unpackhi_epi16(c, c), fg, bg);
+
+        // _mm256_packus_epi16 packs each 128-bit lane separately
+        auto const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), packed);
+    }
+
+    blend_row_scalar(row + i, coverage + i, width - i, foreground, background);
+}
+#endif
+
+struct Kernels
+{
+    void (*fill_row)(uint32_t* row, int width, uint32_t value);
+    void (*blend_row)(uint32_t* row, unsigned char const* coverage, int width, uint32_t foreground, uint32_t background);
+};
+
+auto select_kernels() -> Kernels
+{
+#if defined(MIRAL_PIXELS_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return {&fill_row_avx2, &blend_row_avx2};
+#endif
+
+#if defined(__SSE2__)
+    return {&fill_row_sse2, &blend_row_sse2};
+#else
+    return {&fill_row_scalar, &blend_row_scalar};
+#endif
+}
+
+auto kernels() -> Kernels const&
+{
+    static Kernels const selected = select_kernels();
+    return selected;
+}
+
+inline auto row_at(MirGraphicsRegion const& region, int row) -> uint32_t*
+{
+    return reinterpret_cast<uint32_t*>(region.vaddr + row*region.stride);
+}
+}
+
+auto pixels::pixel(MirPixelFormat format, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha) -> uint32_t
+{
+    switch (format)
+    {
+    case mir_pixel_format_xrgb_8888:
+        alpha = 0xff;
+        // Fallthrough
+    case mir_pixel_format_argb_8888:
+        return uint32_t(alpha) << 24 | uint32_t(red) << 16 | uint32_t(green) << 8 | blue;
+
+    case mir_pixel_format_xbgr_8888:
+        alpha = 0xff;
+        // Fallthrough
+    case mir_pixel_format_abgr_8888:
+        return uint32_t(alpha) << 24 | uint32_t(blue) << 16 | uint32_t(green) << 8 | red;
+
+    default:
+        throw std::invalid_argument("Pixel format is not 32-bit RGB");
+    }
+}
+
+auto pixels::pixel(uint8_t const pattern[4]) -> uint32_t
+{
+    uint32_t result;
+    memcpy(&result, pattern, sizeof result);
+    return result;
+}
+
+void pixels::fill(MirGraphicsRegion const& region, uint32_t value)
+{
+    auto const fill_row = kernels().fill_row;
+
+    for (auto j = 0; j != region.height; ++j)
+        fill_row(row_at(region, j), region.width, value);
+}
+
+void pixels::blend(
+    MirGraphicsRegion const& region,
+    unsigned char const* coverage,
+    int coverage_stride,
+    uint32_t foreground,
+    uint32_t background)
+{
+    auto const blend_row = kernels().blend_row;
+
+    for (auto j = 0; j != region.height; ++j)
+        blend_row(row_at(region, j), coverage + j*coverage_stride, region.width, foreground, background);
+}
+
+auto pixels::columns(MirGraphicsRegion const& region, int first, int count) -> MirGraphicsRegion
+{
+    auto result = region;
+    result.vaddr += 4*first;
+    result.width = count;
+    return result;
+}
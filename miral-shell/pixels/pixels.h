@@ -0,0 +1,52 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SHELL_PIXELS_H
+#define MIRAL_SHELL_PIXELS_H
+
+#include <mir_toolkit/client_types.h>
+
+#include <cstdint>
+
+// Kernels for painting software buffers with 32-bit pixels (the 8888 formats).
+// These use AVX2 or SSE2 when the CPU has them, and plain C++ otherwise.
+namespace pixels
+{
+/// The pixel value for a colour in the given format (alpha is 0xff for the "x" formats)
+auto pixel(MirPixelFormat format, uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha = 0xff) -> uint32_t;
+
+/// The pixel value for a four byte pattern (in memory order)
+auto pixel(uint8_t const pattern[4]) -> uint32_t;
+
+/// Set every pixel in region to value
+void fill(MirGraphicsRegion const& region, uint32_t value);
+
+/// Paint region by blending from background to foreground by coverage (0 is background,
+/// 0xff is foreground). coverage has a byte for each pixel, with rows coverage_stride apart.
+void blend(
+    MirGraphicsRegion const& region,
+    unsigned char const* coverage,
+    int coverage_stride,
+    uint32_t foreground,
+    uint32_t background);
+
+/// The part of region from column first, count columns wide
+auto columns(MirGraphicsRegion const& region, int first, int count) -> MirGraphicsRegion;
+}
+
+#endif //MIRAL_SHELL_PIXELS_H
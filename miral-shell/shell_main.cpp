@@ -44,7 +44,7 @@ int main(int argc, char const* argv[])
     ActiveOutputsMonitor outputs_monitor;
     WindowManagerOptions window_managers
         {
-            add_window_manager_policy<TitlebarWindowManagerPolicy>("titlebar", spinner, launcher, shutdown_hook),
+            add_window_manager_policy<TitlebarWindowManagerPolicy>("titlebar", spinner, launcher, outputs_monitor, shutdown_hook),
             add_window_manager_policy<TilingWindowManagerPolicy>("tiling", spinner, launcher, outputs_monitor),
         };
 
@@ -93,6 +93,11 @@ int main(int argc, char const* argv[])
             AppendEventFilter{quit_on_ctrl_alt_bksp},
             StartupInternalClient{"Intro", spinner},
             CommandLineOption{[&](std::string const& typeface) { ::titlebar::font_file(typeface); },
-                              "shell-titlebar-font", "font file to use for titlebars", ::titlebar::font_file()}
+                              "shell-titlebar-font", "font file to use for titlebars", ::titlebar::font_file()},
+            CommandLineOption{[&](int threads) { ::titlebar::decoration_threads(threads); },
+                              "shell-decoration-threads", "threads painting titlebars", ::titlebar::decoration_threads()},
+            CommandLineOption{[&](bool report) { ::titlebar::report_decoration_timing(report); },
+                              "shell-decoration-report", "report decoration queue depth and paint time on exit",
+                              ::titlebar::report_decoration_timing()}
         });
 }
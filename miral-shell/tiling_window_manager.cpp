@@ -520,6 +520,8 @@ void TilingWindowManagerPolicy::update_tiles(Rectangles const& displays)
 
 void TilingWindowManagerPolicy::update_surfaces(ApplicationInfo& info, Rectangle const& old_tile, Rectangle const& new_tile)
 {
+    std::vector<std::pair<Window, WindowSpecification>> modifications;
+
     for (auto const& window : info.windows())
     {
         if (window)
@@ -539,13 +541,15 @@ void TilingWindowManagerPolicy::update_surfaces(ApplicationInfo& info, Rectangle
                 auto width  = std::min(new_tile.size.width.as_int()  - offset.dx.as_int(), scaled_width.as_int());
                 auto height = std::min(new_tile.size.height.as_int() - offset.dy.as_int(), scaled_height.as_int());
 
-                WindowSpecification modifications;
-                modifications.top_left() = new_pos;
-                modifications.size() = {width, height};
-                tools.modify_window(window_info, modifications);
+                WindowSpecification retile;
+                retile.top_left() = new_pos;
+                retile.size() = {width, height};
+                modifications.emplace_back(window, retile);
             }
         }
     }
+
+    tools.modify_windows(modifications);
 }
 
 void TilingWindowManagerPolicy::clip_to_tile(miral::WindowSpecification& parameters, Rectangle const& tile)
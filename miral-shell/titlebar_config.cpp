@@ -17,12 +17,16 @@
  */
 
 #include "titlebar_config.h"
+
+#include <algorithm>
 #include <mutex>
 
 namespace
 {
 std::mutex mutex;
 std::string font_file{"/usr/share/fonts/truetype/ubuntu-font-family/Ubuntu-B.ttf"};
+int decoration_threads{2};
+bool report_decoration_timing{false};
 }
 
 void titlebar::font_file(std::string const& font_file)
@@ -36,3 +40,27 @@ auto titlebar::font_file() -> std::string
     std::lock_guard<decltype(mutex)> lock{mutex};
     return ::font_file;
 }
+
+void titlebar::decoration_threads(int threads)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    ::decoration_threads = std::max(threads, 1);
+}
+
+auto titlebar::decoration_threads() -> int
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    return ::decoration_threads;
+}
+
+void titlebar::report_decoration_timing(bool report)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    ::report_decoration_timing = report;
+}
+
+auto titlebar::report_decoration_timing() -> bool
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    return ::report_decoration_timing;
+}
@@ -25,6 +25,12 @@ namespace titlebar
 {
 void font_file(std::string const& font_file);
 auto font_file() -> std::string;
+
+void decoration_threads(int threads);
+auto decoration_threads() -> int;
+
+void report_decoration_timing(bool report);
+auto report_decoration_timing() -> bool;
 }
 
 #endif //MIRAL_TITLEBAR_CONFIG_H
@@ -50,10 +50,11 @@ TitlebarWindowManagerPolicy::TitlebarWindowManagerPolicy(
     WindowManagerTools const& tools,
     SpinnerSplash const& spinner,
     miral::InternalClientLauncher const& launcher,
+    miral::ActiveOutputsMonitor& outputs_monitor,
     std::function<void()>& shutdown_hook) :
     CanonicalWindowManagerPolicy(tools),
     spinner{spinner},
-    decoration_provider{std::make_unique<DecorationProvider>(tools)}
+    decoration_provider{std::make_unique<DecorationProvider>(tools, outputs_monitor)}
 {
     launcher.launch("decorations", *decoration_provider);
     shutdown_hook = [this] { decoration_provider->stop(); };
@@ -302,7 +303,11 @@ void TitlebarWindowManagerPolicy::advise_new_window(WindowInfo const& window_inf
     else
     {
         if (policy_data_for(tools.info_for(parent)).in_hidden_workspace)
-            apply_workspace_hidden_to(window_info.window());
+        {
+            WindowModifications modifications;
+            apply_workspace_hidden_to(window_info.window(), modifications);
+            tools.modify_windows(modifications);
+        }
     }
 }
 
@@ -640,17 +645,21 @@ void TitlebarWindowManagerPolicy::advise_adding_to_workspace(
     if (windows.empty())
         return;
 
+    WindowModifications modifications;
+
     for (auto const& window : windows)
     {
         if (workspace == active_workspace)
         {
-            apply_workspace_visible_to(window);
+            apply_workspace_visible_to(window, modifications);
         }
         else
         {
-            apply_workspace_hidden_to(window);
+            apply_workspace_hidden_to(window, modifications);
         }
     }
+
+    tools.modify_windows(modifications);
 }
 
 void TitlebarWindowManagerPolicy::switch_workspace_to(
@@ -665,6 +674,9 @@ void TitlebarWindowManagerPolicy::switch_workspace_to(
 
     auto const old_active_window = tools.active_window();
 
+    // The windows are shown and hidden as one change, so focus only shifts once
+    WindowModifications modifications;
+
     if (!old_active_window)
     {
         // If there's no active window, the first shown grabs focus: get the right one
@@ -674,7 +686,7 @@ void TitlebarWindowManagerPolicy::switch_workspace_to(
                 {
                     if (ws == workspace)
                     {
-                        apply_workspace_visible_to(ww);
+                        apply_workspace_visible_to(ww, modifications);
                     }
                 });
         }
@@ -688,7 +700,7 @@ void TitlebarWindowManagerPolicy::switch_workspace_to(
             if (decoration_provider->is_decoration(window))
                 return; // decorations are taken care of automatically
 
-        apply_workspace_visible_to(window);
+        apply_workspace_visible_to(window, modifications);
         });
 
     bool hide_old_active = false;
@@ -704,19 +716,21 @@ void TitlebarWindowManagerPolicy::switch_workspace_to(
                 return;
             }
 
-        apply_workspace_hidden_to(window);
+        apply_workspace_hidden_to(window, modifications);
         });
 
     if (hide_old_active)
     {
-        apply_workspace_hidden_to(old_active_window);
+        apply_workspace_hidden_to(old_active_window, modifications);
 
         // Remember the old active_window when we switch away
         workspace_to_active[old_active] = old_active_window;
     }
+
+    tools.modify_windows(modifications);
 }
 
-void TitlebarWindowManagerPolicy::apply_workspace_hidden_to(Window const& window)
+void TitlebarWindowManagerPolicy::apply_workspace_hidden_to(Window const& window, WindowModifications& modifications)
 {
     auto const& window_info = tools.info_for(window);
     auto& pdata = policy_data_for(window_info);
@@ -725,24 +739,24 @@ void TitlebarWindowManagerPolicy::apply_workspace_hidden_to(Window const& window
         pdata.in_hidden_workspace = true;
         pdata.old_state = window_info.state();
 
-        WindowSpecification modifications;
-        modifications.state() = mir_window_state_hidden;
-        tools.place_and_size_for_state(modifications, window_info);
-        tools.modify_window(window_info.window(), modifications);
+        WindowSpecification hide;
+        hide.state() = mir_window_state_hidden;
+        tools.place_and_size_for_state(hide, window_info);
+        modifications.emplace_back(window, hide);
     }
 }
 
-void TitlebarWindowManagerPolicy::apply_workspace_visible_to(Window const& window)
+void TitlebarWindowManagerPolicy::apply_workspace_visible_to(Window const& window, WindowModifications& modifications)
 {
     auto const& window_info = tools.info_for(window);
     auto& pdata = policy_data_for(window_info);
     if (pdata.in_hidden_workspace)
     {
         pdata.in_hidden_workspace = false;
-        WindowSpecification modifications;
-        modifications.state() = pdata.old_state;
-        tools.place_and_size_for_state(modifications, window_info);
-        tools.modify_window(window_info.window(), modifications);
+        WindowSpecification show;
+        show.state() = pdata.old_state;
+        tools.place_and_size_for_state(show, window_info);
+        modifications.emplace_back(window, show);
     }
 }
 
@@ -27,7 +27,7 @@
 #include <chrono>
 #include <map>
 
-namespace miral { class InternalClientLauncher; }
+namespace miral { class InternalClientLauncher; class ActiveOutputsMonitor; }
 
 using namespace mir::geometry;
 
@@ -40,6 +40,7 @@ public:
         miral::WindowManagerTools const& tools,
         SpinnerSplash const& spinner,
         miral::InternalClientLauncher const& launcher,
+        miral::ActiveOutputsMonitor& outputs_monitor,
         std::function<void()>& shutdown_hook);
     ~TitlebarWindowManagerPolicy();
 
@@ -128,9 +129,12 @@ private:
     std::map<int, std::shared_ptr<miral::Workspace>> key_to_workspace;
     std::map<std::shared_ptr<miral::Workspace>, miral::Window> workspace_to_active;
 
-    void apply_workspace_visible_to(miral::Window const& window);
+    using WindowModifications = std::vector<std::pair<miral::Window, miral::WindowSpecification>>;
 
-    void apply_workspace_hidden_to(miral::Window const& window);
+    // These add the modifications to apply (as one change) with WindowManagerTools::modify_windows()
+    void apply_workspace_visible_to(miral::Window const& window, WindowModifications& modifications);
+
+    void apply_workspace_hidden_to(miral::Window const& window, WindowModifications& modifications);
 };
 
 #endif //MIRAL_SHELL_TITLEBAR_WINDOW_MANAGER_H
@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "wallpaper.h"
+
+#include <mir/client/display_config.h>
+#include <mir/client/window_spec.h>
+
+#include <mir_toolkit/mir_buffer_stream.h>
+
+#include <cstring>
+#include <set>
+
+using namespace mir::client;
+using namespace mir::geometry;
+
+namespace
+{
+auto key_for(Size const& size) -> std::pair<int, int>
+{
+    return {size.width.as_int(), size.height.as_int()};
+}
+}
+
+Wallpaper::Wallpaper(std::string const& name, Painter const& paint) :
+    name{name},
+    paint{paint}
+{
+}
+
+void Wallpaper::update(Connection const& connection)
+{
+    std::map<int, Size> output_sizes;
+
+    DisplayConfig const display_conf{connection};
+
+    display_conf.for_each_output([&](MirOutput const* output)
+        {
+            if (!mir_output_is_enabled(output))
+                return;
+
+            if (auto const mode = mir_output_get_current_mode(output))
+            {
+                Size size{mir_output_mode_get_width(mode), mir_output_mode_get_height(mode)};
+
+                switch (mir_output_get_orientation(output))
+                {
+                case mir_orientation_left:
+                case mir_orientation_right:
+                    size = Size{size.height.as_int(), size.width.as_int()};
+                    break;
+
+                default:
+                    break;
+                }
+
+                output_sizes[mir_output_get_id(output)] = size;
+            }
+        });
+
+    for (auto i = begin(outputs); i != end(outputs);)
+    {
+        if (output_sizes.find(i->first) == end(output_sizes))
+            i = outputs.erase(i);
+        else
+            ++i;
+    }
+
+    for (auto const& output : output_sizes)
+    {
+        auto const existing = outputs.find(output.first);
+        if (existing != end(outputs) && existing->second.output_size == output.second)
+            continue;
+
+        // A window for the old size would be resized by the server, but it
+        // is simpler (and no slower) to replace it with one of the right size.
+        Window const window{WindowSpec::for_gloss(connection, output.second.width.as_int(), output.second.height.as_int())
+            .set_pixel_format(mir_pixel_format_xrgb_8888)
+            .set_buffer_usage(mir_buffer_usage_software)
+            .set_fullscreen_on_output(output.first)
+            .set_name(name.c_str()).create_window()};
+
+        outputs[output.first] = OutputWallpaper{output.second, render(window), window};
+    }
+
+    // Don't keep content for sizes that are no longer needed
+    std::set<std::pair<int, int>> in_use;
+    for (auto const& output : outputs)
+        in_use.insert(key_for(output.second.rendered_size));
+
+    for (auto i = begin(rendered); i != end(rendered);)
+    {
+        if (in_use.find(i->first) == end(in_use))
+            i = rendered.erase(i);
+        else
+            ++i;
+    }
+}
+
+void Wallpaper::clear()
+{
+    outputs.clear();
+    rendered.clear();
+}
+
+auto Wallpaper::render(Window const& window) -> Size
+{
+    auto const buffer_stream = mir_window_get_buffer_stream(window);
+    if (!buffer_stream)
+        return {};
+
+    MirGraphicsRegion region;
+    mir_buffer_stream_get_graphics_region(buffer_stream, &region);
+
+    Size const size{region.width, region.height};
+    auto const row_size = 4*region.width;
+
+    auto& content = rendered[key_for(size)];
+    if (content.empty())
+    {
+        content.resize(row_size*region.height);
+
+        auto unpadded = region;
+        unpadded.stride = row_size;
+        unpadded.vaddr = content.data();
+        paint(unpadded);
+    }
+
+    for (auto row = 0; row != region.height; ++row)
+        memcpy(region.vaddr + row*region.stride, content.data() + row*row_size, row_size);
+
+    mir_buffer_stream_swap_buffers_sync(buffer_stream);
+
+    return size;
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SHELL_WALLPAPER_H
+#define MIRAL_SHELL_WALLPAPER_H
+
+#include <mir/client/connection.h>
+#include <mir/client/window.h>
+
+#include <mir/geometry/size.h>
+#include <mir_toolkit/client_types.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// A wallpaper window on each output. The content is painted once for each
+// size of output, and copied to every output of that size.
+class Wallpaper
+{
+public:
+    using Painter = std::function<void(MirGraphicsRegion const& region)>;
+
+    Wallpaper(std::string const& name, Painter const& paint);
+
+    /// Add, replace or remove windows to match the outputs. Windows on outputs
+    /// that are unchanged are left as they are.
+    void update(mir::client::Connection const& connection);
+
+    void clear();
+
+private:
+    struct OutputWallpaper
+    {
+        mir::geometry::Size output_size;
+        mir::geometry::Size rendered_size;
+        mir::client::Window window;
+    };
+
+    std::string const name;
+    Painter const paint;
+
+    std::map<int, OutputWallpaper> outputs;     ///< by output id
+    std::map<std::pair<int, int>, std::vector<char>> rendered;   ///< by width & height
+
+    auto render(mir::client::Window const& window) -> mir::geometry::Size;
+};
+
+#endif //MIRAL_SHELL_WALLPAPER_H
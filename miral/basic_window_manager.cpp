@@ -17,7 +17,9 @@
  */
 
 #include "basic_window_manager.h"
+#include "window_self.h"
 #include "miral/window_manager_tools.h"
+#include "miral/window_change_policy.h"
 #include "miral/workspace_policy.h"
 
 #include <mir/scene/session.h>
@@ -42,30 +44,182 @@ int const title_bar_height = 12;
 
 struct miral::BasicWindowManager::Locker
 {
-    explicit Locker(miral::BasicWindowManager* self);
+    Locker(miral::BasicWindowManager* self, LockEntry entry);
 
-    ~Locker()
+    /// For a lock already taken, that was requested at requested
+    Locker(
+        miral::BasicWindowManager* self,
+        LockEntry entry,
+        std::unique_lock<std::shared_timed_mutex>&& lock,
+        LockTiming::Clock::time_point requested);
+
+    ~Locker() { if (lock.owns_lock()) release(); }
+
+    /// Deliver pointer motion merged while the lock was held and release it. This is called
+    /// on the normal return path: as the policy could throw it isn't done by ~Locker(), and if
+    /// the lock is released while unwinding the motion waits for the next Locker.
+    void unlock();
+
+    miral::BasicWindowManager* const self;
+    LockEntry const entry;
+    LockTiming* const timing;
+    LockTiming::Clock::time_point const requested;
+    std::unique_lock<std::shared_timed_mutex> lock;
+    LockTiming::Clock::time_point const acquired;
+    WindowManagementPolicy* const policy;
+
+private:
+    void start();
+    void release();
+};
+
+// Readers don't notify the policy or touch the model (not even to purge dead workspaces)
+struct miral::BasicWindowManager::SharedLocker
+{
+    explicit SharedLocker(miral::BasicWindowManager* self) :
+        self{self},
+        timing{self->lock_timing.get()},
+        requested{LockTiming::now(timing)},
+        lock{self->mutex},
+        acquired{LockTiming::now(timing)}
     {
-        policy->advise_end();
+        if (timing)
+            timing->wait(LockEntry::invoke_under_shared_lock).record(acquired - requested);
     }
 
-    std::lock_guard<std::mutex> const lock;
-    WindowManagementPolicy* const policy;
+    ~SharedLocker() { if (lock.owns_lock()) unlock(); }
+
+    /// Returns whether pointer motion was merged while the lock was held
+    auto unlock() -> bool;
+
+    miral::BasicWindowManager* const self;
+    LockTiming* const timing;
+    LockTiming::Clock::time_point const requested;
+    std::shared_lock<std::shared_timed_mutex> lock;
+    LockTiming::Clock::time_point const acquired;
 };
 
-miral::BasicWindowManager::Locker::Locker(BasicWindowManager* self) :
+// The members are initialized in order, so the time is taken before the lock
+miral::BasicWindowManager::Locker::Locker(BasicWindowManager* self, LockEntry entry) :
+    self{self},
+    entry{entry},
+    timing{self->lock_timing.get()},
+    requested{LockTiming::now(timing)},
     lock{self->mutex},
+    acquired{LockTiming::now(timing)},
     policy{self->policy.get()}
 {
-    policy->advise_begin();
-    std::vector<std::weak_ptr<Workspace>> workspaces;
+    start();
+}
+
+miral::BasicWindowManager::Locker::Locker(
+    BasicWindowManager* self,
+    LockEntry entry,
+    std::unique_lock<std::shared_timed_mutex>&& lock,
+    LockTiming::Clock::time_point requested) :
+    self{self},
+    entry{entry},
+    timing{self->lock_timing.get()},
+    requested{requested},
+    lock{std::move(lock)},
+    acquired{LockTiming::now(timing)},
+    policy{self->policy.get()}
+{
+    start();
+}
+
+void miral::BasicWindowManager::Locker::start()
+{
+    if (timing)
+        timing->wait(entry).record(acquired - requested);
+
+    self->timed(PolicyHook::advise_begin, [&]{ policy->advise_begin(); });
+
+    // This is on every input event, so only the rare case takes dead_workspaces_mutex. (If
+    // a flag set on another thread is missed the workspace is purged by a later lock.)
+    if (self->dead_workspaces->purge_needed.load(std::memory_order_relaxed))
+        self->purge_dead_workspaces();
+
+    // Motion merged while a reader held the lock is delivered before anything else
+    self->deliver_pending_motion();
+}
+
+// Pointer motion merged while the lock was held is delivered before the lock is released.
+// The lock is released under pending_motion_mutex, so handle_pointer_event() either sees
+// the lock free or merges motion before this checks for it.
+void miral::BasicWindowManager::Locker::unlock()
+{
+    std::unique_lock<std::mutex> pending_lock{self->pending_motion_mutex, std::defer_lock};
+
+    if (self->coalesce_motion)
     {
-        std::lock_guard<std::mutex> const lock{self->dead_workspaces->dead_workspaces_mutex};
-        workspaces.swap(self->dead_workspaces->workspaces);
+        pending_lock.lock();
+
+        while (auto const pending = self->motion_coalescer.take_pending())
+        {
+            pending_lock.unlock();
+            self->deliver_merged_motion(pending.get());
+            pending_lock.lock();
+        }
     }
 
+    release();
+}
+
+void miral::BasicWindowManager::Locker::release()
+{
+    self->timed(PolicyHook::advise_end, [&]{ policy->advise_end(); });
+    lock.unlock();
+
+    if (timing)
+        timing->hold(entry).record(LockTiming::Clock::now() - acquired);
+}
+
+auto miral::BasicWindowManager::SharedLocker::unlock() -> bool
+{
+    bool motion_pending = false;
+
+    if (!self->coalesce_motion)
+    {
+        lock.unlock();
+    }
+    else
+    {
+        std::lock_guard<std::mutex> const pending_lock{self->pending_motion_mutex};
+        lock.unlock();
+        motion_pending = self->motion_coalescer.has_pending();
+    }
+
+    if (timing)
+        timing->hold(LockEntry::invoke_under_shared_lock).record(LockTiming::Clock::now() - acquired);
+
+    return motion_pending;
+}
+
+void miral::BasicWindowManager::purge_dead_workspaces()
+{
+    std::vector<std::pair<std::weak_ptr<Workspace>, unsigned>> workspaces;
+    {
+        std::lock_guard<std::mutex> const lock{dead_workspaces->dead_workspaces_mutex};
+        dead_workspaces->purge_needed.store(false, std::memory_order_relaxed);
+        workspaces.swap(dead_workspaces->workspaces);
+    }
+
+    // Each workspace's entries are adjacent in the left view: clear the windows' bits and
+    // erase the entries as one range
+    for (auto const& workspace : workspaces)
+    {
+        auto const iter_pair = workspaces_to_windows.left.equal_range(workspace.first);
+        for (auto kv = iter_pair.first; kv != iter_pair.second; ++kv)
+            workspace_set_of(kv->second).erase(workspace.second);
+
+        workspaces_to_windows.left.erase(iter_pair.first, iter_pair.second);
+    }
+
+    // No window refers to these ids now, so they can be reused
+    std::lock_guard<std::mutex> const lock{dead_workspaces->dead_workspaces_mutex};
     for (auto const& workspace : workspaces)
-        self->workspaces_to_windows.left.erase(workspace);
+        dead_workspaces->free_ids.push_back(workspace.second);
 }
 
 namespace
@@ -82,6 +236,29 @@ auto find_workspace_policy(std::unique_ptr<miral::WindowManagementPolicy> const&
 
     return &null_workspace_policy;
 }
+
+auto find_window_change_policy(std::unique_ptr<miral::WindowManagementPolicy> const& policy) -> miral::WindowChangePolicy*
+{
+    miral::WindowChangePolicy* result = dynamic_cast<miral::WindowChangePolicy*>(policy.get());
+
+    if (result)
+        return result;
+
+    static miral::WindowChangePolicy null_window_change_policy;
+
+    return &null_window_change_policy;
+}
+
+template<typename Value>
+bool differs(Value const& current, Value const& requested)
+{
+    return !(current == requested);
+}
+
+bool differs(miral::WindowInfo::AspectRatio const& current, miral::WindowInfo::AspectRatio const& requested)
+{
+    return current.width != requested.width || current.height != requested.height;
+}
 }
 
 
@@ -94,21 +271,25 @@ miral::BasicWindowManager::BasicWindowManager(
     display_layout(display_layout),
     persistent_surface_store{persistent_surface_store},
     policy(build(WindowManagerTools{this})),
-    workspace_policy{find_workspace_policy(policy)}
+    workspace_policy{find_workspace_policy(policy)},
+    window_change_policy{find_window_change_policy(policy)}
 {
 }
 
 void miral::BasicWindowManager::add_session(std::shared_ptr<scene::Session> const& session)
 {
-    Locker lock{this};
-    policy->advise_new_app(app_info[session] = ApplicationInfo(session));
+    Locker lock{this, LockEntry::add_session};
+    auto& application = app_info[session] = ApplicationInfo(session);
+    timed(PolicyHook::advise_new_app, [&]{ policy->advise_new_app(application); });
+    lock.unlock();
 }
 
 void miral::BasicWindowManager::remove_session(std::shared_ptr<scene::Session> const& session)
 {
-    Locker lock{this};
-    policy->advise_delete_app(app_info[session]);
+    Locker lock{this, LockEntry::remove_session};
+    timed(PolicyHook::advise_delete_app, [&]{ policy->advise_delete_app(app_info[session]); });
     app_info.erase(session);
+    lock.unlock();
 }
 
 auto miral::BasicWindowManager::add_surface(
@@ -117,16 +298,21 @@ auto miral::BasicWindowManager::add_surface(
     std::function<frontend::SurfaceId(std::shared_ptr<scene::Session> const& session, scene::SurfaceCreationParameters const& params)> const& build)
 -> frontend::SurfaceId
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::add_surface};
 
     auto& session_info = info_for(session);
 
-    WindowSpecification const& spec = policy->place_new_window(session_info, place_new_surface(session_info, params));
+    auto const requested = place_new_surface(session_info, params);
+    WindowSpecification const& spec = timed(PolicyHook::place_new_window,
+        [&]{ return policy->place_new_window(session_info, requested); });
     scene::SurfaceCreationParameters parameters;
     spec.update(parameters);
     auto const surface_id = build(session, parameters);
     Window const window{session, session->surface(surface_id)};
-    auto& window_info = this->window_info.emplace(window, WindowInfo{window, spec}).first->second;
+    auto const slot_and_info = this->window_info.emplace(window, spec);
+    auto& window_info = slot_and_info.second;
+    window.self->info_slot = slot_and_info.first;
+    surface_slots.emplace(window, slot_and_info.first);
 
     if (spec.parent().is_set() && spec.parent().value().lock())
         window_info.parent(info_for(spec.parent().value()).window());
@@ -135,6 +321,7 @@ auto miral::BasicWindowManager::add_surface(
         window_info.userdata() = spec.userdata().value();
 
     session_info.add_window(window);
+    spatial_index.insert(window);
 
     auto const parent = window_info.parent();
 
@@ -147,12 +334,16 @@ auto miral::BasicWindowManager::add_surface(
     if (window_info.state() == mir_window_state_fullscreen)
         fullscreen_surfaces.insert(window_info.window());
 
-    policy->advise_new_window(window_info);
+    timed(PolicyHook::advise_new_window, [&]{ policy->advise_new_window(window_info); });
 
     std::shared_ptr<scene::Surface> const scene_surface = window_info.window();
     scene_surface->add_observer(std::make_shared<shell::SurfaceReadyObserver>(
         [this, &window_info](std::shared_ptr<scene::Session> const&, std::shared_ptr<scene::Surface> const&)
-            { Locker lock{this}; policy->handle_window_ready(window_info); },
+            {
+                Locker lock{this, LockEntry::handle_window_ready};
+                timed(PolicyHook::handle_window_ready, [&]{ policy->handle_window_ready(window_info); });
+                lock.unlock();
+            },
         session,
         scene_surface));
 
@@ -165,6 +356,7 @@ auto miral::BasicWindowManager::add_surface(
     }
 #endif
 
+    lock.unlock();
     return surface_id;
 }
 
@@ -173,42 +365,50 @@ void miral::BasicWindowManager::modify_surface(
     std::shared_ptr<scene::Surface> const& surface,
     shell::SurfaceSpecification const& modifications)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::modify_surface};
     auto& info = info_for(surface);
     WindowSpecification mods{modifications};
     validate_modification_request(mods, info);
     place_and_size_for_state(mods, info);
-    policy->handle_modify_window(info, mods);
+    timed(PolicyHook::handle_modify_window, [&]{ policy->handle_modify_window(info, mods); });
+    lock.unlock();
 }
 
 void miral::BasicWindowManager::remove_surface(
     std::shared_ptr<scene::Session> const& session,
     std::weak_ptr<scene::Surface> const& surface)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::remove_surface};
     remove_window(session, info_for(surface));
+    lock.unlock();
 }
 
 void miral::BasicWindowManager::remove_window(Application const& application, miral::WindowInfo const& info)
 {
     bool const is_active_window{mru_active_windows.top() == info.window()};
-    auto const workspaces_containing_window = workspaces_containing(info.window());
+    auto const workspaces_containing_window = workspace_set_of(info.window());
+
+    if (is_active_window)
+        focus_changing();
 
     {
         std::vector<Window> const windows_removed{info.window()};
 
-        for (auto const& workspace : workspaces_containing_window)
+        for (auto const& workspace : workspaces_containing(info.window()))
         {
-            workspace_policy->advise_removing_from_workspace(workspace, windows_removed);
+            timed(PolicyHook::advise_removing_from_workspace,
+                [&]{ workspace_policy->advise_removing_from_workspace(workspace, windows_removed); });
         }
 
         workspaces_to_windows.right.erase(info.window());
+        workspace_set_of(info.window()).clear();
     }
 
-    policy->advise_delete_window(info);
+    timed(PolicyHook::advise_delete_window, [&]{ policy->advise_delete_window(info); });
 
     info_for(application).remove_window(info.window());
     mru_active_windows.erase(info.window());
+    spatial_index.erase(info.window());
     fullscreen_surfaces.erase(info.window());
 
     application->destroy_surface(info.window());
@@ -225,7 +425,7 @@ void miral::BasicWindowManager::remove_window(Application const& application, mi
 
 void miral::BasicWindowManager::refocus(
     miral::Application const& application, miral::Window const& parent,
-    std::vector<std::shared_ptr<Workspace>> const& workspaces_containing_window)
+    WorkspaceSet const& workspaces_containing_window)
 {
     // Try to make the parent active
     if (parent && select_active_window(parent))
@@ -243,16 +443,8 @@ void miral::BasicWindowManager::refocus(
                 // select_active_window() calls set_focus_to() which updates mru_active_windows and changes window
                 auto const w = window;
 
-                for (auto const& workspace : workspaces_containing(w))
-                {
-                    for (auto const& ww : workspaces_containing_window)
-                    {
-                        if (ww == workspace)
-                        {
-                            return !(new_focus = select_active_window(w));
-                        }
-                    }
-                }
+                if (workspace_set_of(w).intersects(workspaces_containing_window))
+                    return !(new_focus = select_active_window(w));
 
                 return true;
             });
@@ -289,13 +481,16 @@ void miral::BasicWindowManager::erase(miral::WindowInfo const& info)
     for (auto& child : info.children())
         info_for(child).parent({});
 
-    window_info.erase(info.window());
+    auto const window = info.window();
+    surface_slots.erase(window);
+    window_info.erase(window.self->info_slot);
 }
 
 void miral::BasicWindowManager::add_display(geometry::Rectangle const& area)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::add_display};
     displays.add(area);
+    ++display_generation;
 
     for (auto window : fullscreen_surfaces)
     {
@@ -306,12 +501,15 @@ void miral::BasicWindowManager::add_display(geometry::Rectangle const& area)
             place_and_size(info, rect.top_left, rect.size);
         }
     }
+
+    lock.unlock();
 }
 
 void miral::BasicWindowManager::remove_display(geometry::Rectangle const& area)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::remove_display};
     displays.remove(area);
+    ++display_generation;
     for (auto window : fullscreen_surfaces)
     {
         if (window)
@@ -321,32 +519,143 @@ void miral::BasicWindowManager::remove_display(geometry::Rectangle const& area)
             place_and_size(info, rect.top_left, rect.size);
         }
     }
+
+    lock.unlock();
 }
 
 bool miral::BasicWindowManager::handle_keyboard_event(MirKeyboardEvent const* event)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::handle_keyboard_event};
     update_event_timestamp(event);
-    return policy->handle_keyboard_event(event);
+    auto const consumed = timed(PolicyHook::handle_keyboard_event, [&]{ return policy->handle_keyboard_event(event); });
+    lock.unlock();
+    return consumed;
 }
 
 bool miral::BasicWindowManager::handle_touch_event(MirTouchEvent const* event)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::handle_touch_event};
     update_event_timestamp(event);
-    return policy->handle_touch_event(event);
+    auto const consumed = timed(PolicyHook::handle_touch_event, [&]{ return policy->handle_touch_event(event); });
+    lock.unlock();
+    return consumed;
 }
 
 bool miral::BasicWindowManager::handle_pointer_event(MirPointerEvent const* event)
 {
-    Locker lock{this};
+    if (mir_pointer_event_action(event) == mir_pointer_action_motion)
+        motion_received.fetch_add(1, std::memory_order_relaxed);
+
+    if (!coalesce_motion)
+    {
+        Locker lock{this, LockEntry::handle_pointer_event};
+        auto const consumed = deliver_pointer_event(event);
+        lock.unlock();
+        return consumed;
+    }
+
+    auto const requested = LockTiming::now(lock_timing.get());
+    std::unique_lock<std::shared_timed_mutex> lock{mutex, std::defer_lock};
+    {
+        std::lock_guard<std::mutex> const pending_lock{pending_motion_mutex};
+
+        if (!lock.try_lock())
+        {
+            // The window manager is busy: merge motion for the lock holder to deliver. The
+            // merged events get the disposition of the last motion the policy handled.
+            if (motion_coalescer.can_merge(event))
+            {
+                motion_coalescer.merge(event);
+                motion_merged.fetch_add(1, std::memory_order_relaxed);
+                return last_motion_consumed;
+            }
+        }
+    }
+
+    // Anything merged is delivered before this (by the lock holder or the Locker)
+    if (!lock.owns_lock())
+        lock.lock();
+
+    Locker locker{this, LockEntry::handle_pointer_event, std::move(lock), requested};
+    auto const consumed = deliver_pointer_event(event);
+    locker.unlock();
+    return consumed;
+}
+
+void miral::BasicWindowManager::coalesce_pointer_motion(bool enabled)
+{
+    coalesce_motion = enabled;
+}
+
+void miral::BasicWindowManager::time_policy_hooks(std::shared_ptr<PolicyLatency> const& latency)
+{
+    policy_latency = latency;
+}
+
+void miral::BasicWindowManager::time_lock(std::shared_ptr<LockTiming> const& timing)
+{
+    lock_timing = timing;
+}
+
+auto miral::BasicWindowManager::lock_latencies() const -> std::vector<LockLatency>
+{
+    if (!lock_timing)
+        return {};
+
+    return lock_timing->latencies();
+}
+
+auto miral::BasicWindowManager::policy_latencies() const -> std::vector<PolicyHookLatency>
+{
+    if (!policy_latency)
+        return {};
+
+    return policy_latency->latencies();
+}
+
+auto miral::BasicWindowManager::pointer_motion_counts() const -> PointerMotionCounts
+{
+    return {
+        motion_received.load(std::memory_order_relaxed),
+        motion_merged.load(std::memory_order_relaxed),
+        motion_coalesced.load(std::memory_order_relaxed)};
+}
+
+auto miral::BasicWindowManager::deliver_pointer_event(MirPointerEvent const* event) -> bool
+{
     update_event_timestamp(event);
 
     cursor = {
         mir_pointer_event_axis_value(event, mir_pointer_axis_x),
         mir_pointer_event_axis_value(event, mir_pointer_axis_y)};
 
-    return policy->handle_pointer_event(event);
+    auto const consumed = timed(PolicyHook::handle_pointer_event, [&]{ return policy->handle_pointer_event(event); });
+
+    if (mir_pointer_event_action(event) == mir_pointer_action_motion)
+        last_motion_consumed = consumed;
+
+    return consumed;
+}
+
+void miral::BasicWindowManager::deliver_merged_motion(MirEvent const* event)
+{
+    motion_coalesced.fetch_add(1, std::memory_order_relaxed);
+    deliver_pointer_event(mir_input_event_get_pointer_event(mir_event_get_input_event(event)));
+}
+
+void miral::BasicWindowManager::deliver_pending_motion()
+{
+    if (!coalesce_motion)
+        return;
+
+    mir::EventUPtr pending{nullptr, [](MirEvent*){}};
+    {
+        std::lock_guard<std::mutex> const pending_lock{pending_motion_mutex};
+        pending = motion_coalescer.take_pending();
+    }
+
+    if (pending)
+        deliver_merged_motion(pending.get());
 }
 
 void miral::BasicWindowManager::handle_raise_surface(
@@ -354,9 +663,10 @@ void miral::BasicWindowManager::handle_raise_surface(
     std::shared_ptr<scene::Surface> const& surface,
     uint64_t timestamp)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::handle_raise_surface};
     if (timestamp >= last_input_event_timestamp)
-        policy->handle_raise_window(info_for(surface));
+        timed(PolicyHook::handle_raise_window, [&]{ policy->handle_raise_window(info_for(surface)); });
+    lock.unlock();
 }
 
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 27, 0)
@@ -405,28 +715,34 @@ int miral::BasicWindowManager::set_surface_attribute(
         return surface->configure(attrib, value);
     }
 
-    Locker lock{this};
+    Locker lock{this, LockEntry::set_surface_attribute};
     auto& info = info_for(surface);
 
     validate_modification_request(modification, info);
     place_and_size_for_state(modification, info);
-    policy->handle_modify_window(info, modification);
+    timed(PolicyHook::handle_modify_window, [&]{ policy->handle_modify_window(info, modification); });
 
+    int result = 0; // Can't be anything else for other attributes anyway
     switch (attrib)
     {
     case mir_window_attrib_type:
-        return info.type();
+        result = info.type();
+        break;
 
     case mir_window_attrib_state:
-        return info.state();
+        result = info.state();
+        break;
 
     case mir_window_attrib_preferred_orientation:
-        return info.preferred_orientation();
+        result = info.preferred_orientation();
         break;
 
     default:
-        return 0; // Can't get here anyway
+        break;
     }
+
+    lock.unlock();
+    return result;
 }
 
 auto miral::BasicWindowManager::count_applications() const
@@ -467,15 +783,34 @@ auto miral::BasicWindowManager::info_for(std::weak_ptr<scene::Session> const& se
 auto miral::BasicWindowManager::info_for(std::weak_ptr<scene::Surface> const& surface) const
 -> WindowInfo&
 {
-    return const_cast<WindowInfo&>(window_info.at(surface));
+    if (auto const info = window_info.find(surface_slots.at(surface)))
+        return *info;
+
+    BOOST_THROW_EXCEPTION(std::logic_error{"Surface has a stale WindowInfo slot"});
 }
 
 auto miral::BasicWindowManager::info_for(Window const& window) const
 -> WindowInfo&
 {
+    // Windows created by us know their slot, the generation check catches stale handles and
+    // the window check catches handles issued by another window manager
+    if (window.self)
+    {
+        if (auto const info = window_info.find(window.self->info_slot))
+        {
+            if (info->window() == window)
+                return *info;
+        }
+    }
+
     return info_for(std::weak_ptr<mir::scene::Surface>(window));
 }
 
+void miral::BasicWindowManager::for_each_window(std::function<void(WindowInfo& info)> const& functor)
+{
+    window_info.for_each(functor);
+}
+
 void miral::BasicWindowManager::ask_client_to_close(Window const& window)
 {
     if (auto const mir_surface = std::shared_ptr<scene::Surface>(window))
@@ -499,13 +834,15 @@ void miral::BasicWindowManager::focus_next_application()
 {
     if (auto const prev = active_window())
     {
-        auto const workspaces_containing_window = workspaces_containing(prev);
+        auto const workspaces_containing_window = workspace_set_of(prev);
 
         if (!workspaces_containing_window.empty())
         {
             do
             {
+                focus_changing();
                 focus_controller->focus_next_session();
+                focus_changed();
 
                 if (can_activate_window_for_session_in_workspace(
                     focus_controller->focused_session(),
@@ -519,7 +856,9 @@ void miral::BasicWindowManager::focus_next_application()
 
     }
 
+    focus_changing();
     focus_controller->focus_next_session();
+    focus_changed();
 
     if (can_activate_window_for_session(focus_controller->focused_session()))
         return;
@@ -546,11 +885,16 @@ auto miral::BasicWindowManager::workspaces_containing(Window const& window) cons
     return workspaces_containing_window;
 }
 
+auto miral::BasicWindowManager::workspace_set_of(Window const& window) -> WorkspaceSet&
+{
+    return window.self->workspaces;
+}
+
 void miral::BasicWindowManager::focus_next_within_application()
 {
     if (auto const prev = active_window())
     {
-        auto const workspaces_containing_window = workspaces_containing(prev);
+        auto const workspaces_containing_window = workspace_set_of(prev);
         auto const& siblings = info_for(prev.application()).windows();
         auto current = find(begin(siblings), end(siblings), prev);
 
@@ -558,33 +902,17 @@ void miral::BasicWindowManager::focus_next_within_application()
         {
             while (++current != end(siblings))
             {
-                for (auto const& workspace : workspaces_containing(*current))
-                {
-                    for (auto const& ww : workspaces_containing_window)
-                    {
-                        if (ww == workspace)
-                        {
-                            if (prev != select_active_window(*current))
-                                return;
-                        }
-                    }
-                }
+                if (workspace_set_of(*current).intersects(workspaces_containing_window) &&
+                    prev != select_active_window(*current))
+                    return;
             }
         }
 
         for (current = begin(siblings); *current != prev; ++current)
         {
-            for (auto const& workspace : workspaces_containing(*current))
-            {
-                for (auto const& ww : workspaces_containing_window)
-                {
-                    if (ww == workspace)
-                    {
-                        if (prev != select_active_window(*current))
-                            return;
-                    }
-                }
-            }
+            if (workspace_set_of(*current).intersects(workspaces_containing_window) &&
+                prev != select_active_window(*current))
+                return;
         }
 
         current = find(begin(siblings), end(siblings), prev);
@@ -607,7 +935,7 @@ void miral::BasicWindowManager::focus_prev_within_application()
 {
     if (auto const prev = active_window())
     {
-        auto const workspaces_containing_window = workspaces_containing(prev);
+        auto const workspaces_containing_window = workspace_set_of(prev);
         auto const& siblings = info_for(prev.application()).windows();
         auto current = find(rbegin(siblings), rend(siblings), prev);
 
@@ -615,33 +943,17 @@ void miral::BasicWindowManager::focus_prev_within_application()
         {
             while (++current != rend(siblings))
             {
-                for (auto const& workspace : workspaces_containing(*current))
-                {
-                    for (auto const& ww : workspaces_containing_window)
-                    {
-                        if (ww == workspace)
-                        {
-                            if (prev != select_active_window(*current))
-                                return;
-                        }
-                    }
-                }
+                if (workspace_set_of(*current).intersects(workspaces_containing_window) &&
+                    prev != select_active_window(*current))
+                    return;
             }
         }
 
         for (current = rbegin(siblings); *current != prev; ++current)
         {
-            for (auto const& workspace : workspaces_containing(*current))
-            {
-                for (auto const& ww : workspaces_containing_window)
-                {
-                    if (ww == workspace)
-                    {
-                        if (prev != select_active_window(*current))
-                            return;
-                    }
-                }
-            }
+            if (workspace_set_of(*current).intersects(workspaces_containing_window) &&
+                prev != select_active_window(*current))
+                return;
         }
 
         current = find(rbegin(siblings), rend(siblings), prev);
@@ -667,34 +979,101 @@ auto miral::BasicWindowManager::window_at(geometry::Point cursor) const
     return surface_at ? info_for(surface_at).window() : Window{};
 }
 
+auto miral::BasicWindowManager::windows_intersecting(geometry::Rectangle const& rect) const
+-> std::vector<Window>
+{
+    std::vector<Window> result;
+    spatial_index.windows_intersecting(rect, result);
+
+    result.erase(
+        std::remove_if(begin(result), end(result), [this](Window const& window)
+            { return !info_for(window).is_visible(); }),
+        end(result));
+
+    return result;
+}
+
 auto miral::BasicWindowManager::active_display()
 -> geometry::Rectangle const
 {
-    geometry::Rectangle result;
+    using Step = ActiveDisplayCache::Step;
 
-    // 1. If a window has input focus, whichever display contains the largest
-    //    proportion of the area of that window.
-    if (auto const surface = focus_controller->focused_surface())
-    {
-        auto const surface_rect = surface->input_bounds();
-        int max_overlap_area = -1;
+    std::lock_guard<std::mutex> lock{active_display_mutex};
+    auto& cache = active_display_cache;
 
-        for (auto const& display : displays)
+    auto const cursor_on_a_display = [this]
+        {
+            for (auto const& display : displays)
+            {
+                if (display.contains(cursor))
+                    return true;
+            }
+            return false;
+        };
+
+    if (cache.display_generation == display_generation)
+    {
+        switch (cache.step)
         {
-            auto const intersection = surface_rect.intersection_with(display).size;
-            if (intersection.width.as_int()*intersection.height.as_int() > max_overlap_area)
+        case Step::focused_window:
+            if (auto const surface = cache.focused.lock())
             {
-                max_overlap_area = intersection.width.as_int()*intersection.height.as_int();
-                result = display;
+                if (surface->input_bounds() == cache.focused_bounds)
+                    return cache.display;
             }
+            break;
+
+        case Step::last_focused_window:
+            return cache.display;
+
+        case Step::cursor:
+            if (cache.display.contains(cursor))
+                return cache.display;
+            break;
+
+        case Step::fallback:
+            // Step 3 applies once the pointer is on a display
+            if (!cursor_on_a_display())
+                return cache.display;
+            break;
+
+        case Step::none:
+            break;
         }
-        return result;
+    }
+
+    cache = ActiveDisplayCache{};
+    cache.display_generation = display_generation;
+
+    // 1. If a window has input focus, whichever display contains the largest
+    //    proportion of the area of that window.
+    if (auto const surface = focus_controller->focused_surface())
+    {
+        cache.step = Step::focused_window;
+        cache.focused = surface;
+        cache.focused_bounds = surface->input_bounds();
+        cache.display = display_containing_most_of(cache.focused_bounds);
+
+        has_last_focused_display = true;
+        last_focused_display = cache.display;
+        return cache.display;
     }
 
     // 2. Otherwise, if any window previously had input focus, for the window that had
     //    it most recently, the display that contained the largest proportion of the
     //    area of that window at the moment it closed, as long as that display is still
     //    available.
+    if (has_last_focused_display)
+    {
+        for (auto const& display : displays)
+        {
+            if (display == last_focused_display)
+            {
+                cache.step = Step::last_focused_window;
+                return cache.display = display;
+            }
+        }
+    }
 
     // 3. Otherwise, the display that contains the pointer, if there is one.
     for (auto const& display : displays)
@@ -702,43 +1081,90 @@ auto miral::BasicWindowManager::active_display()
         if (display.contains(cursor))
         {
             // Ignore the (unspecified) possiblity of overlapping displays
-            return display;
+            cache.step = Step::cursor;
+            return cache.display = display;
         }
     }
 
+    cache.step = Step::fallback;
+
     // 4. Otherwise, the primary display, if there is one (for example, the laptop display).
+    //    (Mir doesn't say which display is primary, so take the one at the origin.)
+    for (auto const& display : displays)
+    {
+        if (display.contains(Point{0, 0}))
+            return cache.display = display;
+    }
 
     // 5. Otherwise, the first display.
     if (displays.size())
-        result = *displays.begin();
+        cache.display = *displays.begin();
+
+    return cache.display;
+}
+
+auto miral::BasicWindowManager::display_containing_most_of(Rectangle const& rect) const -> Rectangle
+{
+    Rectangle result;
+    int max_overlap_area = -1;
+
+    for (auto const& display : displays)
+    {
+        auto const intersection = rect.intersection_with(display).size;
+        if (intersection.width.as_int()*intersection.height.as_int() > max_overlap_area)
+        {
+            max_overlap_area = intersection.width.as_int()*intersection.height.as_int();
+            result = display;
+        }
+    }
 
     return result;
 }
 
-void miral::BasicWindowManager::raise_tree(Window const& root)
+// Remember where the window losing focus is now, for step 2 of active_display(). This
+// doesn't depend on active_display() having been called while the window had focus.
+void miral::BasicWindowManager::focus_changing()
 {
-    auto const& info = info_for(root);
+    if (auto const surface = focus_controller->focused_surface())
+    {
+        auto const display = display_containing_most_of(surface->input_bounds());
 
-    if (auto parent = info.parent())
-        raise_tree(parent);
+        std::lock_guard<std::mutex> lock{active_display_mutex};
+        has_last_focused_display = true;
+        last_focused_display = display;
+    }
+}
 
-    std::vector<Window> windows;
+void miral::BasicWindowManager::focus_changed()
+{
+    std::lock_guard<std::mutex> lock{active_display_mutex};
+    active_display_cache.step = ActiveDisplayCache::Step::none;
+}
 
-    std::function<void(WindowInfo const& info)> const add_children =
-        [&,this](WindowInfo const& info)
-            {
-                for (auto const& child : info.children())
-                {
-                    windows.push_back(child);
-                    add_children(info_for(child));
-                }
-            };
+void miral::BasicWindowManager::raise_tree(Window const& root)
+{
+    // Raising a window raises its ancestors: collect the whole tree once, with the branch
+    // down to root after its siblings at each level, rather than raising each ancestor.
+    WindowTreeWalker walker{tree_scratch};
+    auto const& windows = walker.collect_raising(root, [this](Window const& window) -> WindowInfo const&
+        { return info_for(window); });
+    auto const& branch = walker.raising_branch();
 
-    windows.push_back(root);
-    add_children(info);
+    timed(PolicyHook::advise_raise, [&]{ policy->advise_raise(windows); });
 
-    policy->advise_raise(windows);
-    focus_controller->raise({begin(windows), end(windows)});
+    // The focus controller and spatial index keep the current order of the windows they raise
+    // together, so raise each level (a window on the branch and the siblings collected before
+    // it) in turn.
+    auto level = begin(windows);
+    for (auto next_on_branch = begin(branch) + 1; next_on_branch != end(branch); ++next_on_branch)
+    {
+        auto const level_end = std::find(level, end(windows), *next_on_branch);
+        focus_controller->raise({level, level_end});
+        spatial_index.raise(level, level_end);
+        level = level_end;
+    }
+    focus_controller->raise({level, end(windows)});
+    spatial_index.raise(level, end(windows));
 }
 
 void miral::BasicWindowManager::move_tree(miral::WindowInfo& root, mir::geometry::Displacement movement)
@@ -748,96 +1174,221 @@ void miral::BasicWindowManager::move_tree(miral::WindowInfo& root, mir::geometry
 
     auto const top_left = root.window().top_left() + movement;
 
-    policy->advise_move_to(root, top_left);
+    timed(PolicyHook::advise_move_to, [&]{ policy->advise_move_to(root, top_left); });
     root.window().move_to(top_left);
 
     for (auto const& child: root.children())
     {
-        auto const& pos = policy->confirm_inherited_move(info_for(child), movement);
+        auto const& pos = timed(PolicyHook::confirm_inherited_move,
+            [&]{ return policy->confirm_inherited_move(info_for(child), movement); });
         place_and_size(info_for(child), pos.top_left, pos.size);
     }
 }
 
-void miral::BasicWindowManager::modify_window(WindowInfo& window_info, WindowSpecification const& modifications)
+void miral::BasicWindowManager::modify_windows(
+    std::vector<std::pair<Window, WindowSpecification>> const& modifications)
 {
-    WindowInfo window_info_tmp{window_info};
+    // Check everything before changing anything
+    for (auto const& modification : modifications)
+        changes_for(info_for(modification.first), modification.second);
 
-#define COPY_IF_SET(field)\
-    if (modifications.field().is_set())\
-        window_info_tmp.field(modifications.field().value())
+    bool const outermost = !modifying_windows;
+    modifying_windows = true;
 
-    COPY_IF_SET(name);
-    COPY_IF_SET(type);
+    try
+    {
+        for (auto const& modification : modifications)
+            modify_window(info_for(modification.first), modification.second);
+    }
+    catch (...)
+    {
+        // The modifications made before the throw are still finished and advised. (Should
+        // that throw too, it is the first exception that is reported.)
+        if (outermost)
+        {
+            try { end_modifying_windows(); } catch (...) {}
+        }
+        throw;
+    }
+
+    if (outermost)
+        end_modifying_windows();
+}
+
+void miral::BasicWindowManager::end_modifying_windows()
+{
+    modifying_windows = false;
+
+    // If nothing was active, the first window shown takes focus (and is raised) now
+    if (auto const window = shown_window_to_activate)
+    {
+        shown_window_to_activate = {};
+
+        if (info_for(window).is_visible())
+            select_active_window(window);
+    }
+
+    // If the active window was hidden it has stayed active until now
+    if (auto const window = hidden_active_window)
+    {
+        hidden_active_window = {};
+
+        switch (info_for(window).state())
+        {
+        case mir_window_state_hidden:
+        case mir_window_state_minimized:
+            if (window == active_window())
+                hide_active_window(window);
+            else
+                mru_active_windows.set_visible(window, false);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Each window changed is advised once, with all its changes, after every change is made
+    std::vector<std::pair<Window, WindowChanges>> changed;
+    changed.swap(pending_window_changes);
+    pending_window_change_index.clear();
+
+    for (auto const& change : changed)
+        timed(PolicyHook::advise_window_changed,
+            [&]{ window_change_policy->advise_window_changed(info_for(change.first), change.second); });
+}
+
+auto miral::BasicWindowManager::changes_for(
+    WindowInfo const& window_info,
+    WindowSpecification const& modifications) const -> WindowChanges
+{
+    WindowChanges changes;
+
+#define CHANGE_IF_DIFFERENT(field)\
+    if (modifications.field().is_set() && differs(window_info.field(), modifications.field().value()))\
+        changes.insert(WindowChange::field)
+
+    CHANGE_IF_DIFFERENT(name);
+    CHANGE_IF_DIFFERENT(type);
     // state is handled "differently" and only updated by set_state() at the end
-    COPY_IF_SET(min_width);
-    COPY_IF_SET(min_height);
-    COPY_IF_SET(max_width);
-    COPY_IF_SET(max_height);
-    COPY_IF_SET(width_inc);
-    COPY_IF_SET(height_inc);
-    COPY_IF_SET(min_aspect);
-    COPY_IF_SET(max_aspect);
-    COPY_IF_SET(output_id);
-    COPY_IF_SET(preferred_orientation);
-    COPY_IF_SET(confine_pointer);
-    COPY_IF_SET(userdata);
-    COPY_IF_SET(shell_chrome);
+    CHANGE_IF_DIFFERENT(min_width);
+    CHANGE_IF_DIFFERENT(min_height);
+    CHANGE_IF_DIFFERENT(max_width);
+    CHANGE_IF_DIFFERENT(max_height);
+    CHANGE_IF_DIFFERENT(width_inc);
+    CHANGE_IF_DIFFERENT(height_inc);
+    CHANGE_IF_DIFFERENT(min_aspect);
+    CHANGE_IF_DIFFERENT(max_aspect);
+    CHANGE_IF_DIFFERENT(preferred_orientation);
+    CHANGE_IF_DIFFERENT(confine_pointer);
+    CHANGE_IF_DIFFERENT(userdata);
+    CHANGE_IF_DIFFERENT(shell_chrome);
 
-#undef COPY_IF_SET
+#undef CHANGE_IF_DIFFERENT
 
-    if (modifications.parent().is_set())
-        window_info_tmp.parent(info_for(modifications.parent().value()).window());
+    if (modifications.output_id().is_set() &&
+        (!window_info.has_output_id() || window_info.output_id() != modifications.output_id().value()))
+        changes.insert(WindowChange::output_id);
 
-    if (window_info.type() != window_info_tmp.type())
+    if (modifications.parent().is_set() &&
+        info_for(modifications.parent().value()).window() != window_info.parent())
+        changes.insert(WindowChange::parent);
+
+    if (changes.contains(WindowChange::type))
     {
-        auto const new_type = window_info_tmp.type();
+        auto const new_type = modifications.type().value();
 
         if (!window_info.can_morph_to(new_type))
         {
             throw std::runtime_error("Unsupported window type change");
         }
 
-        if (window_info_tmp.must_not_have_parent())
+        WindowInfo morphed;
+        morphed.type(new_type);
+
+        if (morphed.must_not_have_parent())
         {
             if (modifications.parent().is_set())
                 throw std::runtime_error("Target window type does not support parent");
 
-            window_info_tmp.parent({});
+            if (window_info.parent())
+                changes.insert(WindowChange::parent);
         }
-        else if (window_info_tmp.must_have_parent())
+        else if (morphed.must_have_parent())
         {
-            if (!window_info_tmp.parent())
+            auto const new_parent = modifications.parent().is_set() ?
+                info_for(modifications.parent().value()).window() : window_info.parent();
+
+            if (!new_parent)
                 throw std::runtime_error("Target window type requires parent");
         }
     }
 
-    std::swap(window_info_tmp, window_info);
+    return changes;
+}
 
-    auto& window = window_info.window();
+void miral::BasicWindowManager::modify_window(WindowInfo& window_info, WindowSpecification const& modifications)
+{
+    auto changes = changes_for(window_info, modifications);
 
-    if (window_info.type() != window_info_tmp.type())
+    auto& window = window_info.window();
+    auto const old_state = window_info.state();
+    auto const old_top_left = window.top_left();
+    auto const old_size = window.size();
+
+    // The changes are valid, so apply them in place. Only setting the name can throw
+    // (it allocates), so doing that first leaves nothing to roll back.
+    if (changes.contains(WindowChange::name))
+        window_info.name(modifications.name().value());
+
+#define APPLY_IF_CHANGED(field)\
+    if (changes.contains(WindowChange::field))\
+        window_info.field(modifications.field().value())
+
+    APPLY_IF_CHANGED(type);
+    APPLY_IF_CHANGED(min_width);
+    APPLY_IF_CHANGED(min_height);
+    APPLY_IF_CHANGED(max_width);
+    APPLY_IF_CHANGED(max_height);
+    APPLY_IF_CHANGED(width_inc);
+    APPLY_IF_CHANGED(height_inc);
+    APPLY_IF_CHANGED(min_aspect);
+    APPLY_IF_CHANGED(max_aspect);
+    APPLY_IF_CHANGED(output_id);
+    APPLY_IF_CHANGED(preferred_orientation);
+    APPLY_IF_CHANGED(confine_pointer);
+    APPLY_IF_CHANGED(userdata);
+    APPLY_IF_CHANGED(shell_chrome);
+
+#undef APPLY_IF_CHANGED
+
+    if (changes.contains(WindowChange::type))
         std::shared_ptr<scene::Surface>(window)->configure(mir_window_attrib_type, window_info.type());
 
-    if (window_info.parent() != window_info_tmp.parent())
+    if (changes.contains(WindowChange::parent))
     {
-        if (window_info_tmp.parent())
-        {
-            auto& parent_info = info_for(window_info_tmp.parent());
-            parent_info.remove_child(window);
-        }
+        // Either a new parent, or none for a type that mustn't have one
+        auto const old_parent = window_info.parent();
+        auto const new_parent = modifications.parent().is_set() ?
+            info_for(modifications.parent().value()).window() : Window{};
 
-        if (window_info.parent())
-        {
-            auto& parent_info = info_for(window_info.parent());
-            parent_info.add_child(window);
-        }
+        window_info.parent(new_parent);
+
+        if (old_parent)
+            info_for(old_parent).remove_child(window);
+
+        if (new_parent)
+            info_for(new_parent).add_child(window);
     }
 
-    if (modifications.name().is_set())
+    if (changes.contains(WindowChange::name))
         std::shared_ptr<scene::Surface>(window)->rename(modifications.name().value());
 
     if (modifications.input_shape().is_set())
+    {
         std::shared_ptr<scene::Surface>(window)->set_input_region(modifications.input_shape().value());
+        changes.insert(WindowChange::input_shape);
+    }
 
     if (modifications.state().is_set() && window_info.state() != modifications.state().value())
     {
@@ -917,6 +1468,34 @@ void miral::BasicWindowManager::modify_window(WindowInfo& window_info, WindowSpe
     if (modifications.confine_pointer().is_set())
         std::shared_ptr<scene::Surface>(window)->set_confine_pointer_state(modifications.confine_pointer().value());
 #endif
+
+    if (window_info.state() != old_state)
+        changes.insert(WindowChange::state);
+
+    if (window.top_left() != old_top_left)
+        changes.insert(WindowChange::top_left);
+
+    if (window.size() != old_size)
+        changes.insert(WindowChange::size);
+
+    if (changes.empty())
+        return;
+
+    if (modifying_windows)
+    {
+        // The changes are advised in the order the windows were first changed
+        auto const index = pending_window_change_index.emplace(window, pending_window_changes.size());
+
+        if (!index.second)
+            pending_window_changes[index.first->second].second.insert(changes);
+        else
+            pending_window_changes.emplace_back(window, changes);
+    }
+    else
+    {
+        timed(PolicyHook::advise_window_changed,
+            [&]{ window_change_policy->advise_window_changed(window_info, changes); });
+    }
 }
 
 auto miral::BasicWindowManager::info_for_window_id(std::string const& id) const -> WindowInfo&
@@ -950,7 +1529,7 @@ void miral::BasicWindowManager::place_and_size(WindowInfo& root, Point const& ne
 {
     if (root.window().size() != new_size)
     {
-        policy->advise_resize(root, new_size);
+        timed(PolicyHook::advise_resize, [&]{ policy->advise_resize(root, new_size); });
         root.window().resize(new_size);
     }
 
@@ -1094,55 +1673,20 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
     bool const was_hidden = window_info.state() == mir_window_state_hidden ||
                             window_info.state() == mir_window_state_minimized;
 
-    policy->advise_state_change(window_info, value);
+    timed(PolicyHook::advise_state_change, [&]{ policy->advise_state_change(window_info, value); });
 
     switch (value)
     {
     case mir_window_state_hidden:
     case mir_window_state_minimized:
         window_info.state(value);
-        if (window == active_window())
-        {
-            select_active_window(window);
 
-            if (window == active_window() || !active_window())
-            {
-                auto const workspaces_containing_window = workspaces_containing(window);
-
-                // Try to activate to recently active window of any application
-                mru_active_windows.enumerate([&](Window& candidate)
-                    {
-                        if (candidate == window)
-                            return true;
-                        auto const w = candidate;
-                        for (auto const& workspace : workspaces_containing(w))
-                        {
-                            for (auto const& ww : workspaces_containing_window)
-                            {
-                                if (ww == workspace)
-                                {
-                                    return !(select_active_window(w));
-                                }
-                            }
-                        }
-
-                        return true;
-                    });
-            }
-
-            // Try to activate to recently active window of any application
-            if (window == active_window() || !active_window())
-                mru_active_windows.enumerate([&](Window& candidate)
-                {
-                    if (candidate == window)
-                        return true;
-                    auto const w = candidate;
-                    return !(select_active_window(w));
-                });
-
-            if (window == active_window())
-                select_active_window({});
-        }
+        if (window != active_window())
+            mru_active_windows.set_visible(window, false);
+        else if (modifying_windows)
+            hidden_active_window = window;
+        else
+            hide_active_window(window);
 
         mir_surface->configure(mir_window_attrib_state, value);
         mir_surface->hide();
@@ -1152,15 +1696,57 @@ void miral::BasicWindowManager::set_state(miral::WindowInfo& window_info, MirWin
     default:
         auto const none_active = !active_window();
         window_info.state(value);
+        mru_active_windows.set_visible(window, true);
         mir_surface->configure(mir_window_attrib_state, value);
         mir_surface->show();
         if (was_hidden && none_active)
         {
-            select_active_window(window);
+            if (!modifying_windows)
+                select_active_window(window);
+            else if (!shown_window_to_activate)
+                shown_window_to_activate = window;
         }
     }
 }
 
+// The window was active and has been hidden (or minimized): activate another
+void miral::BasicWindowManager::hide_active_window(Window const& window)
+{
+    select_active_window(window);
+
+    if (window == active_window() || !active_window())
+    {
+        auto const workspaces_containing_window = workspace_set_of(window);
+
+        // Try to activate to recently active window of any application
+        mru_active_windows.enumerate([&](Window& candidate)
+            {
+                if (candidate == window)
+                    return true;
+                auto const w = candidate;
+                if (workspace_set_of(w).intersects(workspaces_containing_window))
+                    return !(select_active_window(w));
+
+                return true;
+            });
+    }
+
+    // Try to activate to recently active window of any application
+    if (window == active_window() || !active_window())
+        mru_active_windows.enumerate([&](Window& candidate)
+        {
+            if (candidate == window)
+                return true;
+            auto const w = candidate;
+            return !(select_active_window(w));
+        });
+
+    if (window == active_window())
+        select_active_window({});
+
+    mru_active_windows.set_visible(window, false);
+}
+
 void miral::BasicWindowManager::update_event_timestamp(MirKeyboardEvent const* kev)
 {
     auto iev = mir_keyboard_event_input_event(kev);
@@ -1197,8 +1783,25 @@ void miral::BasicWindowManager::update_event_timestamp(MirTouchEvent const* tev)
 
 void miral::BasicWindowManager::invoke_under_lock(std::function<void()> const& callback)
 {
-    Locker lock{this};
+    Locker lock{this, LockEntry::invoke_under_lock};
     callback();
+    lock.unlock();
+}
+
+// Readers can't deliver merged motion themselves, so if any arrived the lock is retaken
+// exclusively (and the Locker delivers it). This isn't done by ~SharedLocker() as the
+// policy could throw. (If the callback throws the motion waits for the next Locker.)
+void miral::BasicWindowManager::invoke_under_shared_lock(std::function<void()> const& callback)
+{
+    bool motion_pending;
+    {
+        SharedLocker lock{this};
+        callback();
+        motion_pending = lock.unlock();
+    }
+
+    if (motion_pending)
+        Locker{this, LockEntry::deliver_pending_motion}.unlock();
 }
 
 auto miral::BasicWindowManager::select_active_window(Window const& hint) -> miral::Window
@@ -1209,8 +1812,10 @@ auto miral::BasicWindowManager::select_active_window(Window const& hint) -> mira
     {
         if (prev_window)
         {
+            focus_changing();
             focus_controller->set_focus_to(hint.application(), hint);
-            policy->advise_focus_lost(info_for(prev_window));
+            focus_changed();
+            timed(PolicyHook::advise_focus_lost, [&]{ policy->advise_focus_lost(info_for(prev_window)); });
         }
 
         return hint;
@@ -1229,12 +1834,14 @@ auto miral::BasicWindowManager::select_active_window(Window const& hint) -> mira
     if (info_for_hint.can_be_active() && info_for_hint.is_visible())
     {
         mru_active_windows.push(hint);
+        focus_changing();
         focus_controller->set_focus_to(hint.application(), hint);
+        focus_changed();
 
         if (prev_window && prev_window != hint)
-            policy->advise_focus_lost(info_for(prev_window));
+            timed(PolicyHook::advise_focus_lost, [&]{ policy->advise_focus_lost(info_for(prev_window)); });
 
-        policy->advise_focus_gained(info_for_hint);
+        timed(PolicyHook::advise_focus_gained, [&]{ policy->advise_focus_gained(info_for_hint); });
         return hint;
     }
     else
@@ -1329,7 +1936,7 @@ auto miral::BasicWindowManager::can_activate_window_for_session(miral::Applicati
 
 auto miral::BasicWindowManager::can_activate_window_for_session_in_workspace(
     Application const& session,
-    std::vector<std::shared_ptr<Workspace>> const& workspaces) -> bool
+    WorkspaceSet const& workspaces) -> bool
 {
     miral::Window new_focus;
 
@@ -1341,14 +1948,8 @@ auto miral::BasicWindowManager::can_activate_window_for_session_in_workspace(
             if (w.application() != session)
                 return true;
 
-            for (auto const& workspace : workspaces_containing(w))
-            {
-                for (auto const& ww : workspaces)
-                {
-                    if (ww == workspace)
-                        return !(new_focus = select_active_window(w));
-                }
-            }
+            if (workspace_set_of(w).intersects(workspaces))
+                return !(new_focus = select_active_window(w));
 
             return true;
         });
@@ -1894,15 +2495,17 @@ void miral::BasicWindowManager::validate_modification_request(WindowSpecificatio
 class miral::Workspace
 {
 public:
-    explicit Workspace(std::shared_ptr<miral::BasicWindowManager::DeadWorkspaces> const& dead_workspaces) :
-        dead_workspaces{dead_workspaces} {}
+    Workspace(std::shared_ptr<miral::BasicWindowManager::DeadWorkspaces> const& dead_workspaces, unsigned id) :
+        id{id}, dead_workspaces{dead_workspaces} {}
 
     std::weak_ptr<Workspace> self;
+    unsigned const id;
 
     ~Workspace()
     {
         std::lock_guard<std::mutex> lock {dead_workspaces->dead_workspaces_mutex};
-        dead_workspaces->workspaces.push_back(self);
+        dead_workspaces->workspaces.emplace_back(self, id);
+        dead_workspaces->purge_needed.store(true, std::memory_order_relaxed);
     }
 
 private:
@@ -1911,7 +2514,22 @@ private:
 
 auto miral::BasicWindowManager::create_workspace() -> std::shared_ptr<Workspace>
 {
-    auto const result = std::make_shared<Workspace>(dead_workspaces);
+    unsigned id;
+    {
+        std::lock_guard<std::mutex> const lock{dead_workspaces->dead_workspaces_mutex};
+
+        if (dead_workspaces->free_ids.empty())
+        {
+            id = dead_workspaces->next_id++;
+        }
+        else
+        {
+            id = dead_workspaces->free_ids.back();
+            dead_workspaces->free_ids.pop_back();
+        }
+    }
+
+    auto const result = std::make_shared<Workspace>(dead_workspaces, id);
     result->self = result;
     return result;
 }
@@ -1930,37 +2548,26 @@ void miral::BasicWindowManager::add_tree_to_workspace(
         info = &info_for(root);
     }
 
-    std::vector<Window> windows;
+    WindowTreeWalker walker{tree_scratch};
+    auto const& windows = walker.collect(root, [this](Window const& window) -> WindowInfo const&
+        { return info_for(window); });
 
-    std::function<void(WindowInfo const& info)> const add_children =
-        [&,this](WindowInfo const& info)
-        {
-            for (auto const& child : info.children())
-            {
-                windows.push_back(child);
-                add_children(info_for(child));
-            }
-        };
-
-    windows.push_back(root);
-    add_children(*info);
-
-    auto const iter_pair = workspaces_to_windows.left.equal_range(workspace);
-
-    std::vector<Window> windows_added;
+    auto& windows_added = walker.selected();
 
     for (auto& w : windows)
     {
-        if (!std::count_if(iter_pair.first, iter_pair.second,
-                           [&w](wwbimap_t::left_value_type const& kv) { return kv.second == w; }))
+        auto& workspaces_containing_w = workspace_set_of(w);
+        if (!workspaces_containing_w.contains(workspace->id))
         {
+            workspaces_containing_w.insert(workspace->id);
             workspaces_to_windows.left.insert(wwbimap_t::left_value_type{workspace, w});
             windows_added.push_back(w);
         }
     }
 
     if (!windows_added.empty())
-        workspace_policy->advise_adding_to_workspace(workspace, windows_added);
+        timed(PolicyHook::advise_adding_to_workspace,
+            [&]{ workspace_policy->advise_adding_to_workspace(workspace, windows_added); });
 }
 
 void miral::BasicWindowManager::remove_tree_from_workspace(
@@ -1977,36 +2584,37 @@ void miral::BasicWindowManager::remove_tree_from_workspace(
         info = &info_for(root);
     }
 
-    std::vector<Window> windows;
-
-    std::function<void(WindowInfo const& info)> const add_children =
-        [&,this](WindowInfo const& info)
-        {
-            for (auto const& child : info.children())
-            {
-                windows.push_back(child);
-                add_children(info_for(child));
-            }
-        };
-
-    windows.push_back(root);
-    add_children(*info);
+    WindowTreeWalker walker{tree_scratch};
+    auto const& windows = walker.collect(root, [this](Window const& window) -> WindowInfo const&
+        { return info_for(window); });
 
-    std::vector<Window> windows_removed;
+    auto& windows_removed = walker.selected();
 
-    auto const iter_pair = workspaces_to_windows.left.equal_range(workspace);
-    for (auto kv = iter_pair.first; kv != iter_pair.second;)
+    // The per-window workspace sets say which windows of the tree to remove, so only their
+    // (few) entries in the right view are searched
+    for (auto const& w : windows)
     {
-        auto const current = kv++;
-        if (std::count(begin(windows), end(windows), current->second))
+        auto& workspaces_containing_w = workspace_set_of(w);
+        if (workspaces_containing_w.contains(workspace->id))
         {
-            windows_removed.push_back(current->second);
-            workspaces_to_windows.left.erase(current);
+            workspaces_containing_w.erase(workspace->id);
+            windows_removed.push_back(w);
+
+            auto const iter_pair = workspaces_to_windows.right.equal_range(w);
+            for (auto kv = iter_pair.first; kv != iter_pair.second; ++kv)
+            {
+                if (kv->second.lock() == workspace)
+                {
+                    workspaces_to_windows.right.erase(kv);
+                    break;
+                }
+            }
         }
     }
 
     if (!windows_removed.empty())
-        workspace_policy->advise_removing_from_workspace(workspace, windows_removed);
+        timed(PolicyHook::advise_removing_from_workspace,
+            [&]{ workspace_policy->advise_removing_from_workspace(workspace, windows_removed); });
 }
 
 void miral::BasicWindowManager::move_workspace_content_to_workspace(
@@ -2018,28 +2626,31 @@ void miral::BasicWindowManager::move_workspace_content_to_workspace(
     for (auto kv = iter_pair_from.first; kv != iter_pair_from.second;)
     {
         auto const current = kv++;
+        workspace_set_of(current->second).erase(from_workspace->id);
         windows_removed.push_back(current->second);
         workspaces_to_windows.left.erase(current);
     }
 
     if (!windows_removed.empty())
-        workspace_policy->advise_removing_from_workspace(from_workspace, windows_removed);
+        timed(PolicyHook::advise_removing_from_workspace,
+            [&]{ workspace_policy->advise_removing_from_workspace(from_workspace, windows_removed); });
 
     std::vector<Window> windows_added;
 
-    auto const iter_pair_to = workspaces_to_windows.left.equal_range(to_workspace);
     for (auto& w : windows_removed)
     {
-        if (!std::count_if(iter_pair_to.first, iter_pair_to.second,
-                           [&w](wwbimap_t::left_value_type const& kv) { return kv.second == w; }))
+        auto& workspaces_containing_w = workspace_set_of(w);
+        if (!workspaces_containing_w.contains(to_workspace->id))
         {
+            workspaces_containing_w.insert(to_workspace->id);
             workspaces_to_windows.left.insert(wwbimap_t::left_value_type{to_workspace, w});
             windows_added.push_back(w);
         }
     }
 
     if (!windows_added.empty())
-        workspace_policy->advise_adding_to_workspace(to_workspace, windows_added);
+        timed(PolicyHook::advise_adding_to_workspace,
+            [&]{ workspace_policy->advise_adding_to_workspace(to_workspace, windows_added); });
 }
 
 void miral::BasicWindowManager::for_each_workspace_containing(
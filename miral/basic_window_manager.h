@@ -22,10 +22,19 @@
 #include "window_manager_tools_implementation.h"
 
 #include "miral/window_management_policy.h"
+#include "miral/window_change_policy.h"
 #include "miral/window_info.h"
 #include "miral/application.h"
 #include "miral/application_info.h"
 #include "mru_window_list.h"
+#include "lock_timing.h"
+#include "pointer_motion_coalescer.h"
+#include "policy_latency.h"
+#include "slot_map.h"
+#include "spatial_index.h"
+#include "weak_ptr_hash_map.h"
+#include "window_tree_walker.h"
+#include "workspace_set.h"
 
 #include <mir/geometry/rectangles.h>
 #include <mir/shell/abstract_shell.h>
@@ -35,8 +44,10 @@
 #include <boost/bimap.hpp>
 #include <boost/bimap/multiset_of.hpp>
 
+#include <atomic>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 
 namespace mir
 {
@@ -46,6 +57,7 @@ namespace shell { class DisplayLayout; class PersistentSurfaceStore; }
 namespace miral
 {
 class WorkspacePolicy;
+class WindowChangePolicy;
 using mir::shell::SurfaceSet;
 using WindowManagementPolicyBuilder =
     std::function<std::unique_ptr<miral::WindowManagementPolicy>(miral::WindowManagerTools const& tools)>;
@@ -91,6 +103,16 @@ public:
 
     bool handle_pointer_event(MirPointerEvent const* event) override;
 
+    /// Merge consecutive pointer motion that arrives while the window manager is busy
+    /// (off by default). Call before the window manager is in use.
+    void coalesce_pointer_motion(bool enabled);
+
+    /// Time the calls to the policy (off by default). Call before the window manager is in use.
+    void time_policy_hooks(std::shared_ptr<PolicyLatency> const& latency);
+
+    /// Time waiting for and holding the lock (off by default). Call before the window manager is in use.
+    void time_lock(std::shared_ptr<LockTiming> const& timing);
+
     void handle_raise_surface(
         std::shared_ptr<mir::scene::Session> const& session,
         std::shared_ptr<mir::scene::Surface> const& surface,
@@ -158,12 +180,16 @@ public:
 
     auto window_at(mir::geometry::Point cursor) const -> Window override;
 
+    auto windows_intersecting(mir::geometry::Rectangle const& rect) const -> std::vector<Window> override;
+
     auto active_display() -> mir::geometry::Rectangle const override;
 
     void raise_tree(Window const& root) override;
 
     void modify_window(WindowInfo& window_info, WindowSpecification const& modifications) override;
 
+    void modify_windows(std::vector<std::pair<Window, WindowSpecification>> const& modifications) override;
+
     auto info_for_window_id(std::string const& id) const -> WindowInfo& override;
 
     auto id_for_window(Window const& window) const -> std::string override;
@@ -171,9 +197,20 @@ public:
 
     void invoke_under_lock(std::function<void()> const& callback) override;
 
+    void invoke_under_shared_lock(std::function<void()> const& callback) override;
+
+    void for_each_window(std::function<void(WindowInfo& info)> const& functor) override;
+
+    auto pointer_motion_counts() const -> PointerMotionCounts override;
+
+    auto policy_latencies() const -> std::vector<PolicyHookLatency> override;
+
+    auto lock_latencies() const -> std::vector<LockLatency> override;
+
 private:
-    using SurfaceInfoMap = std::map<std::weak_ptr<mir::scene::Surface>, WindowInfo, std::owner_less<std::weak_ptr<mir::scene::Surface>>>;
-    using SessionInfoMap = std::map<std::weak_ptr<mir::scene::Session>, ApplicationInfo, std::owner_less<std::weak_ptr<mir::scene::Session>>>;
+    using WindowInfoSlots = SlotMap<WindowInfo>;
+    using SurfaceSlotMap = WeakPtrHashMap<mir::scene::Surface, SlotHandle>;
+    using SessionInfoMap = WeakPtrHashMap<mir::scene::Session, ApplicationInfo>;
 
     mir::shell::FocusController* const focus_controller;
     std::shared_ptr<mir::shell::DisplayLayout> const display_layout;
@@ -182,22 +219,80 @@ private:
     // Workspaces may die without any sync with the BWM mutex
     struct DeadWorkspaces
     {
+        // Set when workspaces is non-empty, so that taking the BWM lock only needs
+        // to take dead_workspaces_mutex when there is something to purge
+        std::atomic<bool> purge_needed{false};
         std::mutex mutable dead_workspaces_mutex;
-        std::vector<std::weak_ptr<Workspace>> workspaces;
+        std::vector<std::pair<std::weak_ptr<Workspace>, unsigned>> workspaces;
+
+        // Workspaces are also created without the BWM mutex, so their ids are allocated
+        // here (an id is only reused after the workspace is purged from the BWM)
+        std::vector<unsigned> free_ids;
+        unsigned next_id{0};
     };
 
     std::shared_ptr<DeadWorkspaces> const dead_workspaces{std::make_shared<DeadWorkspaces>()};
 
     std::unique_ptr<WindowManagementPolicy> const policy;
     WorkspacePolicy* const workspace_policy;
+    WindowChangePolicy* const window_change_policy;
 
-    std::mutex mutex;
+    // Writers (input, surface lifecycle, invoke_under_lock) take this exclusively;
+    // invoke_under_shared_lock() readers share it.
+    std::shared_timed_mutex mutex;
     SessionInfoMap app_info;
-    SurfaceInfoMap window_info;
+    // Windows carry a handle to their info, surfaces are mapped to the same handle
+    WindowInfoSlots window_info;
+    SurfaceSlotMap surface_slots;
     mir::geometry::Rectangles displays;
+    unsigned display_generation{0};     // Incremented when displays change
     mir::geometry::Point cursor;
+
+    // active_display() is needed for every placement, so its result is kept until
+    // focus changes, the focused window moves or resizes, the displays change or the
+    // pointer moves in a way that would change it. Readers holding a shared lock call
+    // active_display() concurrently, so the cache (and the last focused display) have
+    // a mutex of their own.
+    struct ActiveDisplayCache
+    {
+        // The step of active_display() that chose the display
+        enum class Step { none, focused_window, last_focused_window, cursor, fallback };
+
+        Step step{Step::none};
+        unsigned display_generation{0};
+        std::weak_ptr<mir::scene::Surface> focused;
+        Rectangle focused_bounds;
+        Rectangle display;
+    };
+
+    std::mutex active_display_mutex;
+    ActiveDisplayCache active_display_cache;
+    bool has_last_focused_display{false};
+    Rectangle last_focused_display;
+
+    // While modify_windows() is in progress, changes to the active window and the
+    // advise_window_changed() notifications wait until the end
+    bool modifying_windows{false};
+    Window hidden_active_window;
+    Window shown_window_to_activate;
+    std::vector<std::pair<Window, WindowChanges>> pending_window_changes;
+    std::map<Window, std::size_t> pending_window_change_index;
+
+    // Merged pointer motion waiting for the holder of mutex to deliver it
+    bool coalesce_motion{false};
+    std::mutex pending_motion_mutex;
+    PointerMotionCoalescer motion_coalescer;
+    std::atomic<bool> last_motion_consumed{false};
+    std::atomic<uint64_t> motion_received{0};
+    std::atomic<uint64_t> motion_merged{0};
+    std::atomic<uint64_t> motion_coalesced{0};
     uint64_t last_input_event_timestamp{0};
+    std::shared_ptr<PolicyLatency> policy_latency;
+    std::shared_ptr<LockTiming> lock_timing;
     miral::MRUWindowList mru_active_windows;
+    // Window geometry and stacking (kept up to date by Window::move_to() and resize())
+    SpatialIndex spatial_index;
+    WindowTreeScratch tree_scratch;
     using FullscreenSurfaces = std::set<Window>;
     FullscreenSurfaces fullscreen_surfaces;
 
@@ -206,9 +301,15 @@ private:
         boost::bimaps::multiset_of<std::weak_ptr<Workspace>, std::owner_less<std::weak_ptr<Workspace>>>,
         boost::bimaps::multiset_of<Window>>;
 
-    wwbimap_t workspaces_to_windows;
+    wwbimap_t workspaces_to_windows;    // Also indexed by the WorkspaceSet of each Window
 
     struct Locker;
+    struct SharedLocker;
+
+    void purge_dead_workspaces();
+    auto deliver_pointer_event(MirPointerEvent const* event) -> bool;
+    void deliver_merged_motion(MirEvent const* event);
+    void deliver_pending_motion();
 
     void update_event_timestamp(MirKeyboardEvent const* kev);
     void update_event_timestamp(MirPointerEvent const* pev);
@@ -217,9 +318,16 @@ private:
     auto can_activate_window_for_session(miral::Application const& session) -> bool;
     auto can_activate_window_for_session_in_workspace(
         miral::Application const& session,
-        std::vector<std::shared_ptr<Workspace>> const& workspaces) -> bool;
+        WorkspaceSet const& workspaces) -> bool;
 
     auto place_new_surface(ApplicationInfo const& app_info, WindowSpecification parameters) -> WindowSpecification;
+
+    template<typename Call>
+    auto timed(PolicyHook hook, Call const& call) -> decltype(call())
+    {
+        PolicyLatency::Timer const timer{policy_latency.get(), hook};
+        return call();
+    }
     auto place_relative(mir::geometry::Rectangle const& parent, miral::WindowSpecification const& parameters, Size size)
         -> mir::optional_value<Rectangle>;
 
@@ -228,11 +336,17 @@ private:
     void validate_modification_request(WindowSpecification const& modifications, WindowInfo const& window_info) const;
     void place_and_size(WindowInfo& root, Point const& new_pos, Size const& new_size);
     void set_state(miral::WindowInfo& window_info, MirWindowState value);
+    void hide_active_window(Window const& window);
+    auto changes_for(WindowInfo const& window_info, WindowSpecification const& modifications) const -> WindowChanges;
+    void end_modifying_windows();
     auto fullscreen_rect_for(WindowInfo const& window_info) const -> Rectangle;
+    auto display_containing_most_of(Rectangle const& rect) const -> Rectangle;
+    void focus_changing();
+    void focus_changed();
     void remove_window(Application const& application, miral::WindowInfo const& info);
-    void refocus(Application const& application, Window const& parent,
-                 std::vector<std::shared_ptr<Workspace>> const& workspaces_containing_window);
+    void refocus(Application const& application, Window const& parent, WorkspaceSet const& workspaces_containing_window);
     auto workspaces_containing(Window const& window) const -> std::vector<std::shared_ptr<Workspace>>;
+    static auto workspace_set_of(Window const& window) -> WorkspaceSet&;
 };
 }
 
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+using std::chrono::nanoseconds;
+
+namespace
+{
+auto const sub_bucket_bits = 4;
+
+auto most_significant_bit(std::uint64_t value) -> int
+{
+    return 63 - __builtin_clzll(value);
+}
+}
+
+// Values below sub_buckets have a bucket each. Above that each power of two range is
+// split into sub_buckets buckets (and the largest values share the last bucket).
+auto miral::LatencyHistogram::bucket_for(std::uint64_t nanoseconds) -> std::size_t
+{
+    if (nanoseconds < sub_buckets)
+        return nanoseconds;
+
+    auto const shift = most_significant_bit(nanoseconds) - sub_bucket_bits;
+    auto const bucket = (shift + 1)*sub_buckets + ((nanoseconds >> shift) & (sub_buckets - 1));
+
+    return bucket < bucket_count ? bucket : bucket_count - 1;
+}
+
+auto miral::LatencyHistogram::highest_value_in(std::size_t bucket) -> std::uint64_t
+{
+    if (bucket < sub_buckets)
+        return bucket;
+
+    auto const shift = bucket/sub_buckets - 1;
+    auto const sub_bucket = bucket % sub_buckets;
+
+    return ((sub_buckets + sub_bucket + 1) << shift) - 1;
+}
+
+void miral::LatencyHistogram::record(nanoseconds duration)
+{
+    auto const value = static_cast<std::uint64_t>(std::max(duration.count(), nanoseconds::rep{0}));
+
+    counts[bucket_for(value)].fetch_add(1, std::memory_order_relaxed);
+    call_count.fetch_add(1, std::memory_order_relaxed);
+    total_nanoseconds.fetch_add(value, std::memory_order_relaxed);
+
+    auto max = max_nanoseconds.load(std::memory_order_relaxed);
+    while (value > max && !max_nanoseconds.compare_exchange_weak(max, value, std::memory_order_relaxed))
+        ;
+}
+
+auto miral::LatencyHistogram::calls() const -> std::uint64_t
+{
+    return call_count.load(std::memory_order_relaxed);
+}
+
+auto miral::LatencyHistogram::total() const -> nanoseconds
+{
+    return nanoseconds(total_nanoseconds.load(std::memory_order_relaxed));
+}
+
+auto miral::LatencyHistogram::max() const -> nanoseconds
+{
+    return nanoseconds(max_nanoseconds.load(std::memory_order_relaxed));
+}
+
+auto miral::LatencyHistogram::percentile(double fraction) const -> nanoseconds
+{
+    // The buckets are read one at a time, so count the calls they hold
+    std::array<std::uint64_t, bucket_count> snapshot;
+    std::uint64_t calls = 0;
+
+    for (std::size_t bucket = 0; bucket != bucket_count; ++bucket)
+        calls += (snapshot[bucket] = counts[bucket].load(std::memory_order_relaxed));
+
+    if (!calls)
+        return nanoseconds{0};
+
+    auto const wanted = std::max<std::uint64_t>(1, std::ceil(fraction*calls));
+    std::uint64_t seen = 0;
+
+    for (std::size_t bucket = 0; bucket != bucket_count; ++bucket)
+    {
+        if ((seen += snapshot[bucket]) >= wanted)
+            return std::min(nanoseconds(highest_value_in(bucket)), max());
+    }
+
+    return max();
+}
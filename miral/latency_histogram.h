@@ -0,0 +1,58 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_LATENCY_HISTOGRAM_H
+#define MIRAL_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace miral
+{
+/// A histogram of durations with buckets of (roughly) equal relative width, in the
+/// style of an HDR histogram. Durations are accurate to 1/16 (about 6%) up to about
+/// 36 minutes (2^41ns). Recording takes no lock, so it may be read while being updated.
+class LatencyHistogram
+{
+public:
+    void record(std::chrono::nanoseconds duration);
+
+    auto calls() const -> std::uint64_t;
+    auto total() const -> std::chrono::nanoseconds;
+    auto max() const -> std::chrono::nanoseconds;
+
+    /// The duration that (at least) fraction of the calls took no longer than
+    auto percentile(double fraction) const -> std::chrono::nanoseconds;
+
+    static auto bucket_for(std::uint64_t nanoseconds) -> std::size_t;
+    static auto highest_value_in(std::size_t bucket) -> std::uint64_t;
+
+    static std::size_t const sub_buckets = 16;
+    static std::size_t const bucket_count = 38*sub_buckets;
+
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> counts{};
+    std::atomic<std::uint64_t> call_count{0};
+    std::atomic<std::uint64_t> total_nanoseconds{0};
+    std::atomic<std::uint64_t> max_nanoseconds{0};
+};
+}
+
+#endif //MIRAL_LATENCY_HISTOGRAM_H
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "lock_timing.h"
+
+auto miral::name_of(LockEntry entry) -> char const*
+{
+    switch (entry)
+    {
+    case LockEntry::add_session:                return "add_session";
+    case LockEntry::remove_session:             return "remove_session";
+    case LockEntry::add_surface:                return "add_surface";
+    case LockEntry::modify_surface:             return "modify_surface";
+    case LockEntry::remove_surface:             return "remove_surface";
+    case LockEntry::handle_window_ready:        return "handle_window_ready";
+    case LockEntry::add_display:                return "add_display";
+    case LockEntry::remove_display:             return "remove_display";
+    case LockEntry::handle_keyboard_event:      return "handle_keyboard_event";
+    case LockEntry::handle_touch_event:         return "handle_touch_event";
+    case LockEntry::handle_pointer_event:       return "handle_pointer_event";
+    case LockEntry::handle_raise_surface:       return "handle_raise_surface";
+    case LockEntry::set_surface_attribute:      return "set_surface_attribute";
+    case LockEntry::invoke_under_lock:          return "invoke_under_lock";
+    case LockEntry::invoke_under_shared_lock:   return "invoke_under_shared_lock";
+    case LockEntry::deliver_pending_motion:     return "deliver_pending_motion";
+    case LockEntry::entry_count:                break;
+    }
+
+    return "unknown";
+}
+
+auto miral::LockTiming::wait(LockEntry entry) -> LatencyHistogram&
+{
+    return histograms[static_cast<std::size_t>(entry)].wait;
+}
+
+auto miral::LockTiming::hold(LockEntry entry) -> LatencyHistogram&
+{
+    return histograms[static_cast<std::size_t>(entry)].hold;
+}
+
+auto miral::LockTiming::latencies() const -> std::vector<LockLatency>
+{
+    std::vector<LockLatency> result;
+
+    for (std::size_t entry = 0; entry != histograms.size(); ++entry)
+    {
+        auto const& wait = histograms[entry].wait;
+        auto const& hold = histograms[entry].hold;
+
+        if (auto const acquisitions = wait.calls())
+        {
+            result.push_back(LockLatency{
+                name_of(static_cast<LockEntry>(entry)),
+                acquisitions,
+                wait.total(), wait.percentile(0.5), wait.percentile(0.99), wait.max(),
+                hold.total(), hold.percentile(0.5), hold.percentile(0.99), hold.max()});
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+#ifndef MIRAL_LOCK_TIMING_H
+#define MIRAL_LOCK_TIMING_H
+
+#include "latency_histogram.h"
+
+#include "miral/window_manager_tools.h"
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace miral
+{
+/// The BasicWindowManager entry points that take its lock
+enum class LockEntry
+{
+    add_session,
+    remove_session,
+    add_surface,
+    modify_surface,
+    remove_surface,
+    handle_window_ready,
+    add_display,
+    remove_display,
+    handle_keyboard_event,
+    handle_touch_event,
+    handle_pointer_event,
+    handle_raise_surface,
+    set_surface_attribute,
+    invoke_under_lock,
+    invoke_under_shared_lock,
+    deliver_pending_motion,
+    entry_count
+};
+
+auto name_of(LockEntry entry) -> char const*;
+
+/// Histograms of the time each entry point waits for, and then holds, the lock
+class LockTiming
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// \return the current time if there is a LockTiming (otherwise there's no need)
+    static auto now(LockTiming const* timing) -> Clock::time_point
+    {
+        return timing ? Clock::now() : Clock::time_point{};
+    }
+
+    auto wait(LockEntry entry) -> LatencyHistogram&;
+    auto hold(LockEntry entry) -> LatencyHistogram&;
+
+    /// The latencies of the entry points that have taken the lock
+    auto latencies() const -> std::vector<LockLatency>;
+
+private:
+    struct Histograms
+    {
+        LatencyHistogram wait;
+        LatencyHistogram hold;
+    };
+
+    std::array<Histograms, static_cast<std::size_t>(LockEntry::entry_count)> histograms;
+};
+}
+
+#endif //MIRAL_LOCK_TIMING_H
@@ -17,50 +17,136 @@
  */
 
 #include "mru_window_list.h"
+#include "window_self.h"
 
-#include <mir/client/detail/mir_forward_compatibility.h>
-#include <mir/scene/surface.h>
-
-#include <algorithm>
-
-namespace
+struct miral::MRUWindowList::Node
 {
-bool visible(miral::Window const& window)
+    Window window;
+    Node* prev = this;
+    Node* next = this;
+    bool visible = true;
+};
+
+miral::MRUWindowList::MRUWindowList() :
+    sentinel{new Node}
 {
-    std::shared_ptr<mir::scene::Surface> const& surface{window};
+}
 
-    switch (surface->state())
+miral::MRUWindowList::~MRUWindowList()
+{
+    for (auto node = sentinel->next; node != sentinel;)
     {
-    case mir_window_state_hidden:
-    case mir_window_state_minimized:
-        return false;
-    default:
-        return surface->visible();
+        auto const next = node->next;
+        node->window.self->mru_node = nullptr;
+        delete node;
+        node = next;
     }
+
+    delete sentinel;
 }
+
+void miral::MRUWindowList::unlink(Node* node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+}
+
+void miral::MRUWindowList::link_at_front(Node* node)
+{
+    node->prev = sentinel;
+    node->next = sentinel->next;
+    sentinel->next->prev = node;
+    sentinel->next = node;
 }
 
 void miral::MRUWindowList::push(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
-    windows.push_back(window);
+    if (!window)
+        return;
+
+    auto& node = window.self->mru_node;
+
+    if (node)
+        unlink(node);
+    else
+        node = new Node{window};
+
+    node->visible = true;
+    link_at_front(node);
 }
 
 void miral::MRUWindowList::erase(Window const& window)
 {
-    windows.erase(remove(begin(windows), end(windows), window), end(windows));
+    if (!window)
+        return;
+
+    if (auto const node = window.self->mru_node)
+    {
+        window.self->mru_node = nullptr;
+        unlink(node);
+        delete node;
+    }
+}
+
+void miral::MRUWindowList::set_visible(Window const& window, bool visible)
+{
+    if (!window)
+        return;
+
+    if (auto const node = window.self->mru_node)
+        node->visible = visible;
 }
 
 auto miral::MRUWindowList::top() const -> Window
 {
-    auto const& found = std::find_if(rbegin(windows), rend(windows), visible);
-    return (found != rend(windows)) ? *found: Window{};
+    auto const found = begin();
+    return (found != end()) ? *found : Window{};
 }
 
 void miral::MRUWindowList::enumerate(Enumerator const& enumerator) const
 {
-    for (auto i = windows.rbegin(); i != windows.rend(); ++i)
-        if (visible(*i))
-            if (!enumerator(const_cast<Window&>(*i)))
+    for (auto node = sentinel->next; node != sentinel;)
+    {
+        // Step on first, as the enumerator may move the current window to the front
+        auto const current = node;
+        node = node->next;
+
+        if (current->visible)
+            if (!enumerator(current->window))
                 break;
+    }
+}
+
+auto miral::MRUWindowList::begin() const -> const_iterator
+{
+    return {sentinel->next, sentinel};
+}
+
+auto miral::MRUWindowList::end() const -> const_iterator
+{
+    return {sentinel, sentinel};
+}
+
+miral::MRUWindowList::const_iterator::const_iterator(Node const* current, Node const* end) :
+    current{current}, end{end}
+{
+    skip_hidden();
+}
+
+auto miral::MRUWindowList::const_iterator::operator*() const -> Window const&
+{
+    return current->window;
+}
+
+auto miral::MRUWindowList::const_iterator::operator++() -> const_iterator&
+{
+    current = current->next;
+    skip_hidden();
+    return *this;
+}
+
+void miral::MRUWindowList::const_iterator::skip_hidden()
+{
+    while (current != end && !current->visible)
+        current = current->next;
 }
@@ -22,24 +22,83 @@
 #include <miral/window.h>
 
 #include <functional>
-#include <vector>
+#include <iterator>
 
 namespace miral
 {
+/// Windows in most recently used order.
+///
+/// The list is intrusive: each window records its own list node, so push() and erase()
+/// are O(1). (A window can only be in one MRUWindowList at a time.)
+///
+/// Hidden windows are kept in order but skipped by top(), enumerate() and iteration. The
+/// list doesn't query the scene for this: the owner reports changes with set_visible().
+/// BasicWindowManager clears the flag when a window is hidden or minimized, and only
+/// pushes windows whose surface is visible. The flag doesn't follow surface->visible()
+/// otherwise, so callers choosing a window to focus must still check WindowInfo::is_visible().
 class MRUWindowList
 {
 public:
+    struct Node;
 
+    MRUWindowList();
+    ~MRUWindowList();
+    MRUWindowList(MRUWindowList const&) = delete;
+    MRUWindowList& operator=(MRUWindowList const&) = delete;
+
+    /// Makes window the most recently used (and visible)
     void push(Window const& window);
     void erase(Window const& window);
     auto top() const -> Window;
 
+    /// Has no effect if window isn't in the list
+    void set_visible(Window const& window, bool visible);
+
     using Enumerator = std::function<bool(Window& window)>;
 
+    /// Enumerates visible windows, most recent first, until enumerator returns false.
+    /// \note the enumerator may push the window it is given, but should then return
+    /// false as the window will have been moved to the front
     void enumerate(Enumerator const& enumerator) const;
 
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Window;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Window const*;
+        using reference = Window const&;
+
+        auto operator*() const -> Window const&;
+        auto operator->() const -> Window const* { return &**this; }
+        auto operator++() -> const_iterator&;
+        auto operator++(int) -> const_iterator { auto const result = *this; ++*this; return result; }
+
+        friend bool operator==(const_iterator const& lhs, const_iterator const& rhs)
+            { return lhs.current == rhs.current; }
+        friend bool operator!=(const_iterator const& lhs, const_iterator const& rhs)
+            { return lhs.current != rhs.current; }
+
+    private:
+        friend class MRUWindowList;
+        const_iterator(Node const* current, Node const* end);
+
+        void skip_hidden();
+
+        Node const* current;
+        Node const* end;
+    };
+
+    /// Iterates over the visible windows, most recent first
+    auto begin() const -> const_iterator;
+    auto end() const -> const_iterator;
+
 private:
-    std::vector<Window> windows;
+    Node* const sentinel;
+
+    static void unlink(Node* node);
+    void link_at_front(Node* node);
 };
 }
 
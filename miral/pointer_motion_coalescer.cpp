@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "pointer_motion_coalescer.h"
+
+bool miral::PointerMotionCoalescer::can_merge(MirPointerEvent const* event) const
+{
+    if (mir_pointer_event_action(event) != mir_pointer_action_motion)
+        return false;
+
+    if (!has_pending())
+        return true;
+
+    auto const input_event = mir_pointer_event_input_event(event);
+
+    return mir_input_event_get_device_id(input_event) == device_id &&
+           mir_pointer_event_modifiers(event) == modifiers &&
+           mir_pointer_event_buttons(event) == buttons;
+}
+
+void miral::PointerMotionCoalescer::merge(MirPointerEvent const* event)
+{
+    auto const input_event = mir_pointer_event_input_event(event);
+
+    if (!has_pending())
+    {
+        device_id = mir_input_event_get_device_id(input_event);
+        modifiers = mir_pointer_event_modifiers(event);
+        buttons = mir_pointer_event_buttons(event);
+        hscroll = vscroll = relative_x = relative_y = 0;
+    }
+
+    event_time = mir_input_event_get_event_time(input_event);
+    x = mir_pointer_event_axis_value(event, mir_pointer_axis_x);
+    y = mir_pointer_event_axis_value(event, mir_pointer_axis_y);
+    hscroll += mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll);
+    vscroll += mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll);
+    relative_x += mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x);
+    relative_y += mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y);
+    ++merged_count;
+}
+
+auto miral::PointerMotionCoalescer::take_pending() -> mir::EventUPtr
+{
+    if (!has_pending())
+        return {nullptr, [](MirEvent*){}};
+
+    merged_count = 0;
+
+    // The merged event has no cookie: cookies authenticate button and key events, not motion
+    return mir::events::make_event(
+        device_id, std::chrono::nanoseconds{event_time}, std::vector<uint8_t>{}, modifiers,
+        mir_pointer_action_motion, buttons, x, y, hscroll, vscroll, relative_x, relative_y);
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_POINTER_MOTION_COALESCER_H
+#define MIRAL_POINTER_MOTION_COALESCER_H
+
+#include <mir/events/event_builders.h>
+#include <mir_toolkit/event.h>
+
+#include <cstdint>
+
+namespace miral
+{
+/// Accumulates consecutive pointer motion events into a single pending motion event
+/// carrying the latest position and the summed relative motion and scrolling.
+/// Only motion with the same device, buttons and modifiers is merged.
+///
+/// \note not synchronized: the BasicWindowManager guards it with pending_motion_mutex
+class PointerMotionCoalescer
+{
+public:
+    /// Whether event can be merged with the pending motion (if any)
+    bool can_merge(MirPointerEvent const* event) const;
+
+    /// \pre can_merge(event)
+    void merge(MirPointerEvent const* event);
+
+    bool has_pending() const { return merged_count != 0; }
+
+    /// The merged event (or a null pointer if nothing is pending)
+    auto take_pending() -> mir::EventUPtr;
+
+private:
+    MirInputDeviceId device_id{0};
+    std::int64_t event_time{0};
+    MirInputEventModifiers modifiers{0};
+    MirPointerButtons buttons{0};
+    float x{0};
+    float y{0};
+    float hscroll{0};
+    float vscroll{0};
+    float relative_x{0};
+    float relative_y{0};
+    unsigned merged_count{0};
+};
+}
+
+#endif //MIRAL_POINTER_MOTION_COALESCER_H
@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "policy_latency.h"
+
+auto miral::name_of(PolicyHook hook) -> char const*
+{
+    switch (hook)
+    {
+    case PolicyHook::place_new_window:              return "place_new_window";
+    case PolicyHook::handle_window_ready:           return "handle_window_ready";
+    case PolicyHook::handle_modify_window:          return "handle_modify_window";
+    case PolicyHook::handle_raise_window:           return "handle_raise_window";
+    case PolicyHook::handle_keyboard_event:         return "handle_keyboard_event";
+    case PolicyHook::handle_touch_event:            return "handle_touch_event";
+    case PolicyHook::handle_pointer_event:          return "handle_pointer_event";
+    case PolicyHook::confirm_inherited_move:        return "confirm_inherited_move";
+    case PolicyHook::advise_begin:                  return "advise_begin";
+    case PolicyHook::advise_end:                    return "advise_end";
+    case PolicyHook::advise_new_app:                return "advise_new_app";
+    case PolicyHook::advise_delete_app:             return "advise_delete_app";
+    case PolicyHook::advise_new_window:             return "advise_new_window";
+    case PolicyHook::advise_focus_lost:             return "advise_focus_lost";
+    case PolicyHook::advise_focus_gained:           return "advise_focus_gained";
+    case PolicyHook::advise_state_change:           return "advise_state_change";
+    case PolicyHook::advise_move_to:                return "advise_move_to";
+    case PolicyHook::advise_resize:                 return "advise_resize";
+    case PolicyHook::advise_delete_window:          return "advise_delete_window";
+    case PolicyHook::advise_raise:                  return "advise_raise";
+    case PolicyHook::advise_window_changed:         return "advise_window_changed";
+    case PolicyHook::advise_adding_to_workspace:    return "advise_adding_to_workspace";
+    case PolicyHook::advise_removing_from_workspace:return "advise_removing_from_workspace";
+    case PolicyHook::hook_count:                    break;
+    }
+
+    return "unknown";
+}
+
+miral::PolicyLatency::Timer::Timer(PolicyLatency* latency, PolicyHook hook) :
+    histogram{latency ? &latency->histogram(hook) : nullptr},
+    start{histogram ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}}
+{
+}
+
+miral::PolicyLatency::Timer::~Timer()
+{
+    if (histogram)
+        histogram->record(std::chrono::steady_clock::now() - start);
+}
+
+auto miral::PolicyLatency::histogram(PolicyHook hook) -> LatencyHistogram&
+{
+    return histograms[static_cast<std::size_t>(hook)];
+}
+
+auto miral::PolicyLatency::latencies() const -> std::vector<PolicyHookLatency>
+{
+    std::vector<PolicyHookLatency> result;
+
+    for (std::size_t hook = 0; hook != histograms.size(); ++hook)
+    {
+        auto const& histogram = histograms[hook];
+
+        if (auto const calls = histogram.calls())
+        {
+            result.push_back(PolicyHookLatency{
+                name_of(static_cast<PolicyHook>(hook)),
+                calls,
+                histogram.total(),
+                histogram.percentile(0.5),
+                histogram.percentile(0.9),
+                histogram.percentile(0.99),
+                histogram.percentile(0.999),
+                histogram.max()});
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_POLICY_LATENCY_H
+#define MIRAL_POLICY_LATENCY_H
+
+#include "latency_histogram.h"
+
+#include "miral/window_manager_tools.h"
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace miral
+{
+/// The WindowManagementPolicy (and WorkspacePolicy) hooks called by BasicWindowManager
+enum class PolicyHook
+{
+    place_new_window,
+    handle_window_ready,
+    handle_modify_window,
+    handle_raise_window,
+    handle_keyboard_event,
+    handle_touch_event,
+    handle_pointer_event,
+    confirm_inherited_move,
+    advise_begin,
+    advise_end,
+    advise_new_app,
+    advise_delete_app,
+    advise_new_window,
+    advise_focus_lost,
+    advise_focus_gained,
+    advise_state_change,
+    advise_move_to,
+    advise_resize,
+    advise_delete_window,
+    advise_raise,
+    advise_window_changed,
+    advise_adding_to_workspace,
+    advise_removing_from_workspace,
+    hook_count
+};
+
+auto name_of(PolicyHook hook) -> char const*;
+
+/// Latency histograms for each policy hook
+class PolicyLatency
+{
+public:
+    /// Times the scope it is in, if there is a PolicyLatency
+    class Timer
+    {
+    public:
+        Timer(PolicyLatency* latency, PolicyHook hook);
+        ~Timer();
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+
+    private:
+        LatencyHistogram* const histogram;
+        std::chrono::steady_clock::time_point const start;
+    };
+
+    auto histogram(PolicyHook hook) -> LatencyHistogram&;
+
+    /// The latencies of the hooks that have been called
+    auto latencies() const -> std::vector<PolicyHookLatency>;
+
+private:
+    std::array<LatencyHistogram, static_cast<std::size_t>(PolicyHook::hook_count)> histograms;
+};
+}
+
+#endif //MIRAL_POLICY_LATENCY_H
@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SLOT_MAP_H
+#define MIRAL_SLOT_MAP_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace miral
+{
+/// A handle to an element of a SlotMap. A handle is invalidated when the element is
+/// erased, and the generation count lets the map detect a stale handle even after
+/// the slot has been reused. A default constructed handle never refers to an element.
+struct SlotHandle
+{
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+};
+
+inline bool operator==(SlotHandle const& lhs, SlotHandle const& rhs)
+{
+    return lhs.index == rhs.index && lhs.generation == rhs.generation;
+}
+
+inline bool operator!=(SlotHandle const& lhs, SlotHandle const& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// Storage for elements that are accessed through generational handles.
+///
+/// Elements are stored in fixed size chunks (which are never reallocated) so that they
+/// are kept close together for linear scans while their addresses remain stable until
+/// they are erased. Erased slots are reused, most recently freed first.
+template<typename T, std::size_t chunk_size = 64>
+class SlotMap
+{
+public:
+    SlotMap() = default;
+    SlotMap(SlotMap const&) = delete;
+    SlotMap& operator=(SlotMap const&) = delete;
+
+    ~SlotMap()
+    {
+        for (std::uint32_t index = 0; index != slot_count; ++index)
+        {
+            auto& slot = slot_at(index);
+            if (slot.occupied)
+                slot.value().~T();
+        }
+    }
+
+    template<typename... Args>
+    auto emplace(Args&&... args) -> std::pair<SlotHandle, T&>
+    {
+        std::uint32_t index;
+
+        if (free_slots.empty())
+        {
+            if (slot_count == chunks.size()*chunk_size)
+                chunks.emplace_back(new Chunk);
+
+            index = slot_count;
+        }
+        else
+        {
+            index = free_slots.back();
+        }
+
+        auto& slot = slot_at(index);
+        new (&slot.storage) T(std::forward<Args>(args)...);
+
+        // Only update the bookkeeping once the element has been constructed
+        if (free_slots.empty())
+            ++slot_count;
+        else
+            free_slots.pop_back();
+
+        slot.occupied = true;
+        ++element_count;
+
+        return {SlotHandle{index, slot.generation}, slot.value()};
+    }
+
+    /// \return the element, or nullptr if the handle is stale
+    auto find(SlotHandle const& handle) const -> T*
+    {
+        if (handle.index >= slot_count)
+            return nullptr;
+
+        auto& slot = slot_at(handle.index);
+        if (!slot.occupied || slot.generation != handle.generation)
+            return nullptr;
+
+        return &slot.value();
+    }
+
+    /// \return true if the handle referred to an element
+    bool erase(SlotHandle const& handle)
+    {
+        if (!find(handle))
+            return false;
+
+        auto& slot = slot_at(handle.index);
+        slot.occupied = false;
+        slot.value().~T();
+
+        // Generation zero is never issued, so a default handle is never valid
+        if (++slot.generation == 0)
+            slot.generation = 1;
+
+        free_slots.push_back(handle.index);
+        --element_count;
+        return true;
+    }
+
+    auto size() const -> std::size_t { return element_count; }
+    bool empty() const { return element_count == 0; }
+
+    /// Invoke functor on each element in slot order
+    template<typename Functor>
+    void for_each(Functor const& functor) const
+    {
+        for (std::uint32_t index = 0; index != slot_count; ++index)
+        {
+            auto& slot = slot_at(index);
+            if (slot.occupied)
+                functor(slot.value());
+        }
+    }
+
+private:
+    struct Slot
+    {
+        std::uint32_t generation = 1;
+        bool occupied = false;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        auto value() -> T& { return *reinterpret_cast<T*>(&storage); }
+    };
+
+    using Chunk = std::array<Slot, chunk_size>;
+
+    auto slot_at(std::uint32_t index) const -> Slot&
+    {
+        return (*chunks[index/chunk_size])[index%chunk_size];
+    }
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<std::uint32_t> free_slots;
+    std::uint32_t slot_count = 0;
+    std::size_t element_count = 0;
+};
+}
+
+#endif //MIRAL_SLOT_MAP_H
@@ -0,0 +1,269 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "spatial_index.h"
+#include "window_self.h"
+
+#include <algorithm>
+
+using mir::geometry::Point;
+using mir::geometry::Rectangle;
+
+namespace
+{
+// Windows covering more cells than this are checked by every query instead
+auto const max_cells_per_entry = 64;
+
+auto floor_div(int value, int divisor) -> int
+{
+    return value >= 0 ? value/divisor : -((divisor - 1 - value)/divisor);
+}
+}
+
+struct miral::SpatialIndex::Entry
+{
+    SpatialIndex* const index;
+    Window const window;
+    Rectangle rect;
+    CellRange cells;
+    std::uint64_t stacking;
+    unsigned mark;
+};
+
+miral::SpatialIndex::SpatialIndex(int cell_size) :
+    cell_size{cell_size}
+{
+}
+
+miral::SpatialIndex::~SpatialIndex()
+{
+    std::vector<Entry*> all{begin(large_entries), end(large_entries)};
+
+    for (auto const& cell : cells)
+        all.insert(end(all), begin(cell.second), end(cell.second));
+
+    std::sort(begin(all), end(all));
+    all.erase(std::unique(begin(all), end(all)), end(all));
+
+    for (auto const entry : all)
+    {
+        entry->window.self->index_entry = nullptr;
+        delete entry;
+    }
+}
+
+auto miral::SpatialIndex::key(int x, int y) -> std::uint64_t
+{
+    return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+}
+
+auto miral::SpatialIndex::cells_for(Rectangle const& rect) const -> CellRange
+{
+    auto const width = std::max(rect.size.width.as_int(), 1);
+    auto const height = std::max(rect.size.height.as_int(), 1);
+    auto const x = rect.top_left.x.as_int();
+    auto const y = rect.top_left.y.as_int();
+
+    return {
+        floor_div(x, cell_size),
+        floor_div(y, cell_size),
+        floor_div(x + width - 1, cell_size),
+        floor_div(y + height - 1, cell_size)};
+}
+
+auto miral::SpatialIndex::is_large(CellRange const& range) -> bool
+{
+    auto const columns = std::int64_t{range.right} - range.left + 1;
+    auto const rows = std::int64_t{range.bottom} - range.top + 1;
+    return columns*rows > max_cells_per_entry;
+}
+
+void miral::SpatialIndex::add_to_cells(Entry* entry)
+{
+    entry->cells = cells_for(entry->rect);
+
+    if (is_large(entry->cells))
+    {
+        large_entries.push_back(entry);
+        return;
+    }
+
+    for (auto x = entry->cells.left; x <= entry->cells.right; ++x)
+        for (auto y = entry->cells.top; y <= entry->cells.bottom; ++y)
+            cells[key(x, y)].push_back(entry);
+}
+
+void miral::SpatialIndex::remove_from_cells(Entry* entry)
+{
+    auto const remove = [entry](Cell& cell)
+        {
+            auto const i = std::find(begin(cell), end(cell), entry);
+            if (i != end(cell))
+            {
+                *i = cell.back();
+                cell.pop_back();
+            }
+        };
+
+    if (is_large(entry->cells))
+    {
+        remove(large_entries);
+        return;
+    }
+
+    for (auto x = entry->cells.left; x <= entry->cells.right; ++x)
+        for (auto y = entry->cells.top; y <= entry->cells.bottom; ++y)
+        {
+            // Empty cells are kept, as windows tend to return to the same areas
+            auto const cell = cells.find(key(x, y));
+            if (cell != end(cells))
+                remove(cell->second);
+        }
+}
+
+void miral::SpatialIndex::insert(Window const& window)
+{
+    if (!window || window.self->index_entry)
+        return;
+
+    auto const entry = new Entry{this, window, Rectangle{window.top_left(), window.size()}, {}, next_stacking++, query_mark};
+    window.self->index_entry = entry;
+    add_to_cells(entry);
+    ++entries;
+}
+
+void miral::SpatialIndex::erase(Window const& window)
+{
+    if (!window)
+        return;
+
+    if (auto const entry = window.self->index_entry)
+    {
+        window.self->index_entry = nullptr;
+        remove_from_cells(entry);
+        delete entry;
+        --entries;
+    }
+}
+
+void miral::SpatialIndex::update(Window const& window)
+{
+    if (!window)
+        return;
+
+    if (auto const entry = window.self->index_entry)
+        entry->index->move(entry);
+}
+
+void miral::SpatialIndex::move(Entry* entry)
+{
+    Rectangle const rect{entry->window.top_left(), entry->window.size()};
+
+    if (rect == entry->rect)
+        return;
+
+    auto const old_cells = entry->cells;
+    auto const new_cells = cells_for(rect);
+    entry->rect = rect;
+
+    if (old_cells.left == new_cells.left && old_cells.top == new_cells.top &&
+        old_cells.right == new_cells.right && old_cells.bottom == new_cells.bottom)
+        return;
+
+    remove_from_cells(entry);
+    add_to_cells(entry);
+}
+
+void miral::SpatialIndex::raise(std::vector<Window>::const_iterator first, std::vector<Window>::const_iterator last)
+{
+    found.clear();
+
+    for (auto window = first; window != last; ++window)
+    {
+        if (*window)
+        {
+            if (auto const entry = window->self->index_entry)
+                found.push_back(entry);
+        }
+    }
+
+    std::sort(begin(found), end(found), [](Entry* lhs, Entry* rhs) { return lhs->stacking < rhs->stacking; });
+
+    for (auto const entry : found)
+        entry->stacking = next_stacking++;
+}
+
+template<typename Matches>
+void miral::SpatialIndex::query(CellRange const& range, Matches const& matches, std::vector<Window>& result) const
+{
+    result.clear();
+    found.clear();
+
+    // A window can be in several cells, so mark those seen by this query
+    if (++query_mark == 0)
+        ++query_mark;
+
+    auto const consider = [&](Entry* entry)
+        {
+            if (entry->mark != query_mark)
+            {
+                entry->mark = query_mark;
+                if (matches(entry->rect))
+                    found.push_back(entry);
+            }
+        };
+
+    for (auto const entry : large_entries)
+        consider(entry);
+
+    if (is_large(range))
+    {
+        // It is cheaper to look at the cells that exist than all those in range
+        for (auto const& cell : cells)
+            for (auto const entry : cell.second)
+                consider(entry);
+    }
+    else
+    {
+        for (auto x = range.left; x <= range.right; ++x)
+            for (auto y = range.top; y <= range.bottom; ++y)
+            {
+                auto const cell = cells.find(key(x, y));
+                if (cell != end(cells))
+                {
+                    for (auto const entry : cell->second)
+                        consider(entry);
+                }
+            }
+    }
+
+    std::sort(begin(found), end(found), [](Entry* lhs, Entry* rhs) { return lhs->stacking > rhs->stacking; });
+
+    for (auto const entry : found)
+        result.push_back(entry->window);
+}
+
+void miral::SpatialIndex::windows_intersecting(Rectangle const& rect, std::vector<Window>& result) const
+{
+    query(cells_for(rect), [&](Rectangle const& entry_rect) { return entry_rect.overlaps(rect); }, result);
+}
+
+void miral::SpatialIndex::windows_at(Point point, std::vector<Window>& result) const
+{
+    query(cells_for({point, {1, 1}}), [&](Rectangle const& entry_rect) { return entry_rect.contains(point); }, result);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_SPATIAL_INDEX_H
+#define MIRAL_SPATIAL_INDEX_H
+
+#include <miral/window.h>
+
+#include <mir/geometry/rectangle.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace miral
+{
+/// An index of window rectangles for hit testing and overlap queries.
+///
+/// Windows are binned into a uniform grid of square cells so that a query only examines
+/// the windows in the cells it touches. (Windows covering a lot of cells are kept in a
+/// separate list that every query examines.)
+///
+/// The index is intrusive: each window records its entry, so Window::move_to() and
+/// Window::resize() keep the index current however the window is moved. (A window can
+/// only be in one SpatialIndex at a time.)
+///
+/// The index also records the stacking order as the window manager arranges it: windows
+/// are added on top, and raise() moves windows to the top keeping their relative order.
+class SpatialIndex
+{
+public:
+    struct Entry;
+
+    explicit SpatialIndex(int cell_size = 256);
+    ~SpatialIndex();
+    SpatialIndex(SpatialIndex const&) = delete;
+    SpatialIndex& operator=(SpatialIndex const&) = delete;
+
+    /// Adds window on top of the stacking order
+    void insert(Window const& window);
+    void erase(Window const& window);
+
+    /// Has no effect if window isn't in an index
+    static void update(Window const& window);
+
+    /// Moves windows to the top of the stacking order, keeping their relative order
+    void raise(std::vector<Window>::const_iterator first, std::vector<Window>::const_iterator last);
+    void raise(std::vector<Window> const& windows) { raise(windows.begin(), windows.end()); }
+
+    /// Replaces the content of result with the windows intersecting rect, topmost first
+    void windows_intersecting(mir::geometry::Rectangle const& rect, std::vector<Window>& result) const;
+
+    /// Replaces the content of result with the windows containing point, topmost first
+    void windows_at(mir::geometry::Point point, std::vector<Window>& result) const;
+
+    auto size() const -> std::size_t { return entries; }
+
+private:
+    struct CellRange
+    {
+        int left, top, right, bottom;
+    };
+
+    using Cell = std::vector<Entry*>;
+
+    int const cell_size;
+    std::unordered_map<std::uint64_t, Cell> cells;
+    Cell large_entries;
+    std::size_t entries = 0;
+    std::uint64_t next_stacking = 0;
+
+    // Marks entries already found by the current query, and the entries found
+    unsigned mutable query_mark = 0;
+    std::vector<Entry*> mutable found;
+
+    auto cells_for(mir::geometry::Rectangle const& rect) const -> CellRange;
+    static auto is_large(CellRange const& range) -> bool;
+    static auto key(int x, int y) -> std::uint64_t;
+
+    void add_to_cells(Entry* entry);
+    void remove_from_cells(Entry* entry);
+    void move(Entry* entry);
+
+    template<typename Matches>
+    void query(CellRange const& range, Matches const& matches, std::vector<Window>& result) const;
+};
+}
+
+#endif //MIRAL_SPATIAL_INDEX_H
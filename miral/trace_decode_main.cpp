@@ -0,0 +1,57 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "trace_recorder.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+// Renders a file written by --window-management-flight-recorder as a text trace
+int main(int argc, char const* argv[])
+try
+{
+    if (argc > 2)
+    {
+        std::cerr << "usage: " << argv[0] << " [recording]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (argc == 2)
+    {
+        std::ifstream in{argv[1], std::ios::binary};
+        if (!in)
+        {
+            std::cerr << argv[0] << ": cannot open " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        miral::TraceRecorder::decode(in, std::cout);
+    }
+    else
+    {
+        miral::TraceRecorder::decode(std::cin, std::cout);
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << argv[0] << ": " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,569 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "trace_recorder.h"
+
+#include <miral/window_info.h>
+
+#include <mir/scene/session.h>
+#include <mir/scene/surface.h>
+#include <mir/event_printer.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+
+using mir::operator<<;
+
+namespace
+{
+char const magic[8] = {'M', 'I', 'R', 'A', 'L', 'W', 'M', '1'};
+
+std::atomic<std::uint64_t> next_recorder_id{1};
+
+// The ring used by this thread for the recorder most recently written by it
+struct ThreadRing
+{
+    std::uint64_t recorder_id = 0;
+    void* ring = nullptr;
+};
+
+thread_local ThreadRing thread_ring;
+
+auto now() -> std::uint64_t
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void copy_name(char (&to)[24], std::string const& from)
+{
+    auto const length = std::min(from.size(), sizeof to - 1);
+    std::memcpy(to, from.data(), length);
+    to[length] = '\0';
+}
+
+void set_window(miral::TraceRecord& record, miral::Window const& window)
+{
+    if (std::shared_ptr<mir::scene::Surface> const surface = window)
+    {
+        record.window = reinterpret_cast<std::uintptr_t>(surface.get());
+        copy_name(record.name, surface->name());
+    }
+}
+
+void set_window(miral::TraceRecord& record, miral::WindowInfo const& window_info)
+{
+    if (std::shared_ptr<mir::scene::Surface> const surface = window_info.window())
+        record.window = reinterpret_cast<std::uintptr_t>(surface.get());
+
+    copy_name(record.name, window_info.name());
+    record.type = window_info.type();
+    record.value = window_info.state();
+}
+
+void set_application(miral::TraceRecord& record, miral::Application const& application)
+{
+    if (application)
+        copy_name(record.name, application->name());
+}
+
+void set_geometry(miral::TraceRecord& record, int x, int y, int width, int height)
+{
+    record.x = x;
+    record.y = y;
+    record.width = width;
+    record.height = height;
+}
+
+auto name_in(miral::TraceRecord const& record) -> char const*
+{
+    return record.name[0] || record.window ? record.name : "(null)";
+}
+
+struct WindowInfoOf
+{
+    miral::TraceRecord const& record;
+};
+
+auto operator<<(std::ostream& out, WindowInfoOf const& info) -> std::ostream&
+{
+    return out << "{name=" << info.record.name
+               << ", type=" << MirWindowType(info.record.type)
+               << ", state=" << MirWindowState(info.record.value) << '}';
+}
+
+struct PointOf
+{
+    miral::TraceRecord const& record;
+};
+
+auto operator<<(std::ostream& out, PointOf const& point) -> std::ostream&
+{
+    return out << '(' << point.record.x << ", " << point.record.y << ')';
+}
+
+struct SizeOf
+{
+    miral::TraceRecord const& record;
+};
+
+auto operator<<(std::ostream& out, SizeOf const& size) -> std::ostream&
+{
+    return out << '(' << size.record.width << ", " << size.record.height << ')';
+}
+
+struct RectOf
+{
+    miral::TraceRecord const& record;
+};
+
+auto operator<<(std::ostream& out, RectOf const& rect) -> std::ostream&
+{
+    return out << '(' << PointOf{rect.record} << ", " << SizeOf{rect.record} << ')';
+}
+}
+
+struct miral::TraceRecorder::Ring
+{
+    // A record is held as words that can be copied while the owner overwrites them
+    static std::size_t const words_per_record = sizeof(TraceRecord)/sizeof(std::uint64_t);
+
+    Ring(std::size_t capacity, std::thread::id owner, std::uint8_t thread) :
+        words{new std::atomic<std::uint64_t>[capacity*words_per_record]()},
+        owner{owner},
+        thread{thread}
+    {
+    }
+
+    void store(std::size_t slot, TraceRecord const& record)
+    {
+        std::uint64_t buffer[words_per_record];
+        std::memcpy(buffer, &record, sizeof buffer);
+
+        auto const first = words.get() + slot*words_per_record;
+        for (auto i = 0u; i != words_per_record; ++i)
+            first[i].store(buffer[i], std::memory_order_relaxed);
+    }
+
+    auto load(std::size_t slot) const -> TraceRecord
+    {
+        std::uint64_t buffer[words_per_record];
+
+        auto const first = words.get() + slot*words_per_record;
+        for (auto i = 0u; i != words_per_record; ++i)
+            buffer[i] = first[i].load(std::memory_order_relaxed);
+
+        TraceRecord record;
+        std::memcpy(&record, buffer, sizeof record);
+        return record;
+    }
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> const words;
+    std::thread::id const owner;
+    std::uint8_t const thread;
+
+    // Only the owning thread writes, so it only needs to publish its progress
+    std::atomic<std::uint64_t> head{0};
+};
+
+static_assert(sizeof(miral::TraceRecord) % sizeof(std::uint64_t) == 0, "TraceRecord should be a whole number of words");
+
+miral::TraceRecorder::TraceRecorder(std::size_t records_per_thread) :
+    capacity{records_per_thread},
+    id{next_recorder_id++}
+{
+    if (capacity == 0)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("TraceRecorder needs space for records"));
+}
+
+miral::TraceRecorder::~TraceRecorder() = default;
+
+auto miral::TraceRecorder::ring_for_this_thread() -> Ring&
+{
+    if (thread_ring.recorder_id == id)
+        return *static_cast<Ring*>(thread_ring.ring);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    auto const this_thread = std::this_thread::get_id();
+    auto ring = std::find_if(begin(rings), end(rings),
+        [&](std::unique_ptr<Ring> const& ring) { return ring->owner == this_thread; });
+
+    if (ring == end(rings))
+        ring = rings.insert(end(rings), std::make_unique<Ring>(capacity, this_thread, std::uint8_t(rings.size())));
+
+    thread_ring.recorder_id = id;
+    thread_ring.ring = ring->get();
+    return **ring;
+}
+
+template<typename Fill>
+void miral::TraceRecorder::append(TraceCall call, Fill const& fill)
+{
+    auto& ring = ring_for_this_thread();
+    auto const head = ring.head.load(std::memory_order_relaxed);
+
+    TraceRecord record{};
+    record.timestamp = now();
+    record.call = static_cast<std::uint16_t>(call);
+    record.thread = ring.thread;
+    fill(record);
+
+    // A reader that copies any of these words will then see at least this head
+    std::atomic_thread_fence(std::memory_order_release);
+    ring.store(head % capacity, record);
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void miral::TraceRecorder::record(TraceCall call, std::uint32_t value)
+{
+    append(call, [&](TraceRecord& record) { record.value = value; });
+}
+
+void miral::TraceRecorder::record(TraceCall call, Window const& window, std::uint32_t value)
+{
+    append(call, [&](TraceRecord& record) { set_window(record, window); record.value = value; });
+}
+
+void miral::TraceRecorder::record(TraceCall call, WindowInfo const& window_info)
+{
+    append(call, [&](TraceRecord& record) { set_window(record, window_info); });
+}
+
+void miral::TraceRecorder::record(TraceCall call, WindowInfo const& window_info, MirWindowState state)
+{
+    append(call, [&](TraceRecord& record) { set_window(record, window_info); record.value = state; });
+}
+
+void miral::TraceRecorder::record(TraceCall call, Application const& application, std::uint32_t value)
+{
+    append(call, [&](TraceRecord& record) { set_application(record, application); record.value = value; });
+}
+
+void miral::TraceRecorder::record(TraceCall call, std::uint32_t value, int x, int y, int width, int height)
+{
+    append(call, [&](TraceRecord& record)
+        {
+            record.value = value;
+            set_geometry(record, x, y, width, height);
+        });
+}
+
+void miral::TraceRecorder::record(TraceCall call, Window const& window, int x, int y, int width, int height)
+{
+    append(call, [&](TraceRecord& record)
+        {
+            set_window(record, window);
+            set_geometry(record, x, y, width, height);
+        });
+}
+
+void miral::TraceRecorder::record(TraceCall call, WindowInfo const& window_info, int x, int y, int width, int height)
+{
+    append(call, [&](TraceRecord& record)
+        {
+            set_window(record, window_info);
+            set_geometry(record, x, y, width, height);
+        });
+}
+
+void miral::TraceRecorder::record(TraceCall call, Application const& application, int x, int y, int width, int height)
+{
+    append(call, [&](TraceRecord& record)
+        {
+            set_application(record, application);
+            set_geometry(record, x, y, width, height);
+        });
+}
+
+auto miral::TraceRecorder::snapshot() const -> std::vector<TraceRecord>
+{
+    std::vector<TraceRecord> result;
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    for (auto const& ring : rings)
+    {
+        // The owner doesn't wait for us, so anything it overwrote (or was overwriting) while
+        // being copied is discarded: the owner is writing record number `after` when we finish
+        auto const end = ring->head.load(std::memory_order_acquire);
+        auto const begin = end > capacity ? end - capacity : 0;
+        auto const first = result.size();
+
+        for (auto i = begin; i != end; ++i)
+            result.push_back(ring->load(i % capacity));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto const after = ring->head.load(std::memory_order_relaxed);
+        if (after >= begin + capacity)
+        {
+            auto const overwritten = std::min<std::uint64_t>(after - (begin + capacity) + 1, end - begin);
+            result.erase(result.begin() + first, result.begin() + first + overwritten);
+        }
+    }
+
+    std::stable_sort(begin(result), end(result),
+        [](TraceRecord const& lhs, TraceRecord const& rhs) { return lhs.timestamp < rhs.timestamp; });
+
+    return result;
+}
+
+void miral::TraceRecorder::write(std::ostream& out) const
+{
+    auto const records = snapshot();
+
+    std::uint64_t const count = records.size();
+    out.write(magic, sizeof magic);
+    out.write(reinterpret_cast<char const*>(&count), sizeof count);
+    out.write(reinterpret_cast<char const*>(records.data()), count*sizeof(TraceRecord));
+}
+
+void miral::TraceRecorder::decode(std::istream& in, std::ostream& out)
+{
+    char header[sizeof magic];
+    std::uint64_t count = 0;
+
+    if (!in.read(header, sizeof header) || !std::equal(header, header + sizeof header, magic) ||
+        !in.read(reinterpret_cast<char*>(&count), sizeof count))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Not a window management trace"));
+
+    TraceRecord record;
+
+    for (std::uint64_t i = 0; i != count && in.read(reinterpret_cast<char*>(&record), sizeof record); ++i)
+    {
+        char timestamp[32];
+        std::snprintf(timestamp, sizeof timestamp, "[%llu.%06llu] ",
+            static_cast<unsigned long long>(record.timestamp / 1000000000),
+            static_cast<unsigned long long>(record.timestamp % 1000000000 / 1000));
+
+        record.name[sizeof record.name - 1] = '\0';
+        out << timestamp << "miral::Window Management: ";
+        decode(record, out);
+        out << '\n';
+    }
+}
+
+void miral::TraceRecorder::decode(TraceRecord const& record, std::ostream& out)
+{
+    switch (static_cast<TraceCall>(record.call))
+    {
+    case TraceCall::count_applications:
+        out << "count_applications -> " << record.value;
+        break;
+
+    case TraceCall::for_each_application:       out << "for_each_application"; break;
+    case TraceCall::for_each_window:            out << "for_each_window"; break;
+    case TraceCall::focus_next_application:     out << "focus_next_application"; break;
+    case TraceCall::focus_next_within_application: out << "focus_next_within_application"; break;
+    case TraceCall::focus_prev_within_application: out << "focus_prev_within_application"; break;
+    case TraceCall::invoke_under_lock:          out << "invoke_under_lock"; break;
+    case TraceCall::invoke_under_shared_lock:   out << "invoke_under_shared_lock"; break;
+    case TraceCall::create_workspace:           out << "create_workspace"; break;
+    case TraceCall::move_workspace_content_to_workspace: out << "move_workspace_content_to_workspace"; break;
+    case TraceCall::for_each_window_in_workspace: out << "for_each_window_in_workspace"; break;
+
+    case TraceCall::find_application:
+        out << "find_application -> " << name_in(record);
+        break;
+
+    case TraceCall::info_for_session:
+    case TraceCall::info_for_surface:
+    case TraceCall::info_for_window:
+        out << "info_for -> " << record.name;
+        break;
+
+    case TraceCall::ask_client_to_close:
+        out << "ask_client_to_close -> " << name_in(record);
+        break;
+
+    case TraceCall::force_close:
+        out << "force_close -> " << name_in(record);
+        break;
+
+    case TraceCall::active_window:
+        out << "active_window -> " << name_in(record);
+        break;
+
+    case TraceCall::select_active_window:
+        out << "select_active_window -> " << name_in(record);
+        break;
+
+    case TraceCall::window_at:
+        out << "window_at cursor=" << PointOf{record} << " -> " << name_in(record);
+        break;
+
+    case TraceCall::windows_intersecting:
+        out << "windows_intersecting rect=" << RectOf{record} << " -> " << record.value << " windows";
+        break;
+
+    case TraceCall::active_display:
+        out << "active_display -> " << RectOf{record};
+        break;
+
+    case TraceCall::info_for_window_id:
+        out << "info_for_window_id -> " << WindowInfoOf{record};
+        break;
+
+    case TraceCall::id_for_window:
+        out << "id_for_window window=" << name_in(record);
+        break;
+
+    case TraceCall::place_and_size_for_state:
+        out << "place_and_size_for_state window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::drag_active_window:
+        out << "drag_active_window movement=" << PointOf{record};
+        break;
+
+    case TraceCall::drag_window:
+        out << "drag_window window=" << name_in(record) << " -> " << PointOf{record};
+        break;
+
+    case TraceCall::raise_tree:
+        out << "raise_tree root=" << name_in(record);
+        break;
+
+    case TraceCall::modify_window:
+        out << "modify_window window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::modify_windows:
+        out << "modify_windows modifications=" << record.value;
+        break;
+
+    case TraceCall::pointer_motion_counts:
+        out << "pointer_motion_counts -> received=" << record.value;
+        break;
+
+    case TraceCall::add_tree_to_workspace:
+        out << "add_tree_to_workspace window=" << name_in(record);
+        break;
+
+    case TraceCall::remove_tree_from_workspace:
+        out << "remove_tree_from_workspace window=" << name_in(record);
+        break;
+
+    case TraceCall::for_each_workspace_containing:
+        out << "for_each_workspace_containing window=" << name_in(record);
+        break;
+
+    case TraceCall::place_new_window:
+        out << "place_new_window app_info=" << name_in(record) << " -> " << RectOf{record};
+        break;
+
+    case TraceCall::handle_window_ready:
+        out << "handle_window_ready window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::handle_modify_window:
+        out << "handle_modify_window window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::handle_raise_window:
+        out << "handle_raise_window window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::handle_keyboard_event:
+        out << "handle_keyboard_event event={action=" << MirKeyboardAction(record.x)
+            << ", code=" << record.value << std::hex << ", modifiers=" << record.y << std::dec << '}';
+        break;
+
+    case TraceCall::handle_touch_event:
+        out << "handle_touch_event event={points=" << record.value << ", x=" << record.x << ", y=" << record.y << '}';
+        break;
+
+    case TraceCall::handle_pointer_event:
+        out << "handle_pointer_event event={action=" << MirPointerAction(record.value)
+            << ", x=" << record.x << ", y=" << record.y << '}';
+        break;
+
+    case TraceCall::confirm_inherited_move:
+        out << "confirm_inherited_move window_info=" << WindowInfoOf{record} << ", movement=" << PointOf{record};
+        break;
+
+    case TraceCall::advise_end:
+        out << "====";
+        break;
+
+    case TraceCall::advise_new_app:
+        out << "advise_new_app application=" << name_in(record);
+        break;
+
+    case TraceCall::advise_delete_app:
+        out << "advise_delete_app application=" << name_in(record);
+        break;
+
+    case TraceCall::advise_new_window:
+        out << "advise_new_window window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::advise_focus_lost:
+        out << "advise_focus_lost window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::advise_focus_gained:
+        out << "advise_focus_gained window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::advise_state_change:
+        // The record holds the new state, so only name the window
+        out << "advise_state_change window_info={name=" << record.name << "}, state=" << MirWindowState(record.value);
+        break;
+
+    case TraceCall::advise_move_to:
+        out << "advise_move_to window_info=" << WindowInfoOf{record} << ", top_left=" << PointOf{record};
+        break;
+
+    case TraceCall::advise_resize:
+        out << "advise_resize window_info=" << WindowInfoOf{record} << ", new_size=" << SizeOf{record};
+        break;
+
+    case TraceCall::advise_delete_window:
+        out << "advise_delete_window window_info=" << WindowInfoOf{record};
+        break;
+
+    case TraceCall::advise_raise:
+        out << "advise_raise windows=" << record.value;
+        break;
+
+    case TraceCall::advise_adding_to_workspace:
+        out << "advise_adding_to_workspace windows=" << record.value;
+        break;
+
+    case TraceCall::advise_removing_from_workspace:
+        out << "advise_removing_from_workspace windows=" << record.value;
+        break;
+
+    case TraceCall::advise_window_changed:
+        out << "advise_window_changed window=" << name_in(record) << " changes=0x" << std::hex << record.value << std::dec;
+        break;
+
+    default:
+        out << "unknown call " << record.call;
+    }
+}
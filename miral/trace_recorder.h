@@ -0,0 +1,170 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_TRACE_RECORDER_H
+#define MIRAL_TRACE_RECORDER_H
+
+#include <miral/application.h>
+#include <miral/window.h>
+
+#include <mir_toolkit/common.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace miral
+{
+struct WindowInfo;
+
+/// The calls traced by WindowManagementTrace
+enum class TraceCall : std::uint16_t
+{
+    count_applications,
+    for_each_application,
+    find_application,
+    info_for_session,
+    info_for_surface,
+    info_for_window,
+    for_each_window,
+    ask_client_to_close,
+    force_close,
+    active_window,
+    select_active_window,
+    window_at,
+    windows_intersecting,
+    active_display,
+    info_for_window_id,
+    id_for_window,
+    place_and_size_for_state,
+    drag_active_window,
+    drag_window,
+    focus_next_application,
+    focus_next_within_application,
+    focus_prev_within_application,
+    raise_tree,
+    modify_window,
+    modify_windows,
+    invoke_under_lock,
+    invoke_under_shared_lock,
+    pointer_motion_counts,
+    create_workspace,
+    add_tree_to_workspace,
+    remove_tree_from_workspace,
+    move_workspace_content_to_workspace,
+    for_each_workspace_containing,
+    for_each_window_in_workspace,
+    place_new_window,
+    handle_window_ready,
+    handle_modify_window,
+    handle_raise_window,
+    handle_keyboard_event,
+    handle_touch_event,
+    handle_pointer_event,
+    confirm_inherited_move,
+    advise_end,
+    advise_new_app,
+    advise_delete_app,
+    advise_new_window,
+    advise_focus_lost,
+    advise_focus_gained,
+    advise_state_change,
+    advise_move_to,
+    advise_resize,
+    advise_delete_window,
+    advise_raise,
+    advise_adding_to_workspace,
+    advise_removing_from_workspace,
+    advise_window_changed,
+};
+
+/// A fixed size trace record. Which fields are meaningful depends on the call.
+struct TraceRecord
+{
+    std::uint64_t timestamp;    ///< nanoseconds on the steady clock
+    std::uint64_t window;       ///< identifies the window (zero for none)
+    std::int32_t x;
+    std::int32_t y;
+    std::int32_t width;
+    std::int32_t height;
+    std::uint32_t value;        ///< window state, a count, key code, etc.
+    std::uint16_t call;         ///< a TraceCall
+    std::uint8_t thread;        ///< the recording thread (in order of first record)
+    std::uint8_t type;          ///< window type
+    char name[24];              ///< window or application name (may be truncated)
+};
+
+static_assert(sizeof(TraceRecord) == 64, "TraceRecord should be a fixed 64 bytes");
+
+/// A flight recorder for window management calls.
+///
+/// Each thread writes to its own ring buffer without locking, the oldest records being
+/// overwritten once it fills. write() takes a snapshot of all the rings (in timestamp
+/// order) that decode() renders in the same format as the text trace.
+class TraceRecorder
+{
+public:
+    explicit TraceRecorder(std::size_t records_per_thread = 4096);
+    ~TraceRecorder();
+    TraceRecorder(TraceRecorder const&) = delete;
+    TraceRecorder& operator=(TraceRecorder const&) = delete;
+
+    void record(TraceCall call, std::uint32_t value = 0);
+    void record(TraceCall call, Window const& window, std::uint32_t value = 0);
+    void record(TraceCall call, WindowInfo const& window_info);
+    void record(TraceCall call, WindowInfo const& window_info, MirWindowState state);
+    void record(TraceCall call, Application const& application, std::uint32_t value = 0);
+
+    /// These also record a position (or displacement) and size
+    void record(TraceCall call, std::uint32_t value, int x, int y, int width = 0, int height = 0);
+    void record(TraceCall call, Window const& window, int x, int y, int width = 0, int height = 0);
+    void record(TraceCall call, WindowInfo const& window_info, int x, int y, int width = 0, int height = 0);
+    void record(TraceCall call, Application const& application, int x, int y, int width = 0, int height = 0);
+
+    /// Write the records currently held in binary form
+    void write(std::ostream& out) const;
+
+    /// The records currently held, oldest first
+    auto snapshot() const -> std::vector<TraceRecord>;
+
+    /// Render binary records (as produced by write()) as text
+    static void decode(std::istream& in, std::ostream& out);
+
+    /// Render a record as text (without a trailing newline)
+    static void decode(TraceRecord const& record, std::ostream& out);
+
+private:
+    struct Ring;
+
+    std::size_t const capacity;
+    std::uint64_t const id;
+
+    std::mutex mutable mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+
+    auto ring_for_this_thread() -> Ring&;
+
+    template<typename Fill>
+    void append(TraceCall call, Fill const& fill);
+};
+}
+
+#endif //MIRAL_TRACE_RECORDER_H
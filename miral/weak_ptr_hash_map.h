@@ -0,0 +1,269 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WEAK_PTR_HASH_MAP_H
+#define MIRAL_WEAK_PTR_HASH_MAP_H
+
+#include <boost/throw_exception.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace miral
+{
+/// A map keyed on weak_ptr ownership (as std::owner_less does for std::map) that finds
+/// live keys in O(1) using an open-addressing table indexed by the address of the object.
+///
+/// \note Keys are found by the address they held when inserted, so aliasing pointers
+/// to the same object are not supported. A lookup with an expired weak_ptr can't use the
+/// address and falls back to a linear search for an owner-equivalent key.
+///
+/// Each value is allocated separately so that references to values remain valid until
+/// they are erased (the window management code holds on to WindowInfo& across calls that
+/// add windows). Iterators are invalidated by insertions and erasures.
+template<typename Key, typename Value>
+class WeakPtrHashMap
+{
+public:
+    using key_type = std::weak_ptr<Key>;
+    using mapped_type = Value;
+    using value_type = std::pair<key_type const, Value>;
+
+    template<typename Pair>
+    class basic_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Pair;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Pair*;
+        using reference = Pair&;
+
+        auto operator*() const -> Pair& { return *current->entry; }
+        auto operator->() const -> Pair* { return current->entry.get(); }
+        auto operator++() -> basic_iterator& { ++current; skip_empty(); return *this; }
+        auto operator++(int) -> basic_iterator { auto const result = *this; ++*this; return result; }
+
+        friend bool operator==(basic_iterator const& lhs, basic_iterator const& rhs)
+            { return lhs.current == rhs.current; }
+        friend bool operator!=(basic_iterator const& lhs, basic_iterator const& rhs)
+            { return lhs.current != rhs.current; }
+
+    private:
+        friend class WeakPtrHashMap;
+        using SlotIterator = typename std::vector<typename WeakPtrHashMap::Slot>::const_iterator;
+
+        basic_iterator(SlotIterator current, SlotIterator end) : current{current}, end{end} { skip_empty(); }
+
+        void skip_empty() { while (current != end && !current->entry) ++current; }
+
+        SlotIterator current;
+        SlotIterator end;
+    };
+
+    using iterator = basic_iterator<value_type>;
+    using const_iterator = basic_iterator<value_type const>;
+
+    auto begin() -> iterator { return {slots.begin(), slots.end()}; }
+    auto end() -> iterator { return {slots.end(), slots.end()}; }
+    auto begin() const -> const_iterator { return {slots.begin(), slots.end()}; }
+    auto end() const -> const_iterator { return {slots.end(), slots.end()}; }
+
+    auto size() const -> std::size_t { return count; }
+    bool empty() const { return count == 0; }
+
+    auto find(key_type const& key) -> iterator
+        { return {slots.begin() + index_of(key), slots.end()}; }
+
+    auto find(key_type const& key) const -> const_iterator
+        { return {slots.begin() + index_of(key), slots.end()}; }
+
+    auto at(key_type const& key) -> Value&
+    {
+        auto const index = index_of(key);
+        if (index == slots.size())
+            BOOST_THROW_EXCEPTION(std::out_of_range{"WeakPtrHashMap::at"});
+        return slots[index].entry->second;
+    }
+
+    auto at(key_type const& key) const -> Value const&
+    {
+        auto const index = index_of(key);
+        if (index == slots.size())
+            BOOST_THROW_EXCEPTION(std::out_of_range{"WeakPtrHashMap::at"});
+        return slots[index].entry->second;
+    }
+
+    auto operator[](std::shared_ptr<Key> const& key) -> Value&
+    {
+        return emplace(key).first->second;
+    }
+
+    /// Inserts a value constructed from args unless an owner-equivalent key is present
+    template<typename... Args>
+    auto emplace(key_type const& key, Args&&... args) -> std::pair<iterator, bool>
+    {
+        auto const index = index_of(key);
+        if (index != slots.size())
+            return {{slots.begin() + index, slots.end()}, false};
+
+        reserve_for(count + 1);
+
+        auto const address = key.lock().get();
+        auto const mask = slots.size() - 1;
+        auto i = hash(address) & mask;
+        while (slots[i].entry)
+            i = (i + 1) & mask;
+
+        slots[i].address = address;
+        slots[i].entry.reset(new value_type{
+            std::piecewise_construct,
+            std::forward_as_tuple(key),
+            std::forward_as_tuple(std::forward<Args>(args)...)});
+        ++count;
+
+        return {{slots.begin() + i, slots.end()}, true};
+    }
+
+    auto erase(key_type const& key) -> std::size_t
+    {
+        auto const index = index_of(key);
+        if (index == slots.size())
+            return 0;
+
+        erase_slot(index);
+        return 1;
+    }
+
+    void clear()
+    {
+        slots.clear();
+        count = 0;
+    }
+
+private:
+    struct Slot
+    {
+        Key const* address = nullptr;
+        std::unique_ptr<value_type> entry;
+    };
+
+    std::vector<Slot> slots;
+    std::size_t count = 0;
+
+    // Objects are aligned, so mix the high address bits down into those used for the index
+    static auto hash(Key const* address) -> std::size_t
+    {
+        auto h = reinterpret_cast<std::uintptr_t>(address);
+        h ^= h >> 4;
+        h ^= h >> 16;
+        h *= static_cast<std::uintptr_t>(0x9e3779b97f4a7c15ull);
+        h ^= h >> (sizeof(h)*4);
+        return h;
+    }
+
+    static bool same_owner(key_type const& lhs, key_type const& rhs)
+    {
+        return !lhs.owner_before(rhs) && !rhs.owner_before(lhs);
+    }
+
+    // Returns slots.size() if the key isn't present
+    auto index_of(key_type const& key) const -> std::size_t
+    {
+        if (slots.empty())
+            return slots.size();
+
+        if (auto const live = key.lock())
+        {
+            auto const address = live.get();
+            auto const mask = slots.size() - 1;
+
+            for (auto i = hash(address) & mask; slots[i].entry; i = (i + 1) & mask)
+            {
+                if (slots[i].address == address && same_owner(slots[i].entry->first, key))
+                    return i;
+            }
+
+            return slots.size();
+        }
+
+        for (std::size_t i = 0; i != slots.size(); ++i)
+        {
+            if (slots[i].entry && same_owner(slots[i].entry->first, key))
+                return i;
+        }
+
+        return slots.size();
+    }
+
+    void reserve_for(std::size_t required)
+    {
+        // Keep the load factor at or below one half so probe sequences stay short
+        if (2*required <= slots.size())
+            return;
+
+        auto new_size = slots.empty() ? std::size_t{8} : 2*slots.size();
+        while (2*required > new_size)
+            new_size *= 2;
+
+        std::vector<Slot> old_slots(new_size);
+        old_slots.swap(slots);
+
+        auto const mask = slots.size() - 1;
+        for (auto& slot : old_slots)
+        {
+            if (!slot.entry)
+                continue;
+
+            auto i = hash(slot.address) & mask;
+            while (slots[i].entry)
+                i = (i + 1) & mask;
+
+            slots[i] = std::move(slot);
+        }
+    }
+
+    // Backward shift deletion: close the gap so no tombstones are needed
+    void erase_slot(std::size_t gap)
+    {
+        auto const mask = slots.size() - 1;
+        slots[gap] = Slot{};
+        --count;
+
+        for (auto i = (gap + 1) & mask; slots[i].entry; i = (i + 1) & mask)
+        {
+            auto const home = hash(slots[i].address) & mask;
+
+            // Move the entry back unless its home lies cyclically in (gap, i]
+            bool const stays = gap <= i ? (gap < home && home <= i) : (gap < home || home <= i);
+            if (!stays)
+            {
+                slots[gap] = std::move(slots[i]);
+                gap = i;
+            }
+        }
+    }
+};
+}
+
+#endif //MIRAL_WEAK_PTR_HASH_MAP_H
@@ -16,19 +16,11 @@
  * Authored by: Alan Griffiths <alan@octopull.co.uk>
  */
 
-#include "miral/window.h"
+#include "window_self.h"
 
 #include <mir/scene/session.h>
 #include <mir/scene/surface.h>
 
-struct miral::Window::Self
-{
-    Self(std::shared_ptr<mir::scene::Session> const& session, std::shared_ptr<mir::scene::Surface> const& surface);
-
-    std::weak_ptr<mir::scene::Session> const session;
-    std::weak_ptr<mir::scene::Surface> const surface;
-};
-
 miral::Window::Self::Self(std::shared_ptr<mir::scene::Session> const& session, std::shared_ptr<mir::scene::Surface> const& surface) :
     session{session}, surface{surface} {}
 
@@ -64,14 +56,20 @@ void miral::Window::resize(mir::geometry::Size const& size)
 {
     if (!self) return;
     if (auto const surface = self->surface.lock())
+    {
         surface->resize(size);
+        SpatialIndex::update(*this);
+    }
 }
 
 void miral::Window::move_to(mir::geometry::Point top_left)
 {
     if (!self) return;
     if (auto const surface = self->surface.lock())
+    {
         surface->move_to(top_left);
+        SpatialIndex::update(*this);
+    }
 }
 
 auto miral::Window::top_left() const
@@ -20,13 +20,21 @@
 
 #include "basic_window_manager.h"
 #include "window_management_trace.h"
+#include "window_manager_recording.h"
 
 #include <mir/abnormal_exit.h>
+#include <mir/main_loop.h>
 #include <mir/server.h>
 #include <mir/options/option.h>
 #include <mir/shell/system_compositor_window_manager.h>
 #include <mir/version.h>
 
+#include <csignal>
+#include <fstream>
+
+#define MIR_LOG_COMPONENT "miral::Window Management"
+#include <mir/log.h>
+
 namespace msh = mir::shell;
 
 // Demonstrate introducing a window management strategy
@@ -35,6 +43,78 @@ namespace
 char const* const wm_option = "window-manager";
 char const* const wm_system_compositor = "system-compositor";
 char const* const trace_option = "window-management-trace";
+char const* const coalesce_option = "window-management-coalesce-motion";
+char const* const recorder_option = "window-management-flight-recorder";
+char const* const latency_option = "window-management-hook-latency";
+char const* const lock_latency_option = "window-management-lock-latency";
+char const* const record_option = "window-management-record";
+
+// The recorded calls are written to file on SIGUSR2 and when the server exits
+struct FlightRecording
+{
+    std::shared_ptr<miral::TraceRecorder> recorder;
+    std::string file;
+
+    ~FlightRecording()
+    {
+        if (recorder) write();
+    }
+
+    void write() const
+    {
+        std::ofstream out{file, std::ios::binary | std::ios::trunc};
+        recorder->write(out);
+    }
+};
+
+// The policy hook and lock latencies are logged when the server exits
+struct LatencyReport
+{
+    std::shared_ptr<miral::PolicyLatency> latency;
+    std::shared_ptr<miral::LockTiming> lock_timing;
+
+    ~LatencyReport()
+    {
+        if (latency) log_policy_latencies();
+        if (lock_timing) log_lock_latencies();
+    }
+
+    void log_policy_latencies() const
+    {
+        for (auto const& hook : latency->latencies())
+        {
+            mir::log_info("%s: calls=%llu, total=%lldus, median=%lldus, p90=%lldus, p99=%lldus, p99.9=%lldus, max=%lldus",
+                hook.hook.c_str(),
+                static_cast<unsigned long long>(hook.calls),
+                static_cast<long long>(hook.total.count()/1000),
+                static_cast<long long>(hook.median.count()/1000),
+                static_cast<long long>(hook.p90.count()/1000),
+                static_cast<long long>(hook.p99.count()/1000),
+                static_cast<long long>(hook.p999.count()/1000),
+                static_cast<long long>(hook.max.count()/1000));
+        }
+    }
+
+    void log_lock_latencies() const
+    {
+        for (auto const& entry : lock_timing->latencies())
+        {
+            mir::log_info("%s: acquisitions=%llu, "
+                "wait total=%lldus, median=%lldus, p99=%lldus, max=%lldus; "
+                "hold total=%lldus, median=%lldus, p99=%lldus, max=%lldus",
+                entry.entry_point.c_str(),
+                static_cast<unsigned long long>(entry.acquisitions),
+                static_cast<long long>(entry.wait_total.count()/1000),
+                static_cast<long long>(entry.wait_median.count()/1000),
+                static_cast<long long>(entry.wait_p99.count()/1000),
+                static_cast<long long>(entry.wait_max.count()/1000),
+                static_cast<long long>(entry.hold_total.count()/1000),
+                static_cast<long long>(entry.hold_median.count()/1000),
+                static_cast<long long>(entry.hold_p99.count()/1000),
+                static_cast<long long>(entry.hold_max.count()/1000));
+        }
+    }
+};
 }
 
 void miral::WindowManagerOptions::operator()(mir::Server& server) const
@@ -48,13 +128,42 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
 
     server.add_configuration_option(wm_option, description, policies.begin()->name);
     server.add_configuration_option(trace_option, "log trace message", mir::OptionType::null);
+    server.add_configuration_option(recorder_option,
+        "record window management calls in memory, writing them to this file on SIGUSR2 and exit "
+        "[decode with miral-trace-decode]", mir::OptionType::string);
+    server.add_configuration_option(latency_option,
+        "time the window management policy hooks, logging their latencies on exit", mir::OptionType::null);
+    server.add_configuration_option(lock_latency_option,
+        "time waiting for and holding the window manager lock, logging the latencies on exit", mir::OptionType::null);
+    server.add_configuration_option(record_option,
+        "record the calls on the window manager to this file [replay with miral-replay]", mir::OptionType::string);
+    server.add_configuration_option(coalesce_option,
+        "merge pointer motion that arrives while the window manager is busy", mir::OptionType::null);
+
+    auto const recording = std::make_shared<FlightRecording>();
+    auto const latency_report = std::make_shared<LatencyReport>();
+
+    server.add_init_callback([recording, &server]
+        {
+            if (server.get_options()->is_set(recorder_option))
+            {
+                server.the_main_loop()->register_signal_handler({SIGUSR2}, [recording](int)
+                    {
+                        if (recording->recorder) recording->write();
+                    });
+            }
+        });
 
-    server.override_the_window_manager_builder([this, &server](msh::FocusController* focus_controller)
+    server.override_the_window_manager_builder([this, &server, recording, latency_report](msh::FocusController* focus_controller)
         -> std::shared_ptr<msh::WindowManager>
         {
             auto const options = server.get_options();
             auto const selection = options->get<std::string>(wm_option);
 
+            // Both wrap the policy in a trace, one logging and the other recording
+            if (options->is_set(trace_option) && options->is_set(recorder_option))
+                throw mir::AbnormalExit(std::string{"--"} + trace_option + " and --" + recorder_option + " can't be combined");
+
             auto const display_layout = server.the_shell_display_layout();
 
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 24, 0)
@@ -66,17 +175,61 @@ void miral::WindowManagerOptions::operator()(mir::Server& server) const
             {
                 if (selection == option.name)
                 {
-                    if (server.get_options()->is_set(trace_option))
+                    std::shared_ptr<BasicWindowManager> window_manager;
+
+                    if (options->is_set(recorder_option))
+                    {
+                        recording->file = options->get<std::string>(recorder_option);
+                        recording->recorder = std::make_shared<TraceRecorder>();
+
+                        auto trace_builder = [&option, recording](WindowManagerTools const& tools)
+                            -> std::unique_ptr<miral::WindowManagementPolicy>
+                            {
+                                return std::make_unique<WindowManagementTrace>(tools, option.build, recording->recorder);
+                            };
+
+                        window_manager = std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, trace_builder);
+                    }
+                    else if (options->is_set(trace_option))
                     {
                         auto trace_builder = [&option](WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
                             {
                                 return std::make_unique<WindowManagementTrace>(tools, option.build);
                             };
 
-                        return std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, trace_builder);
+                        window_manager = std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, trace_builder);
+                    }
+                    else
+                    {
+                        window_manager = std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, option.build);
+                    }
+
+                    window_manager->coalesce_pointer_motion(options->is_set(coalesce_option));
+
+                    if (options->is_set(latency_option))
+                    {
+                        latency_report->latency = std::make_shared<PolicyLatency>();
+                        window_manager->time_policy_hooks(latency_report->latency);
+                    }
+
+                    if (options->is_set(lock_latency_option))
+                    {
+                        latency_report->lock_timing = std::make_shared<LockTiming>();
+                        window_manager->time_lock(latency_report->lock_timing);
+                    }
+
+                    if (options->is_set(record_option))
+                    {
+                        auto const file = options->get<std::string>(record_option);
+                        auto const out = std::make_shared<std::ofstream>(file, std::ios::binary | std::ios::trunc);
+
+                        if (!*out)
+                            throw mir::AbnormalExit("Cannot open window manager recording: " + file);
+
+                        return std::make_shared<WindowManagerRecorder>(window_manager, out);
                     }
 
-                    return std::make_shared<BasicWindowManager>(focus_controller, display_layout, persistent_surface_store, option.build);
+                    return window_manager;
                 }
             }
 
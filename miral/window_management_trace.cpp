@@ -48,6 +48,14 @@ namespace
 {
 std::string const null_ptr{"(null)"};
 
+// Input is only logged by the tools the policy calls while handling it. Afterwards
+// log_input must not change: readers holding a shared lock call it concurrently.
+struct ClearLogInput
+{
+    ~ClearLogInput() { log_input = []{}; }
+    std::function<void()>& log_input;
+};
+
 auto operator<< (std::ostream& out, miral::WindowSpecification::AspectRatio const& ratio) -> std::ostream&;
 
 struct BracedItemStream
@@ -328,13 +336,30 @@ auto dump_of(mir::geometry::Size const size) -> std::string
     out << size;
     return out.str();
 }
+
+auto bits_of(miral::WindowChanges const& changes) -> std::uint32_t
+{
+    std::uint32_t result = 0;
+
+    for (std::uint32_t bit = 1; bit; bit <<= 1)
+    {
+        if (changes.contains(miral::WindowChange(bit)))
+            result |= bit;
+    }
+
+    return result;
+}
 }
 
 miral::WindowManagementTrace::WindowManagementTrace(
     WindowManagerTools const& wrapped,
-    WindowManagementPolicyBuilder const& builder) :
+    WindowManagementPolicyBuilder const& builder,
+    std::shared_ptr<TraceRecorder> const& recorder) :
     wrapped{wrapped},
-    policy(builder(WindowManagerTools{this}))
+    policy(builder(WindowManagerTools{this})),
+    workspace_policy{dynamic_cast<WorkspacePolicy*>(policy.get())},
+    window_change_policy{dynamic_cast<WindowChangePolicy*>(policy.get())},
+    recorder{recorder}
 {
 }
 
@@ -342,7 +367,10 @@ auto miral::WindowManagementTrace::count_applications() const -> unsigned int
 try {
     log_input();
     auto const result = wrapped.count_applications();
-    mir::log_info("%s -> %d", __func__, result);
+    if (recorder)
+        recorder->record(TraceCall::count_applications, result);
+    else
+        mir::log_info("%s -> %d", __func__, result);
     trace_count++;
     return result;
 }
@@ -351,7 +379,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_application(std::function<void(miral::ApplicationInfo&)> const& functor)
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (recorder)
+        recorder->record(TraceCall::for_each_application);
+    else
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.for_each_application(functor);
 }
@@ -362,7 +393,10 @@ auto miral::WindowManagementTrace::find_application(std::function<bool(Applicati
 try {
     log_input();
     auto result = wrapped.find_application(predicate);
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    if (recorder)
+        recorder->record(TraceCall::find_application, result);
+    else
+        mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -372,7 +406,10 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Session> c
 try {
     log_input();
     auto& result = wrapped.info_for(session);
-    mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
+    if (recorder)
+        recorder->record(TraceCall::info_for_session, result.application());
+    else
+        mir::log_info("%s -> %s", __func__, result.application()->name().c_str());
     trace_count++;
     return result;
 }
@@ -382,7 +419,10 @@ auto miral::WindowManagementTrace::info_for(std::weak_ptr<mir::scene::Surface> c
 try {
     log_input();
     auto& result = wrapped.info_for(surface);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    if (recorder)
+        recorder->record(TraceCall::info_for_surface, result);
+    else
+        mir::log_info("%s -> %s", __func__, result.name().c_str());
     trace_count++;
     return result;
 }
@@ -392,16 +432,34 @@ auto miral::WindowManagementTrace::info_for(Window const& window) const -> Windo
 try {
     log_input();
     auto& result = wrapped.info_for(window);
-    mir::log_info("%s -> %s", __func__, result.name().c_str());
+    if (recorder)
+        recorder->record(TraceCall::info_for_window, result);
+    else
+        mir::log_info("%s -> %s", __func__, result.name().c_str());
     trace_count++;
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::for_each_window(std::function<void(miral::WindowInfo&)> const& functor)
+try {
+    log_input();
+    if (recorder)
+        recorder->record(TraceCall::for_each_window);
+    else
+        mir::log_info("%s", __func__);
+    trace_count++;
+    wrapped.for_each_window(functor);
+}
+MIRAL_TRACE_EXCEPTION
+
 void miral::WindowManagementTrace::ask_client_to_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    if (recorder)
+        recorder->record(TraceCall::ask_client_to_close, window);
+    else
+        mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
     trace_count++;
     wrapped.ask_client_to_close(window);
 }
@@ -410,7 +468,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::force_close(miral::Window const& window)
 try {
     log_input();
-    mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
+    if (recorder)
+        recorder->record(TraceCall::force_close, window);
+    else
+        mir::log_info("%s -> %s", __func__, dump_of(window).c_str());
     trace_count++;
     wrapped.force_close(window);
 }
@@ -420,7 +481,10 @@ auto miral::WindowManagementTrace::active_window() const -> Window
 try {
     log_input();
     auto result = wrapped.active_window();
-    mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
+    if (recorder)
+        recorder->record(TraceCall::active_window, result);
+    else
+        mir::log_info("%s -> %s", __func__, dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -430,7 +494,10 @@ auto miral::WindowManagementTrace::select_active_window(Window const& hint) -> W
 try {
     log_input();
     auto result = wrapped.select_active_window(hint);
-    mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
+    if (recorder)
+        recorder->record(TraceCall::select_active_window, result);
+    else
+        mir::log_info("%s hint=%s -> %s", __func__, dump_of(hint).c_str(), dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -440,9 +507,33 @@ auto miral::WindowManagementTrace::window_at(mir::geometry::Point cursor) const
 try {
     log_input();
     auto result = wrapped.window_at(cursor);
-    std::stringstream out;
-    out << cursor << " -> " << dump_of(result);
-    mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    if (recorder)
+        recorder->record(TraceCall::window_at, result, cursor.x.as_int(), cursor.y.as_int());
+    else
+    {
+        std::stringstream out;
+        out << cursor << " -> " << dump_of(result);
+        mir::log_info("%s cursor=%s", __func__, out.str().c_str());
+    }
+    trace_count++;
+    return result;
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::windows_intersecting(mir::geometry::Rectangle const& rect) const
+-> std::vector<Window>
+try {
+    log_input();
+    auto result = wrapped.windows_intersecting(rect);
+    if (recorder)
+        recorder->record(TraceCall::windows_intersecting, std::uint32_t(result.size()),
+            rect.top_left.x.as_int(), rect.top_left.y.as_int(), rect.size.width.as_int(), rect.size.height.as_int());
+    else
+    {
+        std::stringstream out;
+        out << rect << " -> " << dump_of(result);
+        mir::log_info("%s rect=%s", __func__, out.str().c_str());
+    }
     trace_count++;
     return result;
 }
@@ -452,9 +543,15 @@ auto miral::WindowManagementTrace::active_display() -> mir::geometry::Rectangle
 try {
     log_input();
     auto result = wrapped.active_display();
-    std::stringstream out;
-    out << result;
-    mir::log_info("%s -> ", __func__, out.str().c_str());
+    if (recorder)
+        recorder->record(TraceCall::active_display, 0u,
+            result.top_left.x.as_int(), result.top_left.y.as_int(), result.size.width.as_int(), result.size.height.as_int());
+    else
+    {
+        std::stringstream out;
+        out << result;
+        mir::log_info("%s -> ", __func__, out.str().c_str());
+    }
     trace_count++;
     return result;
 }
@@ -464,7 +561,10 @@ auto miral::WindowManagementTrace::info_for_window_id(std::string const& id) con
 try {
     log_input();
     auto& result = wrapped.info_for_window_id(id);
-    mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
+    if (recorder)
+        recorder->record(TraceCall::info_for_window_id, result);
+    else
+        mir::log_info("%s id=%s -> %s", __func__, id.c_str(), dump_of(result).c_str());
     trace_count++;
     return result;
 }
@@ -474,7 +574,10 @@ auto miral::WindowManagementTrace::id_for_window(Window const& window) const ->
 try {
     log_input();
     auto result = wrapped.id_for_window(window);
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
+    if (recorder)
+        recorder->record(TraceCall::id_for_window, window);
+    else
+        mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), result.c_str());
     trace_count++;
     return result;
 }
@@ -484,7 +587,10 @@ void miral::WindowManagementTrace::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 try {
     log_input();
-    mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::place_and_size_for_state, window_info);
+    else
+        mir::log_info("%s modifications=%s window_info=%s", __func__, dump_of(modifications).c_str(), dump_of(window_info).c_str());
     wrapped.place_and_size_for_state(modifications, window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -492,9 +598,14 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_active_window(mir::geometry::Displacement movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    if (recorder)
+        recorder->record(TraceCall::drag_active_window, 0u, movement.dx.as_int(), movement.dy.as_int());
+    else
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s movement=%s", __func__, out.str().c_str());
+    }
     trace_count++;
     wrapped.drag_active_window(movement);
 }
@@ -503,9 +614,14 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::drag_window(Window const& window, mir::geometry::Displacement& movement)
 try {
     log_input();
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    if (recorder)
+        recorder->record(TraceCall::drag_window, window, movement.dx.as_int(), movement.dy.as_int());
+    else
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s window=%s -> %s", __func__, dump_of(window).c_str(), out.str().c_str());
+    }
     trace_count++;
     wrapped.drag_window(window, movement);
 }
@@ -514,7 +630,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (recorder)
+        recorder->record(TraceCall::focus_next_application);
+    else
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_next_application();
 }
@@ -523,7 +642,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_next_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (recorder)
+        recorder->record(TraceCall::focus_next_within_application);
+    else
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_next_within_application();
 }
@@ -532,7 +654,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::focus_prev_within_application()
 try {
     log_input();
-    mir::log_info("%s", __func__);
+    if (recorder)
+        recorder->record(TraceCall::focus_prev_within_application);
+    else
+        mir::log_info("%s", __func__);
     trace_count++;
     wrapped.focus_prev_within_application();
 }
@@ -541,7 +666,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::raise_tree(miral::Window const& root)
 try {
     log_input();
-    mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
+    if (recorder)
+        recorder->record(TraceCall::raise_tree, root);
+    else
+        mir::log_info("%s root=%s", __func__, dump_of(root).c_str());
     trace_count++;
     wrapped.raise_tree(root);
 }
@@ -551,23 +679,96 @@ void miral::WindowManagementTrace::modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
     log_input();
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    if (recorder)
+        recorder->record(TraceCall::modify_window, window_info);
+    else
+    {
+        mir::log_info("%s window_info=%s, modifications=%s",
+                      __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    }
     trace_count++;
     wrapped.modify_window(window_info, modifications);
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::modify_windows(
+    std::vector<std::pair<Window, WindowSpecification>> const& modifications)
+try {
+    log_input();
+    if (recorder)
+        recorder->record(TraceCall::modify_windows, std::uint32_t(modifications.size()));
+    else
+    {
+        std::stringstream out;
+        out << '[';
+        for (auto const& modification : modifications)
+            out << "{window=" << dump_of(modification.first) << ", modifications=" << dump_of(modification.second) << '}';
+        out << ']';
+        mir::log_info("%s modifications=%s", __func__, out.str().c_str());
+    }
+    trace_count++;
+    wrapped.modify_windows(modifications);
+}
+MIRAL_TRACE_EXCEPTION
+
 void miral::WindowManagementTrace::invoke_under_lock(std::function<void()> const& callback)
 try {
-    mir::log_info("%s", __func__);
+    if (recorder)
+        recorder->record(TraceCall::invoke_under_lock);
+    else
+        mir::log_info("%s", __func__);
     wrapped.invoke_under_lock(callback);
 }
 MIRAL_TRACE_EXCEPTION
 
+void miral::WindowManagementTrace::invoke_under_shared_lock(std::function<void()> const& callback)
+try {
+    if (recorder)
+        recorder->record(TraceCall::invoke_under_shared_lock);
+    else
+        mir::log_info("%s", __func__);
+    wrapped.invoke_under_shared_lock(callback);
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::pointer_motion_counts() const -> PointerMotionCounts
+try {
+    auto const result = wrapped.pointer_motion_counts();
+    if (recorder)
+        recorder->record(TraceCall::pointer_motion_counts, std::uint32_t(result.received));
+    else
+    {
+        mir::log_info("%s -> received=%llu, merged=%llu, coalesced=%llu", __func__,
+            static_cast<unsigned long long>(result.received),
+            static_cast<unsigned long long>(result.merged),
+            static_cast<unsigned long long>(result.coalesced));
+    }
+    return result;
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::policy_latencies() const -> std::vector<PolicyHookLatency>
+try {
+    auto const result = wrapped.policy_latencies();
+    mir::log_info("%s -> %zu hooks", __func__, result.size());
+    return result;
+}
+MIRAL_TRACE_EXCEPTION
+
+auto miral::WindowManagementTrace::lock_latencies() const -> std::vector<LockLatency>
+try {
+    auto const result = wrapped.lock_latencies();
+    mir::log_info("%s -> %zu entry points", __func__, result.size());
+    return result;
+}
+MIRAL_TRACE_EXCEPTION
+
 auto miral::WindowManagementTrace::create_workspace() -> std::shared_ptr<Workspace>
 try {
-    mir::log_info("%s", __func__);
+    if (recorder)
+        recorder->record(TraceCall::create_workspace);
+    else
+        mir::log_info("%s", __func__);
     return wrapped.create_workspace();
 }
 MIRAL_TRACE_EXCEPTION
@@ -575,7 +776,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::add_tree_to_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    if (recorder)
+        recorder->record(TraceCall::add_tree_to_workspace, window);
+    else
+        mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
     wrapped.add_tree_to_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -583,7 +787,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::remove_tree_from_workspace(
     miral::Window const& window, std::shared_ptr<miral::Workspace> const& workspace)
 try {
-    mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
+    if (recorder)
+        recorder->record(TraceCall::remove_tree_from_workspace, window);
+    else
+        mir::log_info("%s window=%s, workspace =%p", __func__, dump_of(window).c_str(), workspace.get());
     wrapped.remove_tree_from_workspace(window, workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -591,7 +798,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::move_workspace_content_to_workspace(
     std::shared_ptr<Workspace> const& to_workspace, std::shared_ptr<Workspace> const& from_workspace)
 try {
-    mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, to_workspace.get(), from_workspace.get());
+    if (recorder)
+        recorder->record(TraceCall::move_workspace_content_to_workspace);
+    else
+        mir::log_info("%s to_workspace=%p, from_workspace=%p", __func__, to_workspace.get(), from_workspace.get());
     wrapped.move_workspace_content_to_workspace(to_workspace, from_workspace);
 }
 MIRAL_TRACE_EXCEPTION
@@ -599,7 +809,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_workspace_containing(
     miral::Window const& window, std::function<void(std::shared_ptr<miral::Workspace> const&)> const& callback)
 try {
-    mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
+    if (recorder)
+        recorder->record(TraceCall::for_each_workspace_containing, window);
+    else
+        mir::log_info("%s window=%s", __func__, dump_of(window).c_str());
     wrapped.for_each_workspace_containing(window, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -607,7 +820,10 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::for_each_window_in_workspace(
     std::shared_ptr<miral::Workspace> const& workspace, std::function<void(miral::Window const&)> const& callback)
 try {
-    mir::log_info("%s workspace =%p", __func__, workspace.get());
+    if (recorder)
+        recorder->record(TraceCall::for_each_window_in_workspace);
+    else
+        mir::log_info("%s workspace =%p", __func__, workspace.get());
     wrapped.for_each_window_in_workspace(workspace, callback);
 }
 MIRAL_TRACE_EXCEPTION
@@ -617,15 +833,28 @@ auto miral::WindowManagementTrace::place_new_window(
     WindowSpecification const& requested_specification) -> WindowSpecification
 try {
     auto const result = policy->place_new_window(app_info, requested_specification);
-    mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
-              __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    if (recorder)
+    {
+        auto const top_left = result.top_left().is_set() ? result.top_left().value() : Point{};
+        auto const size = result.size().is_set() ? result.size().value() : Size{};
+        recorder->record(TraceCall::place_new_window, app_info.application(),
+            top_left.x.as_int(), top_left.y.as_int(), size.width.as_int(), size.height.as_int());
+    }
+    else
+    {
+        mir::log_info("%s app_info=%s, requested_specification=%s -> %s",
+                  __func__, dump_of(app_info).c_str(), dump_of(requested_specification).c_str(), dump_of(result).c_str());
+    }
     return result;
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_window_ready(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::handle_window_ready, window_info);
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->handle_window_ready(window_info);
 }
 MIRAL_TRACE_EXCEPTION
@@ -633,51 +862,101 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::handle_modify_window(
     miral::WindowInfo& window_info, miral::WindowSpecification const& modifications)
 try {
-    mir::log_info("%s window_info=%s, modifications=%s",
-                  __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    if (recorder)
+        recorder->record(TraceCall::handle_modify_window, window_info);
+    else
+    {
+        mir::log_info("%s window_info=%s, modifications=%s",
+                      __func__, dump_of(window_info).c_str(), dump_of(modifications).c_str());
+    }
     policy->handle_modify_window(window_info, modifications);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::handle_raise_window(miral::WindowInfo& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::handle_raise_window, window_info);
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->handle_raise_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 bool miral::WindowManagementTrace::handle_keyboard_event(MirKeyboardEvent const* event)
 try {
-    log_input = [event, this]
-        {
-            mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
-            log_input = []{};
-        };
+    if (recorder)
+    {
+        log_input = [event, this]
+            {
+                recorder->record(TraceCall::handle_keyboard_event, mir_keyboard_event_key_code(event),
+                    mir_keyboard_event_action(event), mir_keyboard_event_modifiers(event));
+                log_input = []{};
+            };
+    }
+    else
+    {
+        log_input = [event, this]
+            {
+                mir::log_info("handle_keyboard_event event=%s", dump_of(event).c_str());
+                log_input = []{};
+            };
+    }
 
+    ClearLogInput const clear{log_input};
     return policy->handle_keyboard_event(event);
 }
 MIRAL_TRACE_EXCEPTION
 
 bool miral::WindowManagementTrace::handle_touch_event(MirTouchEvent const* event)
 try {
-    log_input = [event, this]
-        {
-            mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
-            log_input = []{};
-        };
+    if (recorder)
+    {
+        log_input = [event, this]
+            {
+                auto const count = mir_touch_event_point_count(event);
+                recorder->record(TraceCall::handle_touch_event, count,
+                    count ? int(mir_touch_event_axis_value(event, 0, mir_touch_axis_x)) : 0,
+                    count ? int(mir_touch_event_axis_value(event, 0, mir_touch_axis_y)) : 0);
+                log_input = []{};
+            };
+    }
+    else
+    {
+        log_input = [event, this]
+            {
+                mir::log_info("handle_touch_event event=%s", dump_of(event).c_str());
+                log_input = []{};
+            };
+    }
 
+    ClearLogInput const clear{log_input};
     return policy->handle_touch_event(event);
 }
 MIRAL_TRACE_EXCEPTION
 
 bool miral::WindowManagementTrace::handle_pointer_event(MirPointerEvent const* event)
 try {
-    log_input = [event, this]
-        {
-            mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
-            log_input = []{};
-        };
+    if (recorder)
+    {
+        log_input = [event, this]
+            {
+                recorder->record(TraceCall::handle_pointer_event, mir_pointer_event_action(event),
+                    int(mir_pointer_event_axis_value(event, mir_pointer_axis_x)),
+                    int(mir_pointer_event_axis_value(event, mir_pointer_axis_y)));
+                log_input = []{};
+            };
+    }
+    else
+    {
+        log_input = [event, this]
+            {
+                mir::log_info("handle_pointer_event event=%s", dump_of(event).c_str());
+                log_input = []{};
+            };
+    }
 
+    ClearLogInput const clear{log_input};
     return policy->handle_pointer_event(event);
 }
 MIRAL_TRACE_EXCEPTION
@@ -685,9 +964,14 @@ MIRAL_TRACE_EXCEPTION
 auto miral::WindowManagementTrace::confirm_inherited_move(WindowInfo const& window_info, Displacement movement)
 -> Rectangle
 try {
-    std::stringstream out;
-    out << movement;
-    mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    if (recorder)
+        recorder->record(TraceCall::confirm_inherited_move, window_info, movement.dx.as_int(), movement.dy.as_int());
+    else
+    {
+        std::stringstream out;
+        out << movement;
+        mir::log_info("%s window_info=%s, movement=%s", __func__, dump_of(window_info).c_str(), out.str().c_str());
+    }
 
     return policy->confirm_inherited_move(window_info, movement);
 }
@@ -704,77 +988,147 @@ MIRAL_TRACE_EXCEPTION
 void miral::WindowManagementTrace::advise_end()
 try {
     if (trace_count.load() > 0)
-        mir::log_info("====");
+    {
+        if (recorder)
+            recorder->record(TraceCall::advise_end);
+        else
+            mir::log_info("====");
+    }
     policy->advise_end();
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_app(miral::ApplicationInfo& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_new_app, application.application());
+    else
+        mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
     policy->advise_new_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_app(miral::ApplicationInfo const& application)
 try {
-    mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_delete_app, application.application());
+    else
+        mir::log_info("%s application=%s", __func__, dump_of(application).c_str());
     policy->advise_delete_app(application);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_new_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_new_window, window_info);
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_new_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_lost(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_focus_lost, window_info);
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_focus_lost(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_focus_gained(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_focus_gained, window_info);
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_focus_gained(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_state_change(miral::WindowInfo const& window_info, MirWindowState state)
 try {
-    mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_state_change, window_info, state);
+    else
+        mir::log_info("%s window_info=%s, state=%s", __func__, dump_of(window_info).c_str(), dump_of(state).c_str());
     policy->advise_state_change(window_info, state);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_move_to(miral::WindowInfo const& window_info, mir::geometry::Point top_left)
 try {
-    mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_move_to, window_info, top_left.x.as_int(), top_left.y.as_int());
+    else
+        mir::log_info("%s window_info=%s, top_left=%s", __func__, dump_of(window_info).c_str(), dump_of(top_left).c_str());
     policy->advise_move_to(window_info, top_left);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_resize(miral::WindowInfo const& window_info, mir::geometry::Size const& new_size)
 try {
-    mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_resize, window_info, 0, 0, new_size.width.as_int(), new_size.height.as_int());
+    else
+        mir::log_info("%s window_info=%s, new_size=%s", __func__, dump_of(window_info).c_str(), dump_of(new_size).c_str());
     policy->advise_resize(window_info, new_size);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_delete_window(miral::WindowInfo const& window_info)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_delete_window, window_info);
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(window_info).c_str());
     policy->advise_delete_window(window_info);
 }
 MIRAL_TRACE_EXCEPTION
 
 void miral::WindowManagementTrace::advise_raise(std::vector<miral::Window> const& windows)
 try {
-    mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
+    if (recorder)
+        recorder->record(TraceCall::advise_raise, std::uint32_t(windows.size()));
+    else
+        mir::log_info("%s window_info=%s", __func__, dump_of(windows).c_str());
     policy->advise_raise(windows);
 }
 MIRAL_TRACE_EXCEPTION
+
+void miral::WindowManagementTrace::advise_adding_to_workspace(
+    std::shared_ptr<Workspace> const& workspace, std::vector<Window> const& windows)
+try {
+    if (recorder)
+        recorder->record(TraceCall::advise_adding_to_workspace, std::uint32_t(windows.size()));
+    else
+        mir::log_info("%s workspace=%p, windows=%s", __func__, workspace.get(), dump_of(windows).c_str());
+    if (workspace_policy)
+        workspace_policy->advise_adding_to_workspace(workspace, windows);
+}
+MIRAL_TRACE_EXCEPTION
+
+void miral::WindowManagementTrace::advise_removing_from_workspace(
+    std::shared_ptr<Workspace> const& workspace, std::vector<Window> const& windows)
+try {
+    if (recorder)
+        recorder->record(TraceCall::advise_removing_from_workspace, std::uint32_t(windows.size()));
+    else
+        mir::log_info("%s workspace=%p, windows=%s", __func__, workspace.get(), dump_of(windows).c_str());
+    if (workspace_policy)
+        workspace_policy->advise_removing_from_workspace(workspace, windows);
+}
+MIRAL_TRACE_EXCEPTION
+
+void miral::WindowManagementTrace::advise_window_changed(WindowInfo const& window_info, WindowChanges const& changes)
+try {
+    if (recorder)
+        recorder->record(TraceCall::advise_window_changed, window_info.window(), bits_of(changes));
+    else
+        mir::log_info("%s window_info=%s, changes=%#x", __func__, dump_of(window_info).c_str(), bits_of(changes));
+    if (window_change_policy)
+        window_change_policy->advise_window_changed(window_info, changes);
+}
+MIRAL_TRACE_EXCEPTION
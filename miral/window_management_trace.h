@@ -19,20 +19,31 @@
 #ifndef MIRAL_WINDOW_MANAGEMENT_TRACE_H
 #define MIRAL_WINDOW_MANAGEMENT_TRACE_H
 
+#include "trace_recorder.h"
 #include "window_manager_tools_implementation.h"
 
+#include "miral/window_change_policy.h"
 #include "miral/window_manager_tools.h"
 #include "miral/window_management_options.h"
 #include "miral/window_management_policy.h"
+#include "miral/workspace_policy.h"
 
 #include <atomic>
 
 namespace miral
 {
-class WindowManagementTrace : public WindowManagementPolicy, WindowManagerToolsImplementation
+/// Traces the calls between a policy and the window manager. The trace implements the
+/// optional WorkspacePolicy and WindowChangePolicy interfaces, forwarding them to the
+/// policy if it implements them too.
+class WindowManagementTrace : public WindowManagementPolicy, public WorkspacePolicy, public WindowChangePolicy,
+    WindowManagerToolsImplementation
 {
 public:
-    WindowManagementTrace(WindowManagerTools const& wrapped, WindowManagementPolicyBuilder const& builder);
+    /// If a recorder is supplied calls are recorded to it, otherwise they are logged as text
+    WindowManagementTrace(
+        WindowManagerTools const& wrapped,
+        WindowManagementPolicyBuilder const& builder,
+        std::shared_ptr<TraceRecorder> const& recorder = {});
 
 private:
     virtual auto count_applications() const -> unsigned int override;
@@ -48,12 +59,15 @@ private:
 
     virtual auto info_for(Window const& window) const -> WindowInfo& override;
 
+    virtual void for_each_window(std::function<void(WindowInfo&)> const& functor) override;
+
     virtual void ask_client_to_close(Window const& window) override;
     virtual void force_close(Window const& window) override;
 
     virtual auto active_window() const -> Window override;
     virtual auto select_active_window(Window const& hint) -> Window override;
     virtual auto window_at(mir::geometry::Point cursor) const -> Window override;
+    virtual auto windows_intersecting(mir::geometry::Rectangle const& rect) const -> std::vector<Window> override;
     virtual auto active_display() -> mir::geometry::Rectangle const override;
     virtual auto info_for_window_id(std::string const& id) const -> WindowInfo& override;
     virtual auto id_for_window(Window const& window) const -> std::string override;
@@ -71,9 +85,19 @@ private:
     virtual void raise_tree(Window const& root) override;
 
     virtual void modify_window(WindowInfo& window_info, WindowSpecification const& modifications) override;
+    virtual void modify_windows(
+        std::vector<std::pair<Window, WindowSpecification>> const& modifications) override;
 
     virtual void invoke_under_lock(std::function<void()> const& callback) override;
 
+    virtual void invoke_under_shared_lock(std::function<void()> const& callback) override;
+
+    virtual auto pointer_motion_counts() const -> PointerMotionCounts override;
+
+    virtual auto policy_latencies() const -> std::vector<PolicyHookLatency> override;
+
+    virtual auto lock_latencies() const -> std::vector<LockLatency> override;
+
     virtual auto place_new_window(
         ApplicationInfo const& app_info,
         WindowSpecification const& requested_specification) -> WindowSpecification override;
@@ -133,9 +157,22 @@ public:
 
     virtual void advise_raise(std::vector<Window> const& windows) override;
 
+    void advise_adding_to_workspace(
+        std::shared_ptr<Workspace> const& workspace,
+        std::vector<Window> const& windows) override;
+
+    void advise_removing_from_workspace(
+        std::shared_ptr<Workspace> const& workspace,
+        std::vector<Window> const& windows) override;
+
+    void advise_window_changed(WindowInfo const& window_info, WindowChanges const& changes) override;
+
 private:
     WindowManagerTools wrapped;
     std::unique_ptr<miral::WindowManagementPolicy> const policy;
+    WorkspacePolicy* const workspace_policy;            ///< null if policy doesn't implement it
+    WindowChangePolicy* const window_change_policy;     ///< null if policy doesn't implement it
+    std::shared_ptr<TraceRecorder> const recorder;
     std::atomic<unsigned> mutable trace_count;
     std::function<void()> log_input;
 };
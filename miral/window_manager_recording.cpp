@@ -0,0 +1,855 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "window_manager_recording.h"
+
+#include <mir/events/event_builders.h>
+#include <mir/log.h>
+#include <mir/scene/session.h>
+#include <mir/scene/surface.h>
+#include <mir/scene/surface_creation_parameters.h>
+#include <mir/shell/surface_ready_observer.h>
+#include <mir/shell/surface_specification.h>
+
+#include <boost/throw_exception.hpp>
+
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace geom = mir::geometry;
+namespace ms = mir::scene;
+namespace msh = mir::shell;
+using std::uint64_t;
+using std::int64_t;
+
+// A recording is the magic number followed by a record per call. A record is the call,
+// the time since the previous record (in nanoseconds) and the arguments. Integers are
+// written as (zigzag encoded) base 128 varints, so most arguments take a byte or two.
+namespace
+{
+char const magic[8] = {'M', 'I', 'R', 'A', 'L', 'W', 'M', 'R'};
+
+enum class Call : std::uint8_t
+{
+    add_session,
+    remove_session,
+    add_surface,
+    modify_surface,
+    remove_surface,
+    add_display,
+    remove_display,
+    handle_keyboard_event,
+    handle_touch_event,
+    handle_pointer_event,
+    handle_raise_surface,
+    set_surface_attribute,
+    surface_ready,
+};
+
+// The surface attributes common to SurfaceCreationParameters and SurfaceSpecification
+template<typename Spec, typename Visit>
+void for_each_common_attribute(Spec& spec, Visit const& visit)
+{
+    visit(spec.type);
+    visit(spec.state);
+    visit(spec.preferred_orientation);
+    visit(spec.aux_rect);
+    visit(spec.edge_attachment);
+    visit(spec.placement_hints);
+    visit(spec.surface_placement_gravity);
+    visit(spec.aux_rect_placement_gravity);
+    visit(spec.aux_rect_placement_offset_x);
+    visit(spec.aux_rect_placement_offset_y);
+    visit(spec.min_width);
+    visit(spec.min_height);
+    visit(spec.max_width);
+    visit(spec.max_height);
+    visit(spec.width_inc);
+    visit(spec.height_inc);
+    visit(spec.min_aspect);
+    visit(spec.max_aspect);
+    visit(spec.input_shape);
+    visit(spec.shell_chrome);
+    visit(spec.confine_pointer);
+}
+
+auto zigzag(int64_t value) -> uint64_t
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+auto unzigzag(uint64_t value) -> int64_t
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+}
+
+class miral::WindowManagerRecorder::Record
+{
+public:
+    explicit Record(Call call) : call{call} {}
+
+    Call const call;
+    std::string bytes;
+
+    void put_uint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            bytes.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<char>(value));
+    }
+
+    void put_int(int64_t value) { put_uint(zigzag(value)); }
+
+    void put_float(float value)
+    {
+        char raw[sizeof value];
+        std::memcpy(raw, &value, sizeof value);
+        bytes.append(raw, sizeof raw);
+    }
+
+    void put(std::string const& value)
+    {
+        put_uint(value.size());
+        bytes.append(value);
+    }
+
+    template<typename Enum, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+    void put(Enum value) { put_int(value); }
+
+    void put(int value) { put_int(value); }
+    void put(geom::Width value) { put_int(value.as_int()); }
+    void put(geom::Height value) { put_int(value.as_int()); }
+    void put(geom::DeltaX value) { put_int(value.as_int()); }
+    void put(geom::DeltaY value) { put_int(value.as_int()); }
+    void put(geom::Point const& value) { put_int(value.x.as_int()); put_int(value.y.as_int()); }
+    void put(geom::Size const& value) { put(value.width); put(value.height); }
+    void put(geom::Rectangle const& value) { put(value.top_left); put(value.size); }
+    void put(msh::SurfaceAspectRatio const& value) { put_uint(value.width); put_uint(value.height); }
+
+    void put(std::vector<geom::Rectangle> const& value)
+    {
+        put_uint(value.size());
+        for (auto const& rect : value)
+            put(rect);
+    }
+
+    // A mask of the attributes that are set followed by their values
+    template<typename Spec>
+    void put_common_attributes(Spec const& spec)
+    {
+        uint64_t mask = 0;
+        uint64_t bit = 1;
+        for_each_common_attribute(spec, [&](auto const& attribute)
+            { if (attribute.is_set()) mask |= bit; bit <<= 1; });
+
+        put_uint(mask);
+        for_each_common_attribute(spec, [&](auto const& attribute)
+            { if (attribute.is_set()) put(attribute.value()); });
+    }
+};
+
+class miral::WindowManagerReplay::Reader
+{
+public:
+    explicit Reader(std::istream& in) : in{in} {}
+
+    bool at_end() { return in.peek() == std::istream::traits_type::eof(); }
+
+    auto get_byte() -> std::uint8_t
+    {
+        auto const byte = in.get();
+        if (byte == std::istream::traits_type::eof())
+            BOOST_THROW_EXCEPTION(std::runtime_error("Truncated window manager recording"));
+        return static_cast<std::uint8_t>(byte);
+    }
+
+    auto get_uint() -> uint64_t
+    {
+        uint64_t value = 0;
+        for (auto shift = 0; ; shift += 7)
+        {
+            auto const byte = get_byte();
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80) || shift > 56)
+                return value;
+        }
+    }
+
+    auto get_int() -> int64_t { return unzigzag(get_uint()); }
+
+    auto get_float() -> float
+    {
+        char raw[sizeof(float)];
+        for (auto& c : raw)
+            c = static_cast<char>(get_byte());
+
+        float value;
+        std::memcpy(&value, raw, sizeof value);
+        return value;
+    }
+
+    void get(std::string& value)
+    {
+        value.resize(get_uint());
+        if (!in.read(&value[0], value.size()))
+            BOOST_THROW_EXCEPTION(std::runtime_error("Truncated window manager recording"));
+    }
+
+    template<typename Enum, typename = typename std::enable_if<std::is_enum<Enum>::value>::type>
+    void get(Enum& value) { value = static_cast<Enum>(get_int()); }
+
+    void get(int& value) { value = static_cast<int>(get_int()); }
+    void get(geom::Width& value) { value = geom::Width{get_int()}; }
+    void get(geom::Height& value) { value = geom::Height{get_int()}; }
+    void get(geom::DeltaX& value) { value = geom::DeltaX{get_int()}; }
+    void get(geom::DeltaY& value) { value = geom::DeltaY{get_int()}; }
+    void get(geom::Point& value) { value.x = geom::X{get_int()}; value.y = geom::Y{get_int()}; }
+    void get(geom::Size& value) { get(value.width); get(value.height); }
+    void get(geom::Rectangle& value) { get(value.top_left); get(value.size); }
+
+    void get(msh::SurfaceAspectRatio& value)
+    {
+        value.width = static_cast<unsigned>(get_uint());
+        value.height = static_cast<unsigned>(get_uint());
+    }
+
+    void get(std::vector<geom::Rectangle>& value)
+    {
+        value.resize(get_uint());
+        for (auto& rect : value)
+            get(rect);
+    }
+
+    template<typename Spec>
+    void get_common_attributes(Spec& spec)
+    {
+        auto const mask = get_uint();
+        uint64_t bit = 1;
+        for_each_common_attribute(spec, [&](auto& attribute)
+            {
+                if (mask & bit)
+                {
+                    typename std::decay<decltype(attribute.value())>::type value;
+                    get(value);
+                    attribute = value;
+                }
+                bit <<= 1;
+            });
+    }
+
+private:
+    std::istream& in;
+};
+
+miral::WindowManagerRecorder::WindowManagerRecorder(
+    std::shared_ptr<msh::WindowManager> const& next,
+    std::shared_ptr<std::ostream> const& out) :
+    next{next},
+    out{out},
+    last_record{std::chrono::steady_clock::now()}
+{
+    if (!out->write(magic, sizeof magic))
+        BOOST_THROW_EXCEPTION(std::runtime_error("Cannot write window manager recording"));
+}
+
+miral::WindowManagerRecorder::~WindowManagerRecorder()
+{
+    flush();
+}
+
+void miral::WindowManagerRecorder::flush()
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    if (recording && !out->flush())
+        stop_recording();
+}
+
+auto miral::WindowManagerRecorder::is_recording() const -> bool
+{
+    return recording;
+}
+
+// Called with the mutex locked
+void miral::WindowManagerRecorder::write(Record const& record)
+{
+    if (!recording)
+        return;
+
+    auto const now = std::chrono::steady_clock::now();
+
+    Record header{record.call};
+    header.bytes.push_back(static_cast<char>(record.call));
+    header.put_uint(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_record).count());
+    last_record = now;
+
+    if (!out->write(header.bytes.data(), header.bytes.size()) ||
+        !out->write(record.bytes.data(), record.bytes.size()))
+        stop_recording();
+}
+
+// Called with the mutex locked
+void miral::WindowManagerRecorder::stop_recording()
+{
+    recording = false;
+    mir::log_error("Window manager recording stopped: failed to write the recording");
+}
+
+// Called with the mutex locked
+auto miral::WindowManagerRecorder::id_for(std::shared_ptr<ms::Session> const& session) const -> uint64_t
+{
+    auto const i = session_ids.find(session.get());
+    return i != session_ids.end() ? i->second : 0;
+}
+
+// Called with the mutex locked
+auto miral::WindowManagerRecorder::id_for(std::shared_ptr<ms::Surface> const& surface) const -> uint64_t
+{
+    auto const i = surface_ids.find(surface.get());
+    return i != surface_ids.end() ? i->second : 0;
+}
+
+void miral::WindowManagerRecorder::add_session(std::shared_ptr<ms::Session> const& session)
+{
+    if (!recording)
+        return next->add_session(session);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto const id = session_ids[session.get()] = next_id++;
+
+    Record record{Call::add_session};
+    record.put_uint(id);
+    record.put(session->name());
+    write(record);
+
+    next->add_session(session);
+}
+
+void miral::WindowManagerRecorder::remove_session(std::shared_ptr<ms::Session> const& session)
+{
+    if (!recording)
+        return next->remove_session(session);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::remove_session};
+    record.put_uint(id_for(session));
+    write(record);
+
+    next->remove_session(session);
+
+    session_ids.erase(session.get());
+}
+
+// The surface is only numbered once built, so the call is recorded from within build.
+// The parameters recorded are those requested, not those the window manager built with.
+// The surface becoming ready is recorded by an observer added before the window manager's.
+// (The two observers can't share a lock, so another call may come between them.)
+auto miral::WindowManagerRecorder::add_surface(
+    std::shared_ptr<ms::Session> const& session,
+    ms::SurfaceCreationParameters const& params,
+    std::function<mir::frontend::SurfaceId(std::shared_ptr<ms::Session> const& session, ms::SurfaceCreationParameters const& params)> const& build)
+-> mir::frontend::SurfaceId
+{
+    if (!recording)
+        return next->add_surface(session, params, build);
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // Called by next, on this thread, with the mutex locked
+    auto const record_and_build = [&](std::shared_ptr<ms::Session> const& session, ms::SurfaceCreationParameters const& placed)
+        {
+            auto const surface_id = build(session, placed);
+            auto const surface = session->surface(surface_id);
+
+            auto const id = surface_ids[surface.get()] = next_id++;
+
+            Record record{Call::add_surface};
+            record.put_uint(id_for(session));
+            record.put_uint(id);
+            record.put(params.name);
+            record.put(params.top_left);
+            record.put(params.size);
+            record.put_uint(id_for(params.parent.lock()));
+            record.put_common_attributes(params);
+            write(record);
+
+            surface->add_observer(std::make_shared<msh::SurfaceReadyObserver>(
+                [this](std::shared_ptr<ms::Session> const& session, std::shared_ptr<ms::Surface> const& surface)
+                    {
+                        std::lock_guard<std::mutex> lock{mutex};
+                        Record record{Call::surface_ready};
+                        record.put_uint(id_for(session));
+                        record.put_uint(id_for(surface));
+                        write(record);
+                    },
+                session,
+                surface));
+
+            return surface_id;
+        };
+
+    return next->add_surface(session, params, record_and_build);
+}
+
+void miral::WindowManagerRecorder::modify_surface(
+    std::shared_ptr<ms::Session> const& session,
+    std::shared_ptr<ms::Surface> const& surface,
+    msh::SurfaceSpecification const& modifications)
+{
+    if (!recording)
+        return next->modify_surface(session, surface, modifications);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::modify_surface};
+    record.put_uint(id_for(session));
+    record.put_uint(id_for(surface));
+
+    auto const& mods = modifications;
+    record.put_uint(
+        (mods.width.is_set() ? 1 : 0) |
+        (mods.height.is_set() ? 2 : 0) |
+        (mods.name.is_set() ? 4 : 0) |
+        (mods.parent.is_set() ? 8 : 0));
+
+    if (mods.width.is_set()) record.put(mods.width.value());
+    if (mods.height.is_set()) record.put(mods.height.value());
+    if (mods.name.is_set()) record.put(mods.name.value());
+    if (mods.parent.is_set()) record.put_uint(id_for(mods.parent.value().lock()));
+    record.put_common_attributes(mods);
+    write(record);
+
+    next->modify_surface(session, surface, modifications);
+}
+
+void miral::WindowManagerRecorder::remove_surface(
+    std::shared_ptr<ms::Session> const& session,
+    std::weak_ptr<ms::Surface> const& surface)
+{
+    auto const removed = surface.lock();
+
+    if (!recording)
+        return next->remove_surface(session, surface);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::remove_surface};
+    record.put_uint(id_for(session));
+    record.put_uint(id_for(removed));
+    write(record);
+
+    next->remove_surface(session, surface);
+
+    surface_ids.erase(removed.get());
+}
+
+void miral::WindowManagerRecorder::add_display(geom::Rectangle const& area)
+{
+    if (!recording)
+        return next->add_display(area);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::add_display};
+    record.put(area);
+    write(record);
+
+    next->add_display(area);
+}
+
+void miral::WindowManagerRecorder::remove_display(geom::Rectangle const& area)
+{
+    if (!recording)
+        return next->remove_display(area);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::remove_display};
+    record.put(area);
+    write(record);
+
+    next->remove_display(area);
+}
+
+bool miral::WindowManagerRecorder::handle_keyboard_event(MirKeyboardEvent const* event)
+{
+    if (!recording)
+        return next->handle_keyboard_event(event);
+
+    auto const input_event = mir_keyboard_event_input_event(event);
+
+    Record record{Call::handle_keyboard_event};
+    record.put_int(mir_input_event_get_device_id(input_event));
+    record.put_int(mir_input_event_get_event_time(input_event));
+    record.put(mir_keyboard_event_action(event));
+    record.put_int(mir_keyboard_event_key_code(event));
+    record.put_int(mir_keyboard_event_scan_code(event));
+    record.put_uint(mir_keyboard_event_modifiers(event));
+
+    std::lock_guard<std::mutex> lock{mutex};
+    write(record);
+
+    return next->handle_keyboard_event(event);
+}
+
+bool miral::WindowManagerRecorder::handle_touch_event(MirTouchEvent const* event)
+{
+    if (!recording)
+        return next->handle_touch_event(event);
+
+    auto const input_event = mir_touch_event_input_event(event);
+    auto const count = mir_touch_event_point_count(event);
+
+    Record record{Call::handle_touch_event};
+    record.put_int(mir_input_event_get_device_id(input_event));
+    record.put_int(mir_input_event_get_event_time(input_event));
+    record.put_uint(mir_touch_event_modifiers(event));
+    record.put_uint(count);
+
+    for (auto i = 0u; i != count; ++i)
+    {
+        record.put_int(mir_touch_event_id(event, i));
+        record.put(mir_touch_event_action(event, i));
+        record.put(mir_touch_event_tooltype(event, i));
+        record.put_float(mir_touch_event_axis_value(event, i, mir_touch_axis_x));
+        record.put_float(mir_touch_event_axis_value(event, i, mir_touch_axis_y));
+        record.put_float(mir_touch_event_axis_value(event, i, mir_touch_axis_pressure));
+        record.put_float(mir_touch_event_axis_value(event, i, mir_touch_axis_touch_major));
+        record.put_float(mir_touch_event_axis_value(event, i, mir_touch_axis_touch_minor));
+        record.put_float(mir_touch_event_axis_value(event, i, mir_touch_axis_size));
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    write(record);
+
+    return next->handle_touch_event(event);
+}
+
+bool miral::WindowManagerRecorder::handle_pointer_event(MirPointerEvent const* event)
+{
+    if (!recording)
+        return next->handle_pointer_event(event);
+
+    auto const input_event = mir_pointer_event_input_event(event);
+
+    Record record{Call::handle_pointer_event};
+    record.put_int(mir_input_event_get_device_id(input_event));
+    record.put_int(mir_input_event_get_event_time(input_event));
+    record.put_uint(mir_pointer_event_modifiers(event));
+    record.put(mir_pointer_event_action(event));
+    record.put_uint(mir_pointer_event_buttons(event));
+    record.put_float(mir_pointer_event_axis_value(event, mir_pointer_axis_x));
+    record.put_float(mir_pointer_event_axis_value(event, mir_pointer_axis_y));
+    record.put_float(mir_pointer_event_axis_value(event, mir_pointer_axis_hscroll));
+    record.put_float(mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll));
+    record.put_float(mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x));
+    record.put_float(mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y));
+
+    std::lock_guard<std::mutex> lock{mutex};
+    write(record);
+
+    return next->handle_pointer_event(event);
+}
+
+void miral::WindowManagerRecorder::handle_raise_surface(
+    std::shared_ptr<ms::Session> const& session,
+    std::shared_ptr<ms::Surface> const& surface,
+    uint64_t timestamp)
+{
+    if (!recording)
+        return next->handle_raise_surface(session, surface, timestamp);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::handle_raise_surface};
+    record.put_uint(id_for(session));
+    record.put_uint(id_for(surface));
+    record.put_uint(timestamp);
+    write(record);
+
+    next->handle_raise_surface(session, surface, timestamp);
+}
+
+int miral::WindowManagerRecorder::set_surface_attribute(
+    std::shared_ptr<ms::Session> const& session,
+    std::shared_ptr<ms::Surface> const& surface,
+    MirWindowAttrib attrib,
+    int value)
+{
+    if (!recording)
+        return next->set_surface_attribute(session, surface, attrib, value);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Record record{Call::set_surface_attribute};
+    record.put_uint(id_for(session));
+    record.put_uint(id_for(surface));
+    record.put(attrib);
+    record.put(value);
+    write(record);
+
+    return next->set_surface_attribute(session, surface, attrib, value);
+}
+
+miral::WindowManagerReplay::WindowManagerReplay(
+    msh::WindowManager& window_manager,
+    SessionBuilder const& make_session,
+    SurfaceReady const& surface_ready) :
+    window_manager{window_manager},
+    make_session{make_session},
+    surface_ready{surface_ready}
+{
+}
+
+miral::WindowManagerReplay::~WindowManagerReplay() = default;
+
+auto miral::WindowManagerReplay::replay(std::istream& in) -> std::size_t
+{
+    char header[sizeof magic];
+    if (!in.read(header, sizeof header) || std::memcmp(header, magic, sizeof magic) != 0)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Not a window manager recording"));
+
+    Reader reader{in};
+    std::size_t calls = 0;
+
+    while (!reader.at_end())
+    {
+        replay_call(reader);
+        ++calls;
+    }
+
+    return calls;
+}
+
+auto miral::WindowManagerReplay::session_for(uint64_t id) const -> std::shared_ptr<ms::Session>
+{
+    auto const i = sessions.find(id);
+    return i != sessions.end() ? i->second : std::shared_ptr<ms::Session>{};
+}
+
+auto miral::WindowManagerReplay::surface_for(uint64_t id) const -> std::shared_ptr<ms::Surface>
+{
+    auto const i = surfaces.find(id);
+    return i != surfaces.end() ? i->second : std::shared_ptr<ms::Surface>{};
+}
+
+void miral::WindowManagerReplay::replay_call(Reader& reader)
+{
+    auto const call = static_cast<Call>(reader.get_byte());
+    reader.get_uint();  // The time since the previous call isn't needed to replay as fast as possible
+
+    switch (call)
+    {
+    case Call::add_session:
+    {
+        auto const id = reader.get_uint();
+        std::string name;
+        reader.get(name);
+
+        auto const session = sessions[id] = make_session(name);
+        window_manager.add_session(session);
+        break;
+    }
+
+    case Call::remove_session:
+    {
+        auto const id = reader.get_uint();
+        window_manager.remove_session(session_for(id));
+        sessions.erase(id);
+        break;
+    }
+
+    case Call::add_surface:
+    {
+        auto const session = session_for(reader.get_uint());
+        auto const id = reader.get_uint();
+
+        ms::SurfaceCreationParameters params;
+        reader.get(params.name);
+        reader.get(params.top_left);
+        reader.get(params.size);
+        params.parent = surface_for(reader.get_uint());
+        reader.get_common_attributes(params);
+
+        std::shared_ptr<ms::Surface> surface;
+        window_manager.add_surface(session, params,
+            [&](std::shared_ptr<ms::Session> const& session, ms::SurfaceCreationParameters const& params)
+            {
+                auto const surface_id = session->create_surface(params, {});
+                surface = session->surface(surface_id);
+                return surface_id;
+            });
+
+        surfaces[id] = surface;
+        break;
+    }
+
+    case Call::modify_surface:
+    {
+        auto const session = session_for(reader.get_uint());
+        auto const surface = surface_for(reader.get_uint());
+
+        msh::SurfaceSpecification mods;
+        auto const mask = reader.get_uint();
+
+        if (mask & 1) { geom::Width width; reader.get(width); mods.width = width; }
+        if (mask & 2) { geom::Height height; reader.get(height); mods.height = height; }
+        if (mask & 4) { std::string name; reader.get(name); mods.name = name; }
+        if (mask & 8) { mods.parent = std::weak_ptr<ms::Surface>{surface_for(reader.get_uint())}; }
+        reader.get_common_attributes(mods);
+
+        window_manager.modify_surface(session, surface, mods);
+        break;
+    }
+
+    case Call::remove_surface:
+    {
+        auto const session = session_for(reader.get_uint());
+        auto const id = reader.get_uint();
+
+        window_manager.remove_surface(session, surface_for(id));
+        surfaces.erase(id);
+        break;
+    }
+
+    case Call::add_display:
+    {
+        geom::Rectangle area;
+        reader.get(area);
+        window_manager.add_display(area);
+        break;
+    }
+
+    case Call::remove_display:
+    {
+        geom::Rectangle area;
+        reader.get(area);
+        window_manager.remove_display(area);
+        break;
+    }
+
+    case Call::handle_keyboard_event:
+    {
+        auto const device_id = reader.get_int();
+        std::chrono::nanoseconds const event_time{reader.get_int()};
+        MirKeyboardAction action;
+        reader.get(action);
+        auto const key_code = reader.get_int();
+        auto const scan_code = reader.get_int();
+        auto const modifiers = reader.get_uint();
+
+        auto const event = mir::events::make_event(
+            device_id, event_time, std::vector<uint8_t>{}, action,
+            static_cast<uint32_t>(key_code), static_cast<int>(scan_code), static_cast<MirInputEventModifiers>(modifiers));
+
+        window_manager.handle_keyboard_event(
+            mir_input_event_get_keyboard_event(mir_event_get_input_event(event.get())));
+        break;
+    }
+
+    case Call::handle_touch_event:
+    {
+        auto const device_id = reader.get_int();
+        std::chrono::nanoseconds const event_time{reader.get_int()};
+        auto const modifiers = static_cast<MirInputEventModifiers>(reader.get_uint());
+        auto const count = reader.get_uint();
+
+        auto const event = mir::events::make_event(device_id, event_time, std::vector<uint8_t>{}, modifiers);
+
+        for (auto i = 0u; i != count; ++i)
+        {
+            auto const touch_id = static_cast<MirTouchId>(reader.get_int());
+            MirTouchAction action;
+            reader.get(action);
+            MirTouchTooltype tooltype;
+            reader.get(tooltype);
+            auto const x = reader.get_float();
+            auto const y = reader.get_float();
+            auto const pressure = reader.get_float();
+            auto const touch_major = reader.get_float();
+            auto const touch_minor = reader.get_float();
+            auto const size = reader.get_float();
+
+            mir::events::add_touch(*event, touch_id, action, tooltype, x, y, pressure, touch_major, touch_minor, size);
+        }
+
+        window_manager.handle_touch_event(
+            mir_input_event_get_touch_event(mir_event_get_input_event(event.get())));
+        break;
+    }
+
+    case Call::handle_pointer_event:
+    {
+        auto const device_id = reader.get_int();
+        std::chrono::nanoseconds const event_time{reader.get_int()};
+        auto const modifiers = static_cast<MirInputEventModifiers>(reader.get_uint());
+        MirPointerAction action;
+        reader.get(action);
+        auto const buttons = static_cast<MirPointerButtons>(reader.get_uint());
+        auto const x = reader.get_float();
+        auto const y = reader.get_float();
+        auto const hscroll = reader.get_float();
+        auto const vscroll = reader.get_float();
+        auto const relative_x = reader.get_float();
+        auto const relative_y = reader.get_float();
+
+        auto const event = mir::events::make_event(
+            device_id, event_time, std::vector<uint8_t>{}, modifiers,
+            action, buttons, x, y, hscroll, vscroll, relative_x, relative_y);
+
+        window_manager.handle_pointer_event(
+            mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+        break;
+    }
+
+    case Call::handle_raise_surface:
+    {
+        auto const session = session_for(reader.get_uint());
+        auto const surface = surface_for(reader.get_uint());
+        auto const timestamp = reader.get_uint();
+
+        window_manager.handle_raise_surface(session, surface, timestamp);
+        break;
+    }
+
+    case Call::set_surface_attribute:
+    {
+        auto const session = session_for(reader.get_uint());
+        auto const surface = surface_for(reader.get_uint());
+        MirWindowAttrib attrib;
+        reader.get(attrib);
+        int value;
+        reader.get(value);
+
+        window_manager.set_surface_attribute(session, surface, attrib, value);
+        break;
+    }
+
+    case Call::surface_ready:
+    {
+        reader.get_uint();  // The session isn't needed to find the surface
+        if (auto const surface = surface_for(reader.get_uint()))
+            surface_ready(surface);
+        break;
+    }
+
+    default:
+        BOOST_THROW_EXCEPTION(std::runtime_error("Unknown call in window manager recording"));
+    }
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_MANAGER_RECORDING_H
+#define MIRAL_WINDOW_MANAGER_RECORDING_H
+
+#include <mir/shell/window_manager.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace miral
+{
+/// Records the calls made on a window manager, with their arguments, before passing
+/// them on. Sessions and surfaces are numbered in the order they are added, so that
+/// WindowManagerReplay can repeat the calls on another window manager.
+///
+/// Each call is recorded and passed on under the same lock, so calls are written in the
+/// order the window manager handles them (at the cost of serializing the window manager
+/// while recording). The exception is a surface becoming ready: that is recorded by an
+/// observer of its own, under the lock, just before the window manager's observer is told.
+/// The lock is released in between, so another call can be recorded and handled first and
+/// a replay may then handle the two in the other order.
+///
+/// If writing to the stream fails recording stops (and is logged), and calls are then
+/// passed on without the lock. Buffer streams and output ids are not recorded as they
+/// have no meaning outside the server.
+class WindowManagerRecorder : public mir::shell::WindowManager
+{
+public:
+    WindowManagerRecorder(
+        std::shared_ptr<mir::shell::WindowManager> const& next,
+        std::shared_ptr<std::ostream> const& out);
+
+    ~WindowManagerRecorder();
+
+    void add_session(std::shared_ptr<mir::scene::Session> const& session) override;
+
+    void remove_session(std::shared_ptr<mir::scene::Session> const& session) override;
+
+    auto add_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        mir::scene::SurfaceCreationParameters const& params,
+        std::function<mir::frontend::SurfaceId(std::shared_ptr<mir::scene::Session> const& session, mir::scene::SurfaceCreationParameters const& params)> const& build)
+    -> mir::frontend::SurfaceId override;
+
+    void modify_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        mir::shell::SurfaceSpecification const& modifications) override;
+
+    void remove_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::weak_ptr<mir::scene::Surface> const& surface) override;
+
+    void add_display(mir::geometry::Rectangle const& area) override;
+
+    void remove_display(mir::geometry::Rectangle const& area) override;
+
+    bool handle_keyboard_event(MirKeyboardEvent const* event) override;
+
+    bool handle_touch_event(MirTouchEvent const* event) override;
+
+    bool handle_pointer_event(MirPointerEvent const* event) override;
+
+    void handle_raise_surface(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        uint64_t timestamp) override;
+
+    int set_surface_attribute(
+        std::shared_ptr<mir::scene::Session> const& session,
+        std::shared_ptr<mir::scene::Surface> const& surface,
+        MirWindowAttrib attrib,
+        int value) override;
+
+    /// Write any buffered records to the stream
+    void flush();
+
+    /// False once writing to the stream has failed
+    auto is_recording() const -> bool;
+
+private:
+    class Record;
+
+    std::shared_ptr<mir::shell::WindowManager> const next;
+    std::shared_ptr<std::ostream> const out;
+
+    std::atomic<bool> recording{true};
+    std::mutex mutable mutex;
+    std::chrono::steady_clock::time_point last_record;
+    std::uint64_t next_id{1};
+    std::map<mir::scene::Session const*, std::uint64_t> session_ids;
+    std::map<mir::scene::Surface const*, std::uint64_t> surface_ids;
+
+    auto id_for(std::shared_ptr<mir::scene::Session> const& session) const -> std::uint64_t;
+    auto id_for(std::shared_ptr<mir::scene::Surface> const& surface) const -> std::uint64_t;
+    void write(Record const& record);
+    void stop_recording();
+};
+
+/// Repeats the calls recorded by WindowManagerRecorder on a window manager. Sessions are
+/// created by a SessionBuilder and surfaces by asking those sessions to create them.
+/// A surface becoming ready is replayed by SurfaceReady, which should make the surface
+/// notify its observers that a frame has been posted.
+///
+/// Calls are replayed as fast as the window manager handles them, so that replaying a
+/// recording against different policies compares the cost of the policies.
+class WindowManagerReplay
+{
+public:
+    using SessionBuilder = std::function<std::shared_ptr<mir::scene::Session>(std::string const& name)>;
+
+    using SurfaceReady = std::function<void(std::shared_ptr<mir::scene::Surface> const& surface)>;
+
+    WindowManagerReplay(
+        mir::shell::WindowManager& window_manager,
+        SessionBuilder const& make_session,
+        SurfaceReady const& surface_ready = [](std::shared_ptr<mir::scene::Surface> const&){});
+
+    ~WindowManagerReplay();
+
+    /// Replay the calls in a recording
+    /// \return the number of calls replayed
+    auto replay(std::istream& in) -> std::size_t;
+
+private:
+    class Reader;
+
+    mir::shell::WindowManager& window_manager;
+    SessionBuilder const make_session;
+    SurfaceReady const surface_ready;
+
+    std::map<std::uint64_t, std::shared_ptr<mir::scene::Session>> sessions;
+    std::map<std::uint64_t, std::shared_ptr<mir::scene::Surface>> surfaces;
+
+    void replay_call(Reader& reader);
+    auto session_for(std::uint64_t id) const -> std::shared_ptr<mir::scene::Session>;
+    auto surface_for(std::uint64_t id) const -> std::shared_ptr<mir::scene::Surface>;
+};
+}
+
+#endif //MIRAL_WINDOW_MANAGER_RECORDING_H
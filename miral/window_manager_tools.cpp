@@ -47,6 +47,9 @@ auto miral::WindowManagerTools::info_for(std::weak_ptr<mir::scene::Surface> cons
 auto miral::WindowManagerTools::info_for(Window const& window) const -> WindowInfo&
 { return tools->info_for(window); }
 
+void miral::WindowManagerTools::for_each_window(std::function<void(WindowInfo& info)> const& functor)
+{ tools->for_each_window(functor); }
+
 void miral::WindowManagerTools::ask_client_to_close(Window const& window)
 { tools->ask_client_to_close(window); }
 
@@ -77,6 +80,9 @@ void miral::WindowManagerTools::focus_prev_within_application()
 auto miral::WindowManagerTools::window_at(mir::geometry::Point cursor) const -> Window
 { return tools->window_at(cursor); }
 
+auto miral::WindowManagerTools::windows_intersecting(mir::geometry::Rectangle const& rect) const -> std::vector<Window>
+{ return tools->windows_intersecting(rect); }
+
 auto miral::WindowManagerTools::active_display() -> mir::geometry::Rectangle const
 { return tools->active_display(); }
 
@@ -89,6 +95,9 @@ void miral::WindowManagerTools::modify_window(WindowInfo& window_info, WindowSpe
 void miral::WindowManagerTools::modify_window(Window const& window, WindowSpecification const& modifications)
 { tools->modify_window(tools->info_for(window), modifications); }
 
+void miral::WindowManagerTools::modify_windows(std::vector<std::pair<Window, WindowSpecification>> const& modifications)
+{ tools->modify_windows(modifications); }
+
 auto miral::WindowManagerTools::info_for_window_id(std::string const& id) const -> WindowInfo&
 { return tools->info_for_window_id(id); }
 
@@ -98,6 +107,18 @@ auto miral::WindowManagerTools::id_for_window(Window const& window) const -> std
 void miral::WindowManagerTools::invoke_under_lock(std::function<void()> const& callback)
 { tools->invoke_under_lock(callback); }
 
+void miral::WindowManagerTools::invoke_under_shared_lock(std::function<void()> const& callback)
+{ tools->invoke_under_shared_lock(callback); }
+
+auto miral::WindowManagerTools::pointer_motion_counts() const -> PointerMotionCounts
+{ return tools->pointer_motion_counts(); }
+
+auto miral::WindowManagerTools::policy_latencies() const -> std::vector<PolicyHookLatency>
+{ return tools->policy_latencies(); }
+
+auto miral::WindowManagerTools::lock_latencies() const -> std::vector<LockLatency>
+{ return tools->lock_latencies(); }
+
 void miral::WindowManagerTools::place_and_size_for_state(
     WindowSpecification& modifications, WindowInfo const& window_info) const
 { tools->place_and_size_for_state(modifications, window_info); }
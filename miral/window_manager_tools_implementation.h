@@ -26,6 +26,8 @@
 
 #include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace mir { namespace scene { class Surface; } }
 
@@ -36,6 +38,9 @@ struct WindowInfo;
 struct ApplicationInfo;
 class WindowSpecification;
 class Workspace;
+struct PointerMotionCounts;
+struct PolicyHookLatency;
+struct LockLatency;
 
 // The interface through which the policy instructs the controller.
 class WindowManagerToolsImplementation
@@ -53,6 +58,7 @@ public:
     virtual auto info_for(std::weak_ptr<mir::scene::Session> const& session) const -> ApplicationInfo& = 0;
     virtual auto info_for(std::weak_ptr<mir::scene::Surface> const& surface) const -> WindowInfo& = 0;
     virtual auto info_for(Window const& window) const -> WindowInfo& = 0;
+    virtual void for_each_window(std::function<void(WindowInfo& info)> const& functor) = 0;
 
     virtual void ask_client_to_close(Window const& window) = 0;
     virtual void force_close(Window const& window) = 0;
@@ -64,9 +70,11 @@ public:
     virtual void focus_next_within_application() = 0;
     virtual void focus_prev_within_application() = 0;
     virtual auto window_at(mir::geometry::Point cursor) const -> Window = 0;
+    virtual auto windows_intersecting(mir::geometry::Rectangle const& rect) const -> std::vector<Window> = 0;
     virtual auto active_display() -> mir::geometry::Rectangle const = 0;
     virtual void raise_tree(Window const& root) = 0;
     virtual void modify_window(WindowInfo& window_info, WindowSpecification const& modifications) = 0;
+    virtual void modify_windows(std::vector<std::pair<Window, WindowSpecification>> const& modifications) = 0;
     virtual auto info_for_window_id(std::string const& id) const -> WindowInfo& = 0;
     virtual auto id_for_window(Window const& window) const -> std::string = 0;
     virtual void place_and_size_for_state(WindowSpecification& modifications, WindowInfo const& window_info) const= 0;
@@ -89,12 +97,20 @@ public:
 /** @name Multi-thread support
  *  Allows threads that don't hold a lock on the model to acquire one and call the "Update Model"
  *  member functions.
+ *  invoke_under_shared_lock() allows concurrent readers that only query the model.
  *  This should NOT be used by a thread that has called the WindowManagementPolicy methods (and
  *  already holds the lock).
  *  @{ */
     virtual void invoke_under_lock(std::function<void()> const& callback) = 0;
+    virtual void invoke_under_shared_lock(std::function<void()> const& callback) = 0;
 /** @} */
 
+    virtual auto pointer_motion_counts() const -> PointerMotionCounts = 0;
+
+    virtual auto policy_latencies() const -> std::vector<PolicyHookLatency> = 0;
+
+    virtual auto lock_latencies() const -> std::vector<LockLatency> = 0;
+
     virtual ~WindowManagerToolsImplementation() = default;
     WindowManagerToolsImplementation() = default;
     WindowManagerToolsImplementation(WindowManagerToolsImplementation const&) = delete;
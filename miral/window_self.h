@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_SELF_H
+#define MIRAL_WINDOW_SELF_H
+
+#include "miral/window.h"
+#include "mru_window_list.h"
+#include "slot_map.h"
+#include "spatial_index.h"
+#include "workspace_set.h"
+
+struct miral::Window::Self
+{
+    Self(std::shared_ptr<mir::scene::Session> const& session, std::shared_ptr<mir::scene::Surface> const& surface);
+
+    std::weak_ptr<mir::scene::Session> const session;
+    std::weak_ptr<mir::scene::Surface> const surface;
+
+    // Where the BasicWindowManager that owns this window keeps its WindowInfo
+    SlotHandle info_slot;
+
+    // The node of the MRUWindowList this window is in (if any)
+    MRUWindowList::Node* mru_node = nullptr;
+
+    // The entry of the SpatialIndex this window is in (if any)
+    SpatialIndex::Entry* index_entry = nullptr;
+
+    // The ids of the workspaces containing this window
+    WorkspaceSet workspaces;
+};
+
+#endif //MIRAL_WINDOW_SELF_H
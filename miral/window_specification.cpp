@@ -24,18 +24,31 @@
 
 struct miral::WindowSpecification::Self
 {
+    // The fields that are costly to copy are kept together and shared between copies
+    // of a specification until one of them is modified
+    struct Shared
+    {
+        mir::optional_value<std::string> name;
+        mir::optional_value<std::vector<mir::shell::StreamSpecification>> streams;
+        mir::optional_value<std::weak_ptr<mir::scene::Surface>> parent;
+        mir::optional_value<std::vector<Rectangle>> input_shape;
+        mir::optional_value<std::shared_ptr<void>> userdata;
+    };
+
     Self() = default;
-    Self(Self const&) = default;
+    Self(Self const& that);
     Self(mir::shell::SurfaceSpecification const& spec);
     Self(mir::scene::SurfaceCreationParameters const& params);
 
     void update(mir::scene::SurfaceCreationParameters& params) const;
 
+    auto shared() const -> Shared const&;
+    auto writable_shared() -> Shared&;
+
     mir::optional_value<Point> top_left;
     mir::optional_value<Size> size;
     mir::optional_value<MirPixelFormat> pixel_format;
     mir::optional_value<BufferUsage> buffer_usage;
-    mir::optional_value<std::string> name;
     mir::optional_value<int> output_id;
     mir::optional_value<MirWindowType> type;
     mir::optional_value<MirWindowState> state;
@@ -54,21 +67,71 @@ struct miral::WindowSpecification::Self
     mir::optional_value<DeltaY> height_inc;
     mir::optional_value<AspectRatio> min_aspect;
     mir::optional_value<AspectRatio> max_aspect;
-    mir::optional_value<std::vector<mir::shell::StreamSpecification>> streams;
-    mir::optional_value<std::weak_ptr<mir::scene::Surface>> parent;
-    mir::optional_value<std::vector<Rectangle>> input_shape;
     mir::optional_value<InputReceptionMode> input_mode;
     mir::optional_value<MirShellChrome> shell_chrome;
     mir::optional_value<MirPointerConfinementState> confine_pointer;
-    mir::optional_value<std::shared_ptr<void>> userdata;
+
+    // Null until a shared field is set
+    std::shared_ptr<Shared> shared_fields;
+
+    // Set once a non-const reference into shared_fields has been handed out. As the
+    // holder of the reference may still write through it, copies can't share them.
+    bool shared_fields_exposed{false};
 };
 
+miral::WindowSpecification::Self::Self(Self const& that) :
+    top_left(that.top_left),
+    size(that.size),
+    pixel_format(that.pixel_format),
+    buffer_usage(that.buffer_usage),
+    output_id(that.output_id),
+    type(that.type),
+    state(that.state),
+    preferred_orientation(that.preferred_orientation),
+    content_id(that.content_id),
+    aux_rect(that.aux_rect),
+    placement_hints(that.placement_hints),
+    window_placement_gravity(that.window_placement_gravity),
+    aux_rect_placement_gravity(that.aux_rect_placement_gravity),
+    aux_rect_placement_offset(that.aux_rect_placement_offset),
+    min_width(that.min_width),
+    min_height(that.min_height),
+    max_width(that.max_width),
+    max_height(that.max_height),
+    width_inc(that.width_inc),
+    height_inc(that.height_inc),
+    min_aspect(that.min_aspect),
+    max_aspect(that.max_aspect),
+    input_mode(that.input_mode),
+    shell_chrome(that.shell_chrome),
+    confine_pointer(that.confine_pointer),
+    shared_fields(that.shared_fields_exposed && that.shared_fields ?
+        std::make_shared<Shared>(*that.shared_fields) : that.shared_fields)
+{
+}
+
+auto miral::WindowSpecification::Self::shared() const -> Shared const&
+{
+    static Shared const unset;
+    return shared_fields ? *shared_fields : unset;
+}
+
+auto miral::WindowSpecification::Self::writable_shared() -> Shared&
+{
+    if (!shared_fields)
+        shared_fields = std::make_shared<Shared>();
+    else if (shared_fields.use_count() > 1)
+        shared_fields = std::make_shared<Shared>(*shared_fields);
+
+    shared_fields_exposed = true;
+    return *shared_fields;
+}
+
 miral::WindowSpecification::Self::Self(mir::shell::SurfaceSpecification const& spec) :
     top_left(),
     size(),
     pixel_format(spec.pixel_format),
     buffer_usage(),
-    name(spec.name),
     output_id(),
     type(spec.type),
     state(spec.state),
@@ -87,15 +150,21 @@ miral::WindowSpecification::Self::Self(mir::shell::SurfaceSpecification const& s
     height_inc(spec.height_inc),
     min_aspect(),
     max_aspect(),
-    streams(spec.streams),
-    parent(spec.parent),
-    input_shape(spec.input_shape),
     input_mode(),
     shell_chrome(spec.shell_chrome)
 #if MIRAL_MIR_DEFINES_POINTER_CONFINEMENT
     ,confine_pointer(spec.confine_pointer)
 #endif
 {
+    if (spec.name.is_set() || spec.streams.is_set() || spec.parent.is_set() || spec.input_shape.is_set())
+    {
+        shared_fields = std::make_shared<Shared>();
+        shared_fields->name = spec.name;
+        shared_fields->streams = spec.streams;
+        shared_fields->parent = spec.parent;
+        shared_fields->input_shape = spec.input_shape;
+    }
+
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 25, 0)
     if (spec.aux_rect_placement_offset_x.is_set() && spec.aux_rect_placement_offset_y.is_set())
         aux_rect_placement_offset = Displacement{spec.aux_rect_placement_offset_x.value(), spec.aux_rect_placement_offset_y.value()};
@@ -223,7 +292,6 @@ miral::WindowSpecification::Self::Self(mir::scene::SurfaceCreationParameters con
     size(params.size),
     pixel_format(params.pixel_format),
     buffer_usage(static_cast<BufferUsage>(params.buffer_usage)),
-    name(params.name),
     output_id(params.output_id.as_value()),
     type(params.type),
     state(params.state),
@@ -242,19 +310,20 @@ miral::WindowSpecification::Self::Self(mir::scene::SurfaceCreationParameters con
     height_inc(params.height_inc),
     min_aspect(),
     max_aspect(),
-#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 22, 0)
-    streams(params.streams),
-#else
-    streams(),
-#endif
-    parent(params.parent),
-    input_shape(params.input_shape),
     input_mode(static_cast<InputReceptionMode>(params.input_mode)),
     shell_chrome(params.shell_chrome)
 #if MIRAL_MIR_DEFINES_POINTER_CONFINEMENT
     ,confine_pointer(params.confine_pointer)
 #endif
+    ,shared_fields(std::make_shared<Shared>())
 {
+    shared_fields->name = params.name;
+#if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 22, 0)
+    shared_fields->streams = params.streams;
+#endif
+    shared_fields->parent = params.parent;
+    shared_fields->input_shape = params.input_shape;
+
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 25, 0)
     if (params.aux_rect_placement_offset_x.is_set() && params.aux_rect_placement_offset_y.is_set())
         aux_rect_placement_offset = Displacement{params.aux_rect_placement_offset_x.value(), params.aux_rect_placement_offset_y.value()};
@@ -310,7 +379,9 @@ void miral::WindowSpecification::Self::update(mir::scene::SurfaceCreationParamet
     copy_if_set(params.size, size);
     copy_if_set(params.pixel_format, pixel_format);
     copy_if_set(params.buffer_usage, buffer_usage);
-    copy_if_set(params.name, name);
+    auto const& shared = this->shared();
+
+    copy_if_set(params.name, shared.name);
     copy_if_set(params.output_id, output_id);
     copy_if_set(params.type, type);
     copy_if_set(params.state, state);
@@ -326,10 +397,10 @@ void miral::WindowSpecification::Self::update(mir::scene::SurfaceCreationParamet
     copy_if_set(params.min_aspect, min_aspect);
     copy_if_set(params.max_aspect, max_aspect);
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 22, 0)
-    copy_if_set(params.streams, streams);
+    copy_if_set(params.streams, shared.streams);
 #endif
-    copy_if_set(params.parent, parent);
-    copy_if_set(params.input_shape, input_shape);
+    copy_if_set(params.parent, shared.parent);
+    copy_if_set(params.input_shape, shared.input_shape);
     copy_if_set(params.input_mode, input_mode);
     copy_if_set(params.shell_chrome, shell_chrome);
 #if MIRAL_MIR_DEFINES_POINTER_CONFINEMENT
@@ -395,7 +466,7 @@ auto miral::WindowSpecification::size() const -> mir::optional_value<Size> const
 
 auto miral::WindowSpecification::name() const -> mir::optional_value<std::string> const&
 {
-    return self->name;
+    return self->shared().name;
 }
 
 auto miral::WindowSpecification::output_id() const -> mir::optional_value<int> const&
@@ -485,12 +556,12 @@ auto miral::WindowSpecification::max_aspect() const -> mir::optional_value<Aspec
 
 auto miral::WindowSpecification::parent() const -> mir::optional_value<std::weak_ptr<mir::scene::Surface>> const&
 {
-    return self->parent;
+    return self->shared().parent;
 }
 
 auto miral::WindowSpecification::input_shape() const -> mir::optional_value<std::vector<Rectangle>> const&
 {
-    return self->input_shape;
+    return self->shared().input_shape;
 }
 
 auto miral::WindowSpecification::input_mode() const -> mir::optional_value<InputReceptionMode> const&
@@ -510,7 +581,7 @@ auto miral::WindowSpecification::confine_pointer() const -> mir::optional_value<
 
 auto miral::WindowSpecification::userdata() const -> mir::optional_value<std::shared_ptr<void>> const&
 {
-    return self->userdata;
+    return self->shared().userdata;
 }
 
 auto miral::WindowSpecification::top_left() -> mir::optional_value<Point>&
@@ -525,7 +596,7 @@ auto miral::WindowSpecification::size() -> mir::optional_value<Size>&
 
 auto miral::WindowSpecification::name() -> mir::optional_value<std::string>&
 {
-    return self->name;
+    return self->writable_shared().name;
 }
 
 auto miral::WindowSpecification::output_id() -> mir::optional_value<int>&
@@ -615,12 +686,12 @@ auto miral::WindowSpecification::max_aspect() -> mir::optional_value<AspectRatio
 
 auto miral::WindowSpecification::parent() -> mir::optional_value<std::weak_ptr<mir::scene::Surface>>&
 {
-    return self->parent;
+    return self->writable_shared().parent;
 }
 
 auto miral::WindowSpecification::input_shape() -> mir::optional_value<std::vector<Rectangle>>&
 {
-    return self->input_shape;
+    return self->writable_shared().input_shape;
 }
 
 auto miral::WindowSpecification::input_mode() -> mir::optional_value<InputReceptionMode>&
@@ -640,5 +711,5 @@ auto miral::WindowSpecification::confine_pointer() -> mir::optional_value<MirPoi
 
 auto miral::WindowSpecification::userdata() -> mir::optional_value<std::shared_ptr<void>>&
 {
-    return self->userdata;
+    return self->writable_shared().userdata;
 }
@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WINDOW_TREE_WALKER_H
+#define MIRAL_WINDOW_TREE_WALKER_H
+
+#include "miral/window_info.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace miral
+{
+/// Storage for WindowTreeWalker that is kept between walks, so that once it has grown
+/// to fit the deepest and largest trees walking them doesn't allocate.
+struct WindowTreeScratch
+{
+    std::vector<Window> windows;
+    std::vector<std::pair<WindowInfo const*, std::size_t>> stack;
+    std::vector<Window> branch;
+    std::vector<Window> selected;
+};
+
+/// Collects a window and its descendants, parents before children and children in
+/// order, using an explicit stack rather than recursion.
+///
+/// The walker borrows the scratch storage for its lifetime and returns it afterwards.
+/// A walk started while another is in progress (e.g. from a policy callback) finds the
+/// scratch empty and uses storage of its own, so it can't disturb the outer walk.
+class WindowTreeWalker
+{
+public:
+    explicit WindowTreeWalker(WindowTreeScratch& scratch) : owner(scratch)
+    {
+        std::swap(owner, this->scratch);
+    }
+
+    ~WindowTreeWalker()
+    {
+        scratch.windows.clear();
+        scratch.stack.clear();
+        scratch.branch.clear();
+        scratch.selected.clear();
+        std::swap(owner, scratch);
+    }
+
+    WindowTreeWalker(WindowTreeWalker const&) = delete;
+    WindowTreeWalker& operator=(WindowTreeWalker const&) = delete;
+
+    /// \return root and its descendants (valid until the next walk or the walker is destroyed)
+    template<typename InfoFor>
+    auto collect(Window const& root, InfoFor const& info_for) -> std::vector<Window> const&
+    {
+        auto& windows = scratch.windows;
+        auto& stack = scratch.stack;
+
+        windows.clear();
+        windows.push_back(root);
+        stack.emplace_back(&info_for(root), 0);
+
+        while (!stack.empty())
+        {
+            auto& top = stack.back();
+            auto const& children = top.first->children();
+
+            if (top.second == children.size())
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            auto const& child = children[top.second++];
+            windows.push_back(child);
+            stack.emplace_back(&info_for(child), 0);
+        }
+
+        return windows;
+    }
+
+    /// Collects the tree containing window in the order raising window stacks it: from the
+    /// topmost ancestor down, but with window and each of its ancestors after their siblings.
+    /// \return the topmost ancestor of window and its descendants
+    template<typename InfoFor>
+    auto collect_raising(Window const& window, InfoFor const& info_for) -> std::vector<Window> const&
+    {
+        auto& windows = scratch.windows;
+        auto& stack = scratch.stack;
+        auto& branch = scratch.branch;
+
+        branch.clear();
+        for (auto w = window; w; w = info_for(w).parent())
+            branch.push_back(w);
+        std::reverse(branch.begin(), branch.end());
+
+        windows.clear();
+        windows.push_back(branch.front());
+        stack.emplace_back(&info_for(branch.front()), 0);
+
+        while (!stack.empty())
+        {
+            auto const depth = stack.size();
+            auto& top = stack.back();
+            auto const& children = top.first->children();
+
+            // The next window on the branch (if top is on it) is left until last
+            auto const on_branch = depth < branch.size() && top.first->window() == branch[depth-1];
+
+            if (on_branch && top.second < children.size() && children[top.second] == branch[depth])
+                ++top.second;
+
+            if (top.second < children.size())
+            {
+                auto const& child = children[top.second++];
+                windows.push_back(child);
+                stack.emplace_back(&info_for(child), 0);
+            }
+            else if (on_branch && top.second == children.size())
+            {
+                ++top.second;
+                windows.push_back(branch[depth]);
+                stack.emplace_back(&info_for(branch[depth]), 0);
+            }
+            else
+            {
+                stack.pop_back();
+            }
+        }
+
+        return windows;
+    }
+
+    /// Empty storage for the caller to gather some of the windows walked (e.g. those changed)
+    auto selected() -> std::vector<Window>& { scratch.selected.clear(); return scratch.selected; }
+
+    /// \return the topmost ancestor of window down to window (after collect_raising())
+    auto raising_branch() const -> std::vector<Window> const& { return scratch.branch; }
+
+private:
+    WindowTreeScratch& owner;
+    WindowTreeScratch scratch;
+};
+}
+
+#endif //MIRAL_WINDOW_TREE_WALKER_H
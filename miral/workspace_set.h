@@ -0,0 +1,107 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#ifndef MIRAL_WORKSPACE_SET_H
+#define MIRAL_WORKSPACE_SET_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace miral
+{
+/// A set of workspace ids, kept as a bitset so that testing whether two windows share
+/// a workspace is a bitwise AND. Ids are small integers reused as workspaces die, so
+/// the first word covers all realistic setups and the rest is only allocated if needed.
+class WorkspaceSet
+{
+public:
+    void insert(unsigned id)
+    {
+        if (id < bits_per_word)
+        {
+            low |= bit(id);
+        }
+        else
+        {
+            auto const word = id/bits_per_word - 1;
+            if (word >= high.size())
+                high.resize(word + 1);
+            high[word] |= bit(id%bits_per_word);
+        }
+    }
+
+    void erase(unsigned id)
+    {
+        if (id < bits_per_word)
+        {
+            low &= ~bit(id);
+        }
+        else
+        {
+            auto const word = id/bits_per_word - 1;
+            if (word < high.size())
+                high[word] &= ~bit(id%bits_per_word);
+        }
+    }
+
+    bool contains(unsigned id) const
+    {
+        if (id < bits_per_word)
+            return low & bit(id);
+
+        auto const word = id/bits_per_word - 1;
+        return word < high.size() && (high[word] & bit(id%bits_per_word));
+    }
+
+    bool intersects(WorkspaceSet const& other) const
+    {
+        if (low & other.low)
+            return true;
+
+        auto const words = std::min(high.size(), other.high.size());
+        for (std::size_t word = 0; word != words; ++word)
+        {
+            if (high[word] & other.high[word])
+                return true;
+        }
+
+        return false;
+    }
+
+    bool empty() const
+    {
+        return !low && std::all_of(high.begin(), high.end(), [](std::uint64_t word) { return !word; });
+    }
+
+    void clear()
+    {
+        low = 0;
+        high.clear();
+    }
+
+private:
+    static unsigned const bits_per_word = 64;
+    static auto bit(unsigned index) -> std::uint64_t { return std::uint64_t{1} << index; }
+
+    std::uint64_t low = 0;
+    std::vector<std::uint64_t> high;
+};
+}
+
+#endif //MIRAL_WORKSPACE_SET_H
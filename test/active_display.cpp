@@ -0,0 +1,224 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <mir/events/event_builders.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const left_display{{0, 0}, {640, 480}};
+Rectangle const right_display{{640, 0}, {640, 480}};
+
+// Unlike StubFocusController, remembers the focus (and counts the queries)
+struct FocusTrackingController : StubFocusController
+{
+    void set_focus_to(
+        std::shared_ptr<mir::scene::Session> const& /*focus_session*/,
+        std::shared_ptr<mir::scene::Surface> const& focus_surface) override { focus = focus_surface; }
+
+    auto focused_surface() const -> std::shared_ptr<mir::scene::Surface> override
+        { ++focused_surface_queries; return focus.lock(); }
+
+    std::weak_ptr<mir::scene::Surface> focus;
+    int mutable focused_surface_queries{0};
+};
+
+struct ActiveDisplay : TestWindowManagerToolsWith<FocusTrackingController>
+{
+    Window window;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](WindowInfo const& window_info){ window = window_info.window(); }));
+    }
+
+    auto add_window(Rectangle const& rect) -> Window
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.size = rect.size;
+
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+        move(window, rect.top_left);
+        return window;
+    }
+
+    void move(Window const& window, Point top_left)
+    {
+        WindowSpecification modifications;
+        modifications.top_left() = top_left;
+        window_manager_tools.modify_window(window, modifications);
+    }
+
+    void move_cursor_to(Point point)
+    {
+        auto const event = mir::events::make_event(
+            MirInputDeviceId{1}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, 0, point.x.as_int(), point.y.as_int(), 0, 0, 0, 0);
+
+        basic_window_manager.handle_pointer_event(
+            mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+    }
+};
+}
+
+TEST_F(ActiveDisplay, is_the_display_with_most_of_the_focused_window)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+
+    auto const window = add_window({{600, 100}, {200, 200}});
+    basic_window_manager.select_active_window(window);
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+
+    move(window, {500, 100});
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(left_display));
+}
+
+TEST_F(ActiveDisplay, is_not_recalculated_while_nothing_changes)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+
+    auto const window = add_window({{700, 100}, {200, 200}});
+    basic_window_manager.select_active_window(window);
+
+    window_manager_tools.active_display();
+    auto const queries = focus_controller.focused_surface_queries;
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+    EXPECT_THAT(focus_controller.focused_surface_queries, Eq(queries));
+}
+
+TEST_F(ActiveDisplay, follows_display_changes)
+{
+    basic_window_manager.add_display(left_display);
+
+    auto const window = add_window({{700, 100}, {200, 200}});
+    basic_window_manager.select_active_window(window);
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(left_display));
+
+    basic_window_manager.add_display(right_display);
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+}
+
+TEST_F(ActiveDisplay, after_focus_is_lost_is_the_display_of_the_last_focused_window)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+    move_cursor_to({100, 100});
+
+    auto const window = add_window({{700, 100}, {200, 200}});
+    basic_window_manager.select_active_window(window);
+    window_manager_tools.active_display();
+
+    basic_window_manager.select_active_window({});
+    ASSERT_FALSE(focus_controller.focused_surface());
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+}
+
+TEST_F(ActiveDisplay, after_focus_is_lost_is_the_display_of_the_last_focused_window_even_if_not_queried)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+    move_cursor_to({700, 100});
+
+    auto const first = add_window({{700, 100}, {200, 200}});
+    auto const second = add_window({{100, 100}, {200, 200}});
+    basic_window_manager.select_active_window(first);
+    basic_window_manager.select_active_window(second);
+
+    basic_window_manager.select_active_window({});
+    ASSERT_FALSE(focus_controller.focused_surface());
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(left_display));
+}
+
+TEST_F(ActiveDisplay, without_focus_or_a_previously_focused_window_is_the_display_with_the_cursor)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+    move_cursor_to({700, 100});
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+
+    move_cursor_to({100, 100});
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(left_display));
+}
+
+TEST_F(ActiveDisplay, otherwise_is_the_display_at_the_origin)
+{
+    basic_window_manager.add_display(right_display);
+    basic_window_manager.add_display(left_display);
+    move_cursor_to({-100, -100});
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(left_display));
+}
+
+TEST_F(ActiveDisplay, is_the_display_with_the_cursor_once_the_cursor_moves_onto_one)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+    move_cursor_to({-100, -100});
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(left_display));
+
+    move_cursor_to({700, 100});
+
+    EXPECT_THAT(window_manager_tools.active_display(), Eq(right_display));
+}
+
+TEST_F(ActiveDisplay, can_be_queried_concurrently_under_shared_lock)
+{
+    basic_window_manager.add_display(left_display);
+    basic_window_manager.add_display(right_display);
+    move_cursor_to({700, 100});
+
+    std::vector<std::thread> readers;
+    std::atomic<int> wrong{0};
+
+    for (auto i = 0; i != 4; ++i)
+        readers.emplace_back([&]
+            {
+                for (auto j = 0; j != 1000; ++j)
+                    window_manager_tools.invoke_under_shared_lock([&]
+                        { if (window_manager_tools.active_display() != right_display) ++wrong; });
+            });
+
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_THAT(wrong, Eq(0));
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_server.h"
+#include "../miral/latency_histogram.h"
+
+#include <mir/client/window.h>
+#include <mir/client/window_spec.h>
+#include <mir_toolkit/mir_buffer_stream.h>
+
+#include <miral/application.h>
+#include <miral/window_info.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <thread>
+
+using namespace testing;
+using namespace mir::client;
+using namespace std::chrono_literals;
+using miral::LatencyHistogram;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+auto environment_or(char const* name, int default_value) -> int
+{
+    auto const value = getenv(name);
+    return value ? atoi(value) : default_value;
+}
+
+void report(char const* what, LatencyHistogram const& histogram)
+{
+    auto const as_ms = [](std::chrono::nanoseconds duration) { return duration.count()/1000000.0; };
+
+    std::cout << what << ": count=" << histogram.calls()
+              << ", median=" << as_ms(histogram.percentile(0.5)) << "ms"
+              << ", p90=" << as_ms(histogram.percentile(0.9)) << "ms"
+              << ", p99=" << as_ms(histogram.percentile(0.99)) << "ms"
+              << ", max=" << as_ms(histogram.max()) << "ms" << std::endl;
+}
+
+// Many clients connect at once (as they do when a kiosk reboots) each creating
+// several windows, each with a dialog and a menu. The sizes can be set with
+// MIRAL_STORM_CLIENTS and MIRAL_STORM_WINDOWS.
+struct ConnectionStorm : miral::TestServer
+{
+    int const clients = environment_or("MIRAL_STORM_CLIENTS", 200);
+    int const windows_per_client = environment_or("MIRAL_STORM_WINDOWS", 3);
+
+    LatencyHistogram connect_latency;
+    LatencyHistogram first_ready_latency;
+    LatencyHistogram teardown_latency;
+    std::atomic<int> missing_buffer_streams{0};
+
+    struct StormPolicy : TestWindowManagerPolicy
+    {
+        StormPolicy(miral::WindowManagerTools const& tools, ConnectionStorm& storm) :
+            TestWindowManagerPolicy{tools, storm}, storm{storm} {}
+
+        void handle_window_ready(miral::WindowInfo& window_info) override
+        {
+            TestWindowManagerPolicy::handle_window_ready(window_info);
+            storm.window_ready(miral::name_of(window_info.window().application()));
+        }
+
+        ConnectionStorm& storm;
+    };
+
+    auto build_window_manager_policy(miral::WindowManagerTools const& tools)
+    -> std::unique_ptr<TestWindowManagerPolicy> override
+    {
+        return std::make_unique<StormPolicy>(tools, *this);
+    }
+
+    void window_ready(std::string const& client)
+    {
+        auto const now = Clock::now();
+        std::lock_guard<std::mutex> lock{ready_mutex};
+        first_ready.emplace(client, now);
+        ready.notify_all();
+    }
+
+    auto wait_for_first_ready(std::string const& client) -> Clock::time_point
+    {
+        std::unique_lock<std::mutex> lock{ready_mutex};
+        ready.wait_for(lock, 20s, [&]{ return first_ready.count(client) != 0; });
+
+        auto const i = first_ready.find(client);
+        return i != first_ready.end() ? i->second : Clock::time_point{};
+    }
+
+    void post_buffer(Window const& window)
+    {
+        // DecorationProvider has seen null buffer streams with many clients at once
+        if (auto const buffer_stream = mir_window_get_buffer_stream(window))
+            mir_buffer_stream_swap_buffers_sync(buffer_stream);
+        else
+            ++missing_buffer_streams;
+    }
+
+    void run_client(int index)
+    {
+        auto const client = "storm client " + std::to_string(index);
+
+        auto const start = Clock::now();
+        auto connection = connect_client(client);
+        connect_latency.record(Clock::now() - start);
+
+        std::vector<Window> windows;
+
+        for (auto i = 0; i != windows_per_client; ++i)
+        {
+            Window const parent{WindowSpec::for_normal_window(connection, 50, 50, mir_pixel_format_argb_8888)
+                .set_buffer_usage(mir_buffer_usage_software)
+                .set_name(client.c_str())
+                .create_window()};
+            post_buffer(parent);
+
+            Window const dialog{WindowSpec::for_dialog(connection, 40, 40, mir_pixel_format_argb_8888, parent)
+                .set_buffer_usage(mir_buffer_usage_software)
+                .set_name(client.c_str())
+                .create_window()};
+            post_buffer(dialog);
+
+            MirRectangle aux_rect{10, 10, 10, 10};
+            Window const menu{WindowSpec::for_menu(connection, 30, 30, mir_pixel_format_argb_8888, parent, &aux_rect, mir_edge_attachment_any)
+                .set_buffer_usage(mir_buffer_usage_software)
+                .set_name(client.c_str())
+                .create_window()};
+            post_buffer(menu);
+
+            windows.push_back(parent);
+            windows.push_back(dialog);
+            windows.push_back(menu);
+        }
+
+        auto const ready_at = wait_for_first_ready(client);
+        EXPECT_TRUE(ready_at != Clock::time_point{}) << client << " has no window ready";
+        if (ready_at != Clock::time_point{})
+            first_ready_latency.record(ready_at - start);
+
+        // Children go before their parents
+        auto const teardown_start = Clock::now();
+        while (!windows.empty())
+            windows.pop_back();
+        connection.reset();
+        teardown_latency.record(Clock::now() - teardown_start);
+    }
+
+private:
+    std::mutex ready_mutex;
+    std::condition_variable ready;
+    std::map<std::string, Clock::time_point> first_ready;
+};
+}
+
+TEST_F(ConnectionStorm, clients_connecting_at_once)
+{
+    std::vector<std::thread> threads;
+
+    for (auto i = 0; i != clients; ++i)
+        threads.emplace_back([this, i] { run_client(i); });
+
+    for (auto& thread : threads)
+        thread.join();
+
+    report("connect", connect_latency);
+    report("first window ready", first_ready_latency);
+    report("teardown", teardown_latency);
+    std::cout << "windows without a buffer stream: " << missing_buffer_streams.load() << std::endl;
+
+    EXPECT_THAT(connect_latency.calls(), Eq(static_cast<uint64_t>(clients)));
+    EXPECT_THAT(missing_buffer_streams.load(), Eq(0));
+}
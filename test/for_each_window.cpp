@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+struct ForEachWindow : TestWindowManagerTools
+{
+    std::vector<Window> windows;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+    }
+
+    void create_windows(int count)
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.size = Size{100, 100};
+
+        for (auto i = 0; i != count; ++i)
+            basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+    }
+};
+}
+
+TEST_F(ForEachWindow, visits_every_window)
+{
+    create_windows(5);
+
+    std::vector<Window> seen;
+    window_manager_tools.for_each_window([&](WindowInfo& info) { seen.push_back(info.window()); });
+
+    EXPECT_THAT(seen, UnorderedElementsAreArray(windows));
+}
+
+TEST_F(ForEachWindow, does_not_visit_removed_windows)
+{
+    create_windows(3);
+
+    basic_window_manager.remove_surface(session, windows[1]);
+
+    std::vector<Window> seen;
+    window_manager_tools.for_each_window([&](WindowInfo& info) { seen.push_back(info.window()); });
+
+    EXPECT_THAT(seen, UnorderedElementsAre(windows[0], windows[2]));
+}
+
+TEST_F(ForEachWindow, removed_window_has_no_info_even_when_its_slot_is_reused)
+{
+    create_windows(2);
+
+    auto const removed = windows[0];
+    basic_window_manager.remove_surface(session, removed);
+    create_windows(1);
+
+    EXPECT_THROW(window_manager_tools.info_for(removed), std::out_of_range);
+    EXPECT_THAT(window_manager_tools.info_for(windows[2]).window(), Eq(windows[2]));
+}
+
+TEST_F(ForEachWindow, info_for_a_window_matches_info_for_its_surface)
+{
+    create_windows(3);
+
+    for (auto const& window : windows)
+    {
+        EXPECT_THAT(&window_manager_tools.info_for(window),
+                    Eq(&window_manager_tools.info_for(std::weak_ptr<mir::scene::Surface>(window))));
+    }
+}
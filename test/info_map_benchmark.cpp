@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/weak_ptr_hash_map.h"
+
+#include <mir/test/doubles/stub_surface.h>
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <random>
+
+namespace
+{
+using Surface = mir::scene::Surface;
+using StubSurface = mir::test::doubles::StubSurface;
+
+struct Info { int value; };
+
+using OwnerLessMap = std::map<std::weak_ptr<Surface>, Info, std::owner_less<std::weak_ptr<Surface>>>;
+using HashMap = miral::WeakPtrHashMap<Surface, Info>;
+
+// The lookups the window manager does: by weak_ptr, in no particular order
+struct Fixture
+{
+    explicit Fixture(int count)
+    {
+        for (auto i = 0; i != count; ++i)
+            surfaces.push_back(std::make_shared<StubSurface>());
+
+        for (auto const& surface : surfaces)
+            keys.push_back(surface);
+
+        std::shuffle(begin(keys), end(keys), std::default_random_engine{});
+    }
+
+    std::vector<std::shared_ptr<Surface>> surfaces;
+    std::vector<std::weak_ptr<Surface>> keys;
+};
+
+template<typename Map>
+void info_for(benchmark::State& state)
+{
+    Fixture const fixture(state.range(0));
+
+    Map map;
+    for (auto i = 0u; i != fixture.surfaces.size(); ++i)
+        map.emplace(fixture.surfaces[i], Info{int(i)});
+
+    auto key = fixture.keys.begin();
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(map.at(*key).value);
+
+        if (++key == fixture.keys.end())
+            key = fixture.keys.begin();
+    }
+}
+
+template<typename Map>
+void add_and_remove(benchmark::State& state)
+{
+    Fixture const fixture(state.range(0));
+
+    for (auto _ : state)
+    {
+        Map map;
+        for (auto i = 0u; i != fixture.surfaces.size(); ++i)
+            map.emplace(fixture.surfaces[i], Info{int(i)});
+
+        for (auto const& key : fixture.keys)
+            map.erase(key);
+    }
+
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+}
+
+BENCHMARK_TEMPLATE(info_for, OwnerLessMap)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(info_for, HashMap)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(add_and_remove, OwnerLessMap)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK_TEMPLATE(add_and_remove, HashMap)->Arg(10)->Arg(1000)->Arg(10000);
@@ -0,0 +1,102 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/lock_timing.h"
+
+#include "test_window_manager_tools.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using miral::LockEntry;
+using miral::LockTiming;
+using std::chrono::milliseconds;
+using namespace testing;
+
+namespace
+{
+auto entry_points_in(std::vector<miral::LockLatency> const& latencies) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    for (auto const& latency : latencies)
+        result.push_back(latency.entry_point);
+    return result;
+}
+
+struct LockTimingTest : TestWindowManagerTools
+{
+    std::shared_ptr<LockTiming> const timing = std::make_shared<LockTiming>();
+};
+}
+
+TEST(LockTiming, only_entry_points_that_took_the_lock_are_reported)
+{
+    LockTiming timing;
+
+    timing.wait(LockEntry::remove_surface).record(milliseconds{1});
+    timing.hold(LockEntry::remove_surface).record(milliseconds{2});
+
+    auto const latencies = timing.latencies();
+
+    ASSERT_THAT(entry_points_in(latencies), ElementsAre("remove_surface"));
+    EXPECT_THAT(latencies[0].acquisitions, Eq(1u));
+    EXPECT_THAT(latencies[0].wait_max, Eq(milliseconds{1}));
+    EXPECT_THAT(latencies[0].hold_max, Eq(milliseconds{2}));
+}
+
+TEST_F(LockTimingTest, the_lock_is_not_timed_by_default)
+{
+    basic_window_manager.add_session(session);
+
+    EXPECT_THAT(window_manager_tools.lock_latencies(), IsEmpty());
+}
+
+TEST_F(LockTimingTest, entry_points_taking_the_lock_are_timed)
+{
+    basic_window_manager.time_lock(timing);
+    basic_window_manager.add_session(session);
+
+    auto const latencies = window_manager_tools.lock_latencies();
+
+    ASSERT_THAT(entry_points_in(latencies), ElementsAre("add_session"));
+    EXPECT_THAT(latencies[0].acquisitions, Eq(1u));
+}
+
+TEST_F(LockTimingTest, invoking_under_the_locks_is_timed)
+{
+    basic_window_manager.time_lock(timing);
+    window_manager_tools.invoke_under_lock([]{});
+    window_manager_tools.invoke_under_shared_lock([]{});
+
+    EXPECT_THAT(entry_points_in(window_manager_tools.lock_latencies()),
+        ElementsAre("invoke_under_lock", "invoke_under_shared_lock"));
+}
+
+TEST_F(LockTimingTest, the_hold_time_includes_the_work_done_under_the_lock)
+{
+    basic_window_manager.time_lock(timing);
+    window_manager_tools.invoke_under_lock([]{ std::this_thread::sleep_for(milliseconds{5}); });
+
+    auto const latencies = window_manager_tools.lock_latencies();
+
+    ASSERT_THAT(latencies.size(), Eq(1u));
+    EXPECT_THAT(latencies[0].hold_max, Ge(milliseconds{5}));
+    EXPECT_THAT(latencies[0].hold_total, Ge(milliseconds{5}));
+}
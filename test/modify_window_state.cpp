@@ -90,6 +90,27 @@ TEST_P(ForNormalSurface, state)
     EXPECT_THAT(info.state(), Eq(original_state));
     EXPECT_TRUE(info.is_visible());
 }
+
+using ForActiveSurface = ModifyWindowState;
+
+TEST_P(ForActiveSurface, hiding_makes_previous_window_active)
+{
+    auto const new_state = MirWindowState(GetParam());
+
+    create_window_of_type(mir_window_type_normal);
+    auto const first = window;
+    create_window_of_type(mir_window_type_normal);
+    ASSERT_THAT(window_manager_tools.active_window(), Eq(window));
+
+    // The canonical policy raises the window that gains focus
+    EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(first)));
+
+    WindowSpecification mods;
+    mods.state() = new_state;
+    window_manager_tools.modify_window(window, mods);
+
+    EXPECT_THAT(window_manager_tools.active_window(), Eq(first)) << "State is " << new_state;
+}
 }
 
 INSTANTIATE_TEST_CASE_P(ModifyWindowState, ForNormalSurface, ::testing::Values(
@@ -103,3 +124,8 @@ INSTANTIATE_TEST_CASE_P(ModifyWindowState, ForNormalSurface, ::testing::Values(
     mir_window_state_hidden
 //    mir_window_states
 ));
+
+INSTANTIATE_TEST_CASE_P(ModifyWindowState, ForActiveSurface, ::testing::Values(
+    mir_window_state_minimized,
+    mir_window_state_hidden
+));
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <map>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+struct ModifyWindows : TestWindowManagerTools
+{
+    std::vector<Window> windows;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+
+        for (auto i = 0; i != 3; ++i)
+        {
+            mir::scene::SurfaceCreationParameters creation_parameters;
+            creation_parameters.type = mir_window_type_normal;
+            creation_parameters.size = Size{100, 100};
+
+            basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+            basic_window_manager.select_active_window(windows.back());
+        }
+    }
+
+    auto hide(Window const& window) -> std::pair<Window, WindowSpecification>
+    {
+        WindowSpecification modifications;
+        modifications.state() = mir_window_state_hidden;
+        return {window, modifications};
+    }
+};
+}
+
+TEST_F(ModifyWindows, applies_modifications_to_each_window)
+{
+    WindowSpecification move_first;
+    move_first.top_left() = Point{10, 10};
+
+    WindowSpecification resize_second;
+    resize_second.size() = Size{50, 60};
+
+    window_manager_tools.modify_windows({{windows[0], move_first}, {windows[1], resize_second}});
+
+    EXPECT_THAT(windows[0].top_left(), Eq(Point{10, 10}));
+    EXPECT_THAT(windows[1].size(), Eq(Size{50, 60}));
+}
+
+TEST_F(ModifyWindows, if_any_modification_is_invalid_none_are_applied)
+{
+    auto const original_position = windows[0].top_left();
+
+    WindowSpecification move_first;
+    move_first.top_left() = original_position + Displacement{10, 10};
+
+    WindowSpecification invalid;
+    invalid.type() = mir_window_type_tip;
+
+    EXPECT_THROW(window_manager_tools.modify_windows({{windows[0], move_first}, {windows[1], invalid}}),
+                 std::runtime_error);
+
+    EXPECT_THAT(windows[0].top_left(), Eq(original_position));
+    EXPECT_THAT(window_manager_tools.info_for(windows[1]).type(), Eq(mir_window_type_normal));
+}
+
+TEST_F(ModifyWindows, hiding_the_active_window_activates_another)
+{
+    ASSERT_THAT(window_manager_tools.active_window(), Eq(windows[2]));
+
+    window_manager_tools.modify_window(windows[2], hide(windows[2]).second);
+
+    EXPECT_THAT(window_manager_tools.active_window(), Eq(windows[1]));
+}
+
+TEST_F(ModifyWindows, hiding_several_windows_activates_a_new_window_once)
+{
+    ASSERT_THAT(window_manager_tools.active_window(), Eq(windows[2]));
+
+    // The policy raises each window that gains focus
+    EXPECT_CALL(*window_manager_policy, advise_raise(_)).Times(0);
+    EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(windows[0]))).Times(1);
+
+    window_manager_tools.modify_windows({hide(windows[2]), hide(windows[1])});
+
+    EXPECT_THAT(window_manager_tools.active_window(), Eq(windows[0]));
+}
+
+TEST_F(ModifyWindows, hiding_then_restoring_the_active_window_leaves_it_active)
+{
+    WindowSpecification restore;
+    restore.state() = mir_window_state_restored;
+
+    window_manager_tools.modify_windows({hide(windows[2]), {windows[2], restore}});
+
+    EXPECT_THAT(window_manager_tools.active_window(), Eq(windows[2]));
+}
+
+TEST_F(ModifyWindows, showing_several_windows_with_none_active_activates_the_first_once)
+{
+    window_manager_tools.modify_windows({hide(windows[2]), hide(windows[1]), hide(windows[0])});
+    ASSERT_THAT(window_manager_tools.active_window(), Eq(Window{}));
+
+    WindowSpecification restore;
+    restore.state() = mir_window_state_restored;
+
+    // The policy raises each window that gains focus
+    EXPECT_CALL(*window_manager_policy, advise_raise(_)).Times(0);
+    EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(windows[1]))).Times(1);
+
+    window_manager_tools.modify_windows({{windows[1], restore}, {windows[0], restore}, {windows[2], restore}});
+
+    EXPECT_THAT(window_manager_tools.active_window(), Eq(windows[1]));
+}
+
+TEST_F(ModifyWindows, each_window_changed_is_advised_once_after_all_are_modified)
+{
+    WindowSpecification move;
+    move.top_left() = Point{10, 10};
+
+    WindowSpecification resize;
+    resize.size() = Size{50, 60};
+
+    std::map<Window, WindowChanges> advised;
+
+    EXPECT_CALL(*window_manager_policy, advise_window_changed(_, _)).Times(2)
+        .WillRepeatedly(Invoke([&](WindowInfo const& info, WindowChanges const& changes)
+            {
+                EXPECT_THAT(windows[0].size(), Eq(Size{50, 60}));
+                EXPECT_THAT(windows[1].top_left(), Eq(Point{10, 10}));
+                advised[info.window()] = changes;
+            }));
+
+    window_manager_tools.modify_windows({{windows[0], move}, {windows[1], move}, {windows[0], resize}});
+
+    EXPECT_TRUE(advised[windows[0]].contains(WindowChange::top_left));
+    EXPECT_TRUE(advised[windows[0]].contains(WindowChange::size));
+    EXPECT_TRUE(advised[windows[1]].contains(WindowChange::top_left));
+}
+
+TEST_F(ModifyWindows, when_a_modification_throws_those_already_made_are_finished_and_advised)
+{
+    ASSERT_THAT(window_manager_tools.active_window(), Eq(windows[2]));
+
+    WindowSpecification move;
+    move.top_left() = Point{10, 10};
+
+    EXPECT_CALL(*window_manager_policy, advise_move_to(_, _))
+        .WillOnce(Throw(std::runtime_error{"policy failed"}));
+
+    WindowChanges advised;
+    EXPECT_CALL(*window_manager_policy, advise_window_changed(_, _))
+        .WillOnce(Invoke([&](WindowInfo const& info, WindowChanges const& changes)
+            {
+                EXPECT_THAT(info.window(), Eq(windows[2]));
+                advised = changes;
+            }));
+
+    EXPECT_THROW(window_manager_tools.modify_windows({hide(windows[2]), {windows[1], move}}), std::runtime_error);
+
+    EXPECT_THAT(window_manager_tools.active_window(), Eq(windows[1]));
+    EXPECT_TRUE(advised.contains(WindowChange::state));
+}
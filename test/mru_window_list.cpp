@@ -28,12 +28,7 @@ using namespace testing;
 
 namespace
 {
-struct StubSurface : mir::test::doubles::StubSurface
-{
-    bool visible() const override { return visible_; }
-
-    bool visible_ = true;
-};
+using mir::test::doubles::StubSurface;
 
 struct StubSession : mir::test::doubles::StubSession
 {
@@ -59,25 +54,22 @@ MATCHER(IsNullWindow, std::string("is not null"))
 
 struct MRUWindowList : testing::Test
 {
-    static auto const window_a_id = 0;
-    static auto const window_b_id = 1;
-
     miral::MRUWindowList mru_list;
 
     std::shared_ptr<StubSession> const stub_session{std::make_shared<StubSession>(3)};
     miral::Application app{stub_session};
-    miral::Window window_a{app, stub_session->surface(mir::frontend::SurfaceId{window_a_id})};
-    miral::Window window_b{app, stub_session->surface(mir::frontend::SurfaceId{window_b_id})};
+    miral::Window window_a{app, stub_session->surface(mir::frontend::SurfaceId{0})};
+    miral::Window window_b{app, stub_session->surface(mir::frontend::SurfaceId{1})};
     miral::Window window_c{app, stub_session->surface(mir::frontend::SurfaceId{2})};
 
-    void hide_window(int window_id)
+    void hide_window(miral::Window const& window)
     {
-        stub_session->surfaces[window_id]->visible_ = false;
+        mru_list.set_visible(window, false);
     }
 
-    void show_window(int window_id)
+    void show_window(miral::Window const& window)
     {
-        stub_session->surfaces[window_id]->visible_ = true;
+        mru_list.set_visible(window, true);
     }
 };
 
@@ -165,7 +157,7 @@ TEST_F(MRUWindowList, a_hidden_window_is_not_enumerated)
 
     int count{0};
 
-    hide_window(window_a_id);
+    hide_window(window_a);
     mru_list.enumerate([&](miral::Window& window)
        { if (window == window_a) ++count; return true; });
 
@@ -178,10 +170,10 @@ TEST_F(MRUWindowList, hiding_then_showing_windows_retains_order)
     mru_list.push(window_b);
     mru_list.push(window_c);
 
-    hide_window(window_a_id);
-    hide_window(window_b_id);
-    show_window(window_a_id);
-    show_window(window_b_id);
+    hide_window(window_a);
+    hide_window(window_b);
+    show_window(window_a);
+    show_window(window_b);
 
     std::vector<miral::Window> as_enumerated;
 
@@ -191,3 +183,49 @@ TEST_F(MRUWindowList, hiding_then_showing_windows_retains_order)
     EXPECT_THAT(as_enumerated, ElementsAre(window_c, window_b, window_a));
 }
 
+TEST_F(MRUWindowList, a_hidden_window_is_not_top)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+
+    hide_window(window_b);
+
+    EXPECT_THAT(mru_list.top(), Eq(window_a));
+}
+
+TEST_F(MRUWindowList, pushing_a_hidden_window_shows_it)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+
+    hide_window(window_a);
+    mru_list.push(window_a);
+
+    EXPECT_THAT(mru_list.top(), Eq(window_a));
+}
+
+TEST_F(MRUWindowList, iteration_skips_hidden_windows)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    mru_list.push(window_c);
+
+    hide_window(window_c);
+    hide_window(window_a);
+
+    std::vector<miral::Window> const as_iterated{mru_list.begin(), mru_list.end()};
+
+    EXPECT_THAT(as_iterated, ElementsAre(window_b));
+}
+
+TEST_F(MRUWindowList, an_erased_window_can_be_pushed_again)
+{
+    mru_list.push(window_a);
+    mru_list.push(window_b);
+    mru_list.erase(window_a);
+    mru_list.push(window_a);
+
+    std::vector<miral::Window> const as_iterated{mru_list.begin(), mru_list.end()};
+
+    EXPECT_THAT(as_iterated, ElementsAre(window_a, window_b));
+}
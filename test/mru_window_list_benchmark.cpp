@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/mru_window_list.h"
+
+#include <mir/test/doubles/stub_surface.h>
+#include <mir/test/doubles/stub_session.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+struct Fixture
+{
+    explicit Fixture(int count) : app{std::make_shared<mir::test::doubles::StubSession>()}
+    {
+        for (auto i = 0; i != count; ++i)
+        {
+            surfaces.push_back(std::make_shared<mir::test::doubles::StubSurface>());
+            windows.emplace_back(app, surfaces.back());
+        }
+
+        for (auto const& window : windows)
+            mru_list.push(window);
+
+        shuffled = windows;
+        std::shuffle(begin(shuffled), end(shuffled), std::default_random_engine{});
+    }
+
+    miral::Application const app;
+    std::vector<std::shared_ptr<mir::scene::Surface>> surfaces;
+    std::vector<miral::Window> windows;
+    std::vector<miral::Window> shuffled;
+    miral::MRUWindowList mru_list;
+};
+
+// What focusing a window does
+void push(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto window = fixture.shuffled.begin();
+
+    for (auto _ : state)
+    {
+        fixture.mru_list.push(*window);
+
+        if (++window == fixture.shuffled.end())
+            window = fixture.shuffled.begin();
+    }
+}
+
+// What opening and closing windows does
+void erase_and_push(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto window = fixture.shuffled.begin();
+
+    for (auto _ : state)
+    {
+        fixture.mru_list.erase(*window);
+        fixture.mru_list.push(*window);
+
+        if (++window == fixture.shuffled.end())
+            window = fixture.shuffled.begin();
+    }
+}
+
+// What refocusing after minimizing does when most recent windows are minimized
+void top_with_most_hidden(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+
+    for (auto i = 1u; i < fixture.windows.size(); ++i)
+        fixture.mru_list.set_visible(fixture.windows[i], false);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fixture.mru_list.top());
+}
+}
+
+BENCHMARK(push)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK(erase_and_push)->Arg(10)->Arg(1000)->Arg(10000);
+BENCHMARK(top_with_most_hidden)->Arg(10)->Arg(1000)->Arg(10000);
@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral-shell/pixels/pixels.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// A buffer with padding at the end of each row (which must not be painted)
+struct Buffer
+{
+    static uint32_t const padding = 0xdeadbeef;
+
+    Buffer(int width, int height) :
+        pixels(height*(width + 3), padding),
+        region{width, height, 4*(width + 3), mir_pixel_format_xrgb_8888, reinterpret_cast<char*>(pixels.data())}
+    {
+    }
+
+    auto at(int x, int y) const -> uint32_t { return pixels[y*(region.width + 3) + x]; }
+
+    std::vector<uint32_t> pixels;
+    MirGraphicsRegion const region;
+};
+
+uint32_t const Buffer::padding;
+
+// The expected blend, worked out a channel at a time
+auto blended(unsigned coverage, uint32_t foreground, uint32_t background) -> uint32_t
+{
+    uint32_t result = 0;
+
+    for (auto shift = 0; shift != 32; shift += 8)
+    {
+        auto const fg = (foreground >> shift) & 0xff;
+        auto const bg = (background >> shift) & 0xff;
+        result |= ((bg*(0xff - coverage) + fg*coverage)/0xff) << shift;
+    }
+
+    return result;
+}
+
+// Widths on either side of the 4 and 8 pixel vector widths
+struct Pixels : TestWithParam<int> {};
+}
+
+TEST(Pixels, pixel_values_follow_the_format)
+{
+    EXPECT_THAT(pixels::pixel(mir_pixel_format_argb_8888, 0x11, 0x22, 0x33, 0x44), Eq(0x44112233u));
+    EXPECT_THAT(pixels::pixel(mir_pixel_format_xrgb_8888, 0x11, 0x22, 0x33, 0x44), Eq(0xff112233u));
+    EXPECT_THAT(pixels::pixel(mir_pixel_format_abgr_8888, 0x11, 0x22, 0x33, 0x44), Eq(0x44332211u));
+    EXPECT_THAT(pixels::pixel(mir_pixel_format_xbgr_8888, 0x11, 0x22, 0x33, 0x44), Eq(0xff332211u));
+
+    EXPECT_THROW(pixels::pixel(mir_pixel_format_rgb_565, 0x11, 0x22, 0x33), std::invalid_argument);
+}
+
+TEST_P(Pixels, fill_sets_every_pixel_and_nothing_else)
+{
+    auto const width = GetParam();
+    Buffer buffer{width, 3};
+
+    pixels::fill(buffer.region, 0x12345678);
+
+    for (auto y = 0; y != 3; ++y)
+    {
+        for (auto x = 0; x != width; ++x)
+            ASSERT_THAT(buffer.at(x, y), Eq(0x12345678u)) << "x=" << x << ", y=" << y;
+
+        for (auto x = width; x != width + 3; ++x)
+            ASSERT_THAT(buffer.at(x, y), Eq(Buffer::padding)) << "x=" << x << ", y=" << y;
+    }
+}
+
+TEST_P(Pixels, blend_matches_a_blend_of_each_channel)
+{
+    auto const width = GetParam();
+    auto const height = 256/width + 1;
+    auto const foreground = 0xff204080u;
+    auto const background = 0x10f0c0a0u;
+
+    // Every coverage value appears (the coverage rows are wider than the region)
+    std::vector<unsigned char> coverage(height*(width + 1));
+    for (auto i = 0u; i != coverage.size(); ++i)
+        coverage[i] = i;
+
+    Buffer buffer{width, height};
+
+    pixels::blend(buffer.region, coverage.data(), width + 1, foreground, background);
+
+    for (auto y = 0; y != height; ++y)
+    {
+        for (auto x = 0; x != width; ++x)
+        {
+            auto const c = coverage[y*(width + 1) + x];
+            ASSERT_THAT(buffer.at(x, y), Eq(blended(c, foreground, background)))
+                << "x=" << x << ", y=" << y << ", coverage=" << int(c);
+        }
+
+        for (auto x = width; x != width + 3; ++x)
+            ASSERT_THAT(buffer.at(x, y), Eq(Buffer::padding)) << "x=" << x << ", y=" << y;
+    }
+}
+
+TEST(Pixels, columns_are_part_of_a_region)
+{
+    Buffer buffer{20, 2};
+
+    pixels::fill(buffer.region, 0);
+    pixels::fill(pixels::columns(buffer.region, 5, 10), 1);
+
+    for (auto x = 0; x != 20; ++x)
+        EXPECT_THAT(buffer.at(x, 1), Eq(5 <= x && x < 15 ? 1u : 0u)) << "x=" << x;
+}
+
+INSTANTIATE_TEST_CASE_P(Pixels, Pixels, Values(1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33));
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral-shell/pixels/pixels.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace
+{
+struct Buffer
+{
+    Buffer(int width, int height) :
+        pixels(width*height),
+        region{width, height, 4*width, mir_pixel_format_xrgb_8888, reinterpret_cast<char*>(pixels.data())}
+    {
+    }
+
+    std::vector<uint32_t> pixels;
+    MirGraphicsRegion const region;
+};
+
+// A 4K wallpaper
+void fill_wallpaper(benchmark::State& state)
+{
+    Buffer buffer{3840, 2160};
+
+    for (auto _ : state)
+    {
+        pixels::fill(buffer.region, 0xff202020);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations()*buffer.pixels.size()*sizeof(uint32_t));
+}
+
+// A titlebar (12 pixels high) with a title across the first 300 pixels
+void repaint_titlebar(benchmark::State& state)
+{
+    auto const width = static_cast<int>(state.range(0));
+    auto const height = 12;
+    auto const title_width = 300;
+
+    Buffer buffer{width, height};
+
+    std::vector<unsigned char> coverage(title_width*height);
+    for (auto i = 0u; i != coverage.size(); ++i)
+        coverage[i] = (i*37) & 0xff;
+
+    for (auto _ : state)
+    {
+        pixels::blend(pixels::columns(buffer.region, 0, title_width), coverage.data(), title_width, 0, 0xff3f3f3f);
+        pixels::fill(pixels::columns(buffer.region, title_width, width - title_width), 0xff3f3f3f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK(fill_wallpaper);
+BENCHMARK(repaint_titlebar)->Arg(640)->Arg(1920)->Arg(3840);
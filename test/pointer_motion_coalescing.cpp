@@ -0,0 +1,286 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <mir/events/event_builders.h>
+
+#include <condition_variable>
+#include <stdexcept>
+#include <thread>
+
+using namespace miral;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct Motion
+{
+    MirPointerAction action;
+    MirPointerButtons buttons;
+    float x, y, dx, dy;
+};
+
+auto operator==(Motion const& lhs, Motion const& rhs) -> bool
+{
+    return lhs.action == rhs.action && lhs.buttons == rhs.buttons &&
+           lhs.x == rhs.x && lhs.y == rhs.y && lhs.dx == rhs.dx && lhs.dy == rhs.dy;
+}
+
+auto operator<<(std::ostream& out, Motion const& motion) -> std::ostream&
+{
+    return out << "{action=" << motion.action << ", buttons=" << motion.buttons
+               << ", x=" << motion.x << ", y=" << motion.y << ", dx=" << motion.dx << ", dy=" << motion.dy << "}";
+}
+
+struct PointerMotionCoalescing : TestWindowManagerTools
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool holding{false};
+    bool release_holder{false};
+    std::vector<Motion> handled;
+
+    void SetUp() override
+    {
+        ON_CALL(*window_manager_policy, handle_pointer_event(_))
+            .WillByDefault(Invoke([this](MirPointerEvent const* event)
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    handled.push_back(Motion{
+                        mir_pointer_event_action(event),
+                        mir_pointer_event_buttons(event),
+                        mir_pointer_event_axis_value(event, mir_pointer_axis_x),
+                        mir_pointer_event_axis_value(event, mir_pointer_axis_y),
+                        mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x),
+                        mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y)});
+                    return true;
+                }));
+    }
+
+    bool send(MirPointerAction action, MirPointerButtons buttons, float x, float y, float dx, float dy)
+    {
+        auto const event = mir::events::make_event(
+            MirInputDeviceId{1}, std::chrono::nanoseconds{0}, std::vector<uint8_t>{}, mir_input_event_modifier_none,
+            action, buttons, x, y, 0, 0, dx, dy);
+
+        return basic_window_manager.handle_pointer_event(
+            mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+    }
+
+    bool send_motion(float x, float y, float dx, float dy)
+    {
+        return send(mir_pointer_action_motion, 0, x, y, dx, dy);
+    }
+
+    auto handled_events() -> std::vector<Motion>
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return handled;
+    }
+
+    // Holds the lock (in a writer or reader mode) on another thread until release() is called
+    auto hold_lock(void (WindowManagerTools::*invoke)(std::function<void()> const&)) -> std::thread
+    {
+        std::thread holder{[this, invoke]
+            {
+                (window_manager_tools.*invoke)([this]
+                    {
+                        std::unique_lock<std::mutex> lock{mutex};
+                        holding = true;
+                        cv.notify_all();
+                        cv.wait_for(lock, 5s, [this]{ return release_holder; });
+                    });
+            }};
+
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait_for(lock, 5s, [this]{ return holding; });
+
+        return holder;
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        release_holder = true;
+        cv.notify_all();
+    }
+};
+}
+
+TEST_F(PointerMotionCoalescing, by_default_every_motion_is_handled_while_the_lock_is_held)
+{
+    auto holder = hold_lock(&WindowManagerTools::invoke_under_lock);
+
+    std::thread sender{[this]
+        {
+            send_motion(1, 1, 1, 1);
+            send_motion(2, 2, 1, 1);
+        }};
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_THAT(handled_events(), IsEmpty());
+
+    release();
+    holder.join();
+    sender.join();
+
+    EXPECT_THAT(handled_events().size(), Eq(2u));
+    EXPECT_THAT(window_manager_tools.pointer_motion_counts().received, Eq(2u));
+    EXPECT_THAT(window_manager_tools.pointer_motion_counts().merged, Eq(0u));
+}
+
+TEST_F(PointerMotionCoalescing, when_enabled_uncontended_motion_is_handled_individually)
+{
+    basic_window_manager.coalesce_pointer_motion(true);
+
+    send_motion(1, 1, 1, 1);
+    send_motion(2, 2, 1, 1);
+
+    EXPECT_THAT(handled_events(), ElementsAre(
+        Motion{mir_pointer_action_motion, 0, 1, 1, 1, 1},
+        Motion{mir_pointer_action_motion, 0, 2, 2, 1, 1}));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_the_lock_is_held_is_merged_and_handled_on_release)
+{
+    basic_window_manager.coalesce_pointer_motion(true);
+    send_motion(0, 0, 0, 0);
+
+    auto holder = hold_lock(&WindowManagerTools::invoke_under_lock);
+
+    EXPECT_TRUE(send_motion(1, 2, 1, 2));
+    EXPECT_TRUE(send_motion(4, 4, 3, 2));
+    EXPECT_TRUE(send_motion(5, 7, 1, 3));
+
+    EXPECT_THAT(handled_events().size(), Eq(1u));
+
+    release();
+    holder.join();
+
+    EXPECT_THAT(handled_events(), ElementsAre(
+        Motion{mir_pointer_action_motion, 0, 0, 0, 0, 0},
+        Motion{mir_pointer_action_motion, 0, 5, 7, 5, 7}));
+
+    auto const counts = window_manager_tools.pointer_motion_counts();
+    EXPECT_THAT(counts.received, Eq(4u));
+    EXPECT_THAT(counts.merged, Eq(3u));
+    EXPECT_THAT(counts.coalesced, Eq(1u));
+}
+
+TEST_F(PointerMotionCoalescing, merged_motion_is_handled_before_a_following_button_event)
+{
+    basic_window_manager.coalesce_pointer_motion(true);
+
+    auto holder = hold_lock(&WindowManagerTools::invoke_under_lock);
+
+    send_motion(1, 1, 1, 1);
+    send_motion(2, 2, 1, 1);
+
+    // The button event can't be merged, so it waits for the lock
+    std::thread sender{[this] { send(mir_pointer_action_button_down, mir_pointer_button_primary, 2, 2, 0, 0); }};
+
+    std::this_thread::sleep_for(50ms);
+    release();
+    holder.join();
+    sender.join();
+
+    EXPECT_THAT(handled_events(), ElementsAre(
+        Motion{mir_pointer_action_motion, 0, 2, 2, 2, 2},
+        Motion{mir_pointer_action_button_down, mir_pointer_button_primary, 2, 2, 0, 0}));
+}
+
+TEST_F(PointerMotionCoalescing, motion_with_different_buttons_is_not_merged)
+{
+    basic_window_manager.coalesce_pointer_motion(true);
+
+    auto holder = hold_lock(&WindowManagerTools::invoke_under_lock);
+
+    send_motion(1, 1, 1, 1);
+
+    std::thread sender{[this] { send(mir_pointer_action_motion, mir_pointer_button_primary, 2, 2, 1, 1); }};
+
+    std::this_thread::sleep_for(50ms);
+    release();
+    holder.join();
+    sender.join();
+
+    EXPECT_THAT(handled_events(), ElementsAre(
+        Motion{mir_pointer_action_motion, 0, 1, 1, 1, 1},
+        Motion{mir_pointer_action_motion, mir_pointer_button_primary, 2, 2, 1, 1}));
+}
+
+TEST_F(PointerMotionCoalescing, motion_while_a_reader_holds_the_lock_is_handled_on_release)
+{
+    basic_window_manager.coalesce_pointer_motion(true);
+
+    auto holder = hold_lock(&WindowManagerTools::invoke_under_shared_lock);
+
+    send_motion(1, 1, 1, 1);
+    send_motion(2, 2, 1, 1);
+
+    EXPECT_THAT(handled_events(), IsEmpty());
+
+    release();
+    holder.join();
+
+    EXPECT_THAT(handled_events(), ElementsAre(Motion{mir_pointer_action_motion, 0, 2, 2, 2, 2}));
+}
+
+TEST_F(PointerMotionCoalescing, motion_merged_while_a_writer_throws_is_handled_by_the_next_writer)
+{
+    basic_window_manager.coalesce_pointer_motion(true);
+
+    std::thread holder{[this]
+        {
+            try
+            {
+                window_manager_tools.invoke_under_lock([this]
+                    {
+                        std::unique_lock<std::mutex> lock{mutex};
+                        holding = true;
+                        cv.notify_all();
+                        cv.wait_for(lock, 5s, [this]{ return release_holder; });
+                        throw std::runtime_error{"callback failed"};
+                    });
+            }
+            catch (std::runtime_error const&)
+            {
+            }
+        }};
+
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait_for(lock, 5s, [this]{ return holding; });
+    }
+
+    send_motion(1, 1, 1, 1);
+    send_motion(2, 2, 1, 1);
+
+    release();
+    holder.join();
+
+    EXPECT_THAT(handled_events(), IsEmpty());
+
+    send_motion(3, 3, 1, 1);
+
+    EXPECT_THAT(handled_events(), ElementsAre(
+        Motion{mir_pointer_action_motion, 0, 2, 2, 2, 2},
+        Motion{mir_pointer_action_motion, 0, 3, 3, 1, 1}));
+}
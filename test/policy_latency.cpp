@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/policy_latency.h"
+
+#include "test_window_manager_tools.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using miral::LatencyHistogram;
+using miral::PolicyHook;
+using miral::PolicyLatency;
+using std::chrono::nanoseconds;
+using namespace testing;
+
+namespace
+{
+auto hooks_in(std::vector<miral::PolicyHookLatency> const& latencies) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    for (auto const& latency : latencies)
+        result.push_back(latency.hook);
+    return result;
+}
+
+struct PolicyLatencyTiming : TestWindowManagerTools
+{
+    std::shared_ptr<PolicyLatency> const latency = std::make_shared<PolicyLatency>();
+};
+}
+
+TEST(LatencyHistogram, small_values_have_a_bucket_each)
+{
+    for (std::uint64_t value = 0; value != LatencyHistogram::sub_buckets; ++value)
+        EXPECT_THAT(LatencyHistogram::highest_value_in(LatencyHistogram::bucket_for(value)), Eq(value));
+}
+
+TEST(LatencyHistogram, a_bucket_is_within_a_sixteenth_of_its_values)
+{
+    for (std::uint64_t value = 1; value < (1ull << 40); value = value*3 + 1)
+    {
+        auto const highest = LatencyHistogram::highest_value_in(LatencyHistogram::bucket_for(value));
+
+        EXPECT_THAT(highest, Ge(value));
+        EXPECT_THAT(highest - value, Le(value/16)) << "value=" << value;
+    }
+}
+
+TEST(LatencyHistogram, buckets_are_in_order)
+{
+    for (std::size_t bucket = 1; bucket != LatencyHistogram::bucket_count; ++bucket)
+        EXPECT_THAT(LatencyHistogram::highest_value_in(bucket), Gt(LatencyHistogram::highest_value_in(bucket-1)));
+}
+
+TEST(LatencyHistogram, reports_percentiles)
+{
+    LatencyHistogram histogram;
+
+    for (auto i = 1; i <= 1000; ++i)
+        histogram.record(nanoseconds{i*1000});
+
+    EXPECT_THAT(histogram.calls(), Eq(1000u));
+    EXPECT_THAT(histogram.total(), Eq(nanoseconds{500500000}));
+    EXPECT_THAT(histogram.max(), Eq(nanoseconds{1000000}));
+
+    EXPECT_THAT(histogram.percentile(0.5).count(), AllOf(Ge(500000), Le(500000 + 500000/16)));
+    EXPECT_THAT(histogram.percentile(0.99).count(), AllOf(Ge(990000), Le(1000000)));
+    EXPECT_THAT(histogram.percentile(1.0), Eq(nanoseconds{1000000}));
+}
+
+TEST(LatencyHistogram, an_empty_histogram_reports_zero)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_THAT(histogram.calls(), Eq(0u));
+    EXPECT_THAT(histogram.percentile(0.5), Eq(nanoseconds{0}));
+}
+
+TEST(PolicyLatency, a_timer_records_its_scope)
+{
+    PolicyLatency latency;
+
+    {
+        PolicyLatency::Timer const timer{&latency, PolicyHook::advise_raise};
+    }
+
+    EXPECT_THAT(latency.histogram(PolicyHook::advise_raise).calls(), Eq(1u));
+    EXPECT_THAT(hooks_in(latency.latencies()), ElementsAre("advise_raise"));
+}
+
+TEST(PolicyLatency, a_timer_without_a_latency_does_nothing)
+{
+    PolicyLatency::Timer const timer{nullptr, PolicyHook::advise_raise};
+}
+
+TEST_F(PolicyLatencyTiming, hooks_are_not_timed_by_default)
+{
+    basic_window_manager.add_session(session);
+
+    EXPECT_THAT(window_manager_tools.policy_latencies(), IsEmpty());
+}
+
+TEST_F(PolicyLatencyTiming, policy_hooks_called_are_timed)
+{
+    basic_window_manager.time_policy_hooks(latency);
+    basic_window_manager.add_session(session);
+
+    auto const latencies = window_manager_tools.policy_latencies();
+
+    EXPECT_THAT(hooks_in(latencies), ElementsAre("advise_begin", "advise_end", "advise_new_app"));
+
+    for (auto const& hook : latencies)
+        EXPECT_THAT(hook.calls, Eq(1u)) << hook.hook;
+}
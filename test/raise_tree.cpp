@@ -80,6 +80,30 @@ TEST_F(RaiseTree, when_parent_is_raised_child_is_raised)
 TEST_F(RaiseTree, when_child_is_raised_parent_is_raised)
 {
     EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(parent, child)));
-    EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(child)));
     basic_window_manager.raise_tree(child);
 }
+
+TEST_F(RaiseTree, when_child_is_raised_it_is_raised_above_its_siblings)
+{
+    Window sibling;
+    EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+        .WillOnce(Invoke([&](WindowInfo const& window_info){ sibling = window_info.window(); }));
+
+    mir::scene::SurfaceCreationParameters creation_parameters;
+    creation_parameters.type = mir_window_type_menu;
+    creation_parameters.parent = parent;
+    creation_parameters.size = initial_child_size;
+    basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+    EXPECT_CALL(*window_manager_policy, advise_raise(ElementsAre(parent, sibling, child)));
+    basic_window_manager.raise_tree(child);
+
+    std::vector<Window> tree;
+    for (auto const& window : basic_window_manager.windows_intersecting({{-10000, -10000}, {20000, 20000}}))
+    {
+        if (window == parent || window == sibling || window == child)
+            tree.push_back(window);
+    }
+
+    EXPECT_THAT(tree, ElementsAre(child, sibling, parent));
+}
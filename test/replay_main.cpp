@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_stubs.h"
+
+#include "../miral/basic_window_manager.h"
+#include "../miral/window_manager_recording.h"
+
+#include <mir/test/fake_shared.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std::chrono;
+
+namespace
+{
+auto as_us(nanoseconds duration) -> long long
+{
+    return duration_cast<microseconds>(duration).count();
+}
+}
+
+// Replays a file written by --window-management-record against a headless window manager
+// (with the canonical policy, ignoring input) and reports the policy and lock latencies
+int main(int argc, char const* argv[])
+try
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: " << argv[0] << " recording [repeats]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file{argv[1], std::ios::binary};
+    if (!file)
+    {
+        std::cerr << argv[0] << ": cannot open " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string const recording{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    auto const repeats = argc == 3 ? std::stoi(argv[2]) : 1;
+
+    auto const policy_latency = std::make_shared<miral::PolicyLatency>();
+    auto const lock_timing = std::make_shared<miral::LockTiming>();
+
+    std::size_t calls = 0;
+    nanoseconds elapsed{0};
+
+    for (auto i = 0; i != repeats; ++i)
+    {
+        StubFocusController focus_controller;
+        StubDisplayLayout display_layout;
+        StubPersistentSurfaceStore persistent_surface_store;
+
+        miral::BasicWindowManager window_manager{
+            &focus_controller,
+            mir::test::fake_shared(display_layout),
+            mir::test::fake_shared(persistent_surface_store),
+            [](miral::WindowManagerTools const& tools) -> std::unique_ptr<miral::WindowManagementPolicy>
+                { return std::make_unique<StubWindowManagerPolicy>(tools); }};
+
+        window_manager.time_policy_hooks(policy_latency);
+        window_manager.time_lock(lock_timing);
+
+        miral::WindowManagerReplay replay{window_manager,
+            [](std::string const&) { return std::make_shared<StubStubSession>(); },
+            [](std::shared_ptr<mir::scene::Surface> const& surface)
+                { std::static_pointer_cast<StubSurface>(surface)->post_frame(); }};
+
+        std::istringstream in{recording};
+
+        auto const start = steady_clock::now();
+        calls += replay.replay(in);
+        elapsed += steady_clock::now() - start;
+    }
+
+    std::cout << "replayed " << calls << " calls in " << as_us(elapsed) << "us" << std::endl;
+
+    for (auto const& hook : policy_latency->latencies())
+    {
+        std::cout << hook.hook << ": calls=" << hook.calls << ", total=" << as_us(hook.total)
+                  << "us, median=" << as_us(hook.median) << "us, p99=" << as_us(hook.p99)
+                  << "us, max=" << as_us(hook.max) << "us" << std::endl;
+    }
+
+    for (auto const& entry : lock_timing->latencies())
+    {
+        std::cout << entry.entry_point << ": acquisitions=" << entry.acquisitions
+                  << ", hold total=" << as_us(entry.hold_total) << "us, median=" << as_us(entry.hold_median)
+                  << "us, p99=" << as_us(entry.hold_p99) << "us, max=" << as_us(entry.hold_max) << "us" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (std::exception const& error)
+{
+    std::cerr << argv[0] << ": " << error.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+#include <condition_variable>
+#include <thread>
+
+using namespace miral;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct SharedLock : TestWindowManagerTools
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    int readers_inside{0};
+    bool release_readers{false};
+
+    // Returns false if the other reader didn't arrive in time
+    bool wait_for_readers(int count)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        ++readers_inside;
+        cv.notify_all();
+        return cv.wait_for(lock, 5s, [&]{ return readers_inside >= count; });
+    }
+
+    void hold_until_released()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        ++readers_inside;
+        cv.notify_all();
+        cv.wait_for(lock, 5s, [&]{ return release_readers; });
+    }
+
+    void wait_for_one_reader()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        cv.wait_for(lock, 5s, [&]{ return readers_inside > 0; });
+    }
+
+    void release()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        release_readers = true;
+        cv.notify_all();
+    }
+};
+}
+
+TEST_F(SharedLock, readers_hold_the_lock_concurrently)
+{
+    bool first_saw_second{false};
+    bool second_saw_first{false};
+
+    std::thread first{[&]
+        { window_manager_tools.invoke_under_shared_lock([&]{ first_saw_second = wait_for_readers(2); }); }};
+
+    std::thread second{[&]
+        { window_manager_tools.invoke_under_shared_lock([&]{ second_saw_first = wait_for_readers(2); }); }};
+
+    first.join();
+    second.join();
+
+    EXPECT_TRUE(first_saw_second);
+    EXPECT_TRUE(second_saw_first);
+}
+
+TEST_F(SharedLock, readers_can_query_the_model)
+{
+    basic_window_manager.add_session(session);
+
+    unsigned int count{0};
+    std::thread reader{[&]
+        { window_manager_tools.invoke_under_shared_lock([&]{ count = window_manager_tools.count_applications(); }); }};
+
+    reader.join();
+
+    EXPECT_THAT(count, Eq(1u));
+}
+
+TEST_F(SharedLock, writer_waits_for_reader)
+{
+    std::atomic<bool> writer_done{false};
+
+    std::thread reader{[&]
+        { window_manager_tools.invoke_under_shared_lock([&]{ hold_until_released(); }); }};
+
+    wait_for_one_reader();
+
+    std::thread writer{[&]
+        { window_manager_tools.invoke_under_lock([&]{ writer_done = true; }); }};
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_FALSE(writer_done);
+
+    release();
+    reader.join();
+    writer.join();
+
+    EXPECT_TRUE(writer_done);
+}
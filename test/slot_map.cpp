@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/slot_map.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <string>
+
+using namespace testing;
+
+namespace
+{
+struct SlotMap : Test
+{
+    miral::SlotMap<std::string, 4> slots;
+};
+}
+
+TEST_F(SlotMap, default_handle_is_never_valid)
+{
+    slots.emplace("one");
+
+    EXPECT_THAT(slots.find(miral::SlotHandle{}), IsNull());
+}
+
+TEST_F(SlotMap, handles_find_their_elements)
+{
+    auto const one = slots.emplace("one").first;
+    auto const two = slots.emplace("two").first;
+
+    ASSERT_THAT(slots.find(one), NotNull());
+    ASSERT_THAT(slots.find(two), NotNull());
+    EXPECT_THAT(*slots.find(one), Eq("one"));
+    EXPECT_THAT(*slots.find(two), Eq("two"));
+    EXPECT_THAT(slots.size(), Eq(2u));
+}
+
+TEST_F(SlotMap, erased_handle_is_stale_even_when_its_slot_is_reused)
+{
+    auto const one = slots.emplace("one").first;
+    EXPECT_TRUE(slots.erase(one));
+
+    auto const two = slots.emplace("two").first;
+
+    EXPECT_THAT(two.index, Eq(one.index));
+    EXPECT_THAT(slots.find(one), IsNull());
+    EXPECT_FALSE(slots.erase(one));
+    EXPECT_THAT(*slots.find(two), Eq("two"));
+}
+
+TEST_F(SlotMap, elements_do_not_move_as_the_map_grows)
+{
+    auto const first = slots.emplace("first");
+
+    for (auto i = 0; i != 100; ++i)
+        slots.emplace(std::to_string(i));
+
+    EXPECT_THAT(slots.find(first.first), Eq(&first.second));
+}
+
+TEST_F(SlotMap, for_each_visits_each_element_in_slot_order)
+{
+    std::vector<miral::SlotHandle> handles;
+    for (auto i = 0; i != 10; ++i)
+        handles.push_back(slots.emplace(std::to_string(i)).first);
+
+    slots.erase(handles[3]);
+    slots.erase(handles[7]);
+
+    std::vector<std::string> seen;
+    slots.for_each([&](std::string const& element) { seen.push_back(element); });
+
+    EXPECT_THAT(seen, ElementsAre("0", "1", "2", "4", "5", "6", "8", "9"));
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/spatial_index.h"
+#include "test_window_manager_tools.h"
+
+using namespace testing;
+using miral::Window;
+using mir::geometry::Point;
+using mir::geometry::Rectangle;
+using mir::geometry::Size;
+
+namespace
+{
+struct SpatialIndex : Test
+{
+    miral::Application const app{std::make_shared<mir::test::doubles::StubSession>()};
+    std::vector<std::shared_ptr<mir::scene::Surface>> surfaces;
+    miral::SpatialIndex index{100};
+    std::vector<Window> result;
+
+    auto add_window(Rectangle const& rect) -> Window
+    {
+        surfaces.push_back(std::make_shared<StubSurface>("", mir_window_type_normal, rect.top_left, rect.size));
+        Window const window{app, surfaces.back()};
+        index.insert(window);
+        return window;
+    }
+
+    auto intersecting(Rectangle const& rect) -> std::vector<Window> const&
+    {
+        index.windows_intersecting(rect, result);
+        return result;
+    }
+
+    auto at(Point point) -> std::vector<Window> const&
+    {
+        index.windows_at(point, result);
+        return result;
+    }
+};
+
+struct WindowsIntersecting : TestWindowManagerTools
+{
+    std::vector<Window> windows;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display({{0, 0}, {1000, 1000}});
+        basic_window_manager.add_session(session);
+
+        ON_CALL(*window_manager_policy, advise_new_window(_))
+            .WillByDefault(Invoke([this](miral::WindowInfo const& window_info){ windows.push_back(window_info.window()); }));
+    }
+
+    auto add_window(Rectangle const& rect) -> Window
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.top_left = rect.top_left;
+        creation_parameters.size = rect.size;
+
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+
+        // The policy may have placed the window elsewhere
+        miral::WindowSpecification placement;
+        placement.top_left() = rect.top_left;
+        placement.size() = rect.size;
+        window_manager_tools.modify_window(windows.back(), placement);
+
+        return windows.back();
+    }
+};
+}
+
+TEST_F(SpatialIndex, finds_windows_intersecting_a_rectangle)
+{
+    auto const left = add_window({{0, 0}, {150, 150}});
+    auto const right = add_window({{300, 0}, {150, 150}});
+    auto const below = add_window({{0, 300}, {450, 150}});
+
+    EXPECT_THAT(intersecting({{100, 100}, {250, 10}}), UnorderedElementsAre(left, right));
+    EXPECT_THAT(intersecting({{200, 100}, {10, 300}}), ElementsAre(below));
+    EXPECT_THAT(intersecting({{160, 160}, {100, 100}}), IsEmpty());
+}
+
+TEST_F(SpatialIndex, edges_touching_do_not_intersect)
+{
+    add_window({{0, 0}, {100, 100}});
+
+    EXPECT_THAT(intersecting({{100, 0}, {100, 100}}), IsEmpty());
+    EXPECT_THAT(at({100, 50}), IsEmpty());
+    EXPECT_THAT(at({99, 50}), SizeIs(1));
+}
+
+TEST_F(SpatialIndex, results_are_topmost_first)
+{
+    auto const bottom = add_window({{0, 0}, {500, 500}});
+    auto const middle = add_window({{50, 50}, {100, 100}});
+    auto const top = add_window({{80, 80}, {100, 100}});
+
+    EXPECT_THAT(at({90, 90}), ElementsAre(top, middle, bottom));
+
+    index.raise({bottom, middle});
+
+    EXPECT_THAT(at({90, 90}), ElementsAre(middle, bottom, top));
+}
+
+TEST_F(SpatialIndex, windows_spanning_many_cells_are_found)
+{
+    auto const huge = add_window({{-5000, -5000}, {10000, 10000}});
+    auto const small = add_window({{10, 10}, {10, 10}});
+
+    EXPECT_THAT(at({15, 15}), ElementsAre(small, huge));
+    EXPECT_THAT(at({-4000, 4000}), ElementsAre(huge));
+    EXPECT_THAT(intersecting({{-10000, -10000}, {20000, 20000}}), ElementsAre(small, huge));
+}
+
+TEST_F(SpatialIndex, moving_and_resizing_a_window_updates_the_index)
+{
+    auto window = add_window({{0, 0}, {50, 50}});
+
+    window.move_to({1000, 1000});
+
+    EXPECT_THAT(at({10, 10}), IsEmpty());
+    EXPECT_THAT(at({1010, 1010}), ElementsAre(window));
+
+    window.resize({1000, 1000});
+
+    EXPECT_THAT(at({1900, 1900}), ElementsAre(window));
+
+    window.move_to({-1000, -1000});
+    window.resize({10, 10});
+
+    EXPECT_THAT(at({1010, 1010}), IsEmpty());
+    EXPECT_THAT(at({-995, -995}), ElementsAre(window));
+}
+
+TEST_F(SpatialIndex, erased_windows_are_not_found)
+{
+    auto const window = add_window({{0, 0}, {50, 50}});
+    auto const other = add_window({{0, 0}, {50, 50}});
+
+    index.erase(window);
+
+    EXPECT_THAT(at({10, 10}), ElementsAre(other));
+    EXPECT_THAT(index.size(), Eq(1u));
+}
+
+TEST_F(WindowsIntersecting, finds_visible_windows_topmost_first)
+{
+    auto const first = add_window({{0, 0}, {200, 200}});
+    auto const second = add_window({{100, 100}, {200, 200}});
+    auto const third = add_window({{500, 500}, {200, 200}});
+
+    EXPECT_THAT(window_manager_tools.windows_intersecting({{150, 150}, {10, 10}}), ElementsAre(second, first));
+
+    window_manager_tools.raise_tree(first);
+
+    EXPECT_THAT(window_manager_tools.windows_intersecting({{150, 150}, {10, 10}}), ElementsAre(first, second));
+
+    miral::WindowSpecification hide;
+    hide.state() = mir_window_state_hidden;
+    window_manager_tools.modify_window(first, hide);
+
+    EXPECT_THAT(window_manager_tools.windows_intersecting({{150, 150}, {10, 10}}), ElementsAre(second));
+    EXPECT_THAT(window_manager_tools.windows_intersecting({{0, 0}, {1000, 1000}}), ElementsAre(third, second));
+}
+
+TEST_F(WindowsIntersecting, follows_windows_moved_by_the_window_manager)
+{
+    auto const window = add_window({{0, 0}, {100, 100}});
+
+    miral::WindowSpecification move;
+    move.top_left() = Point{600, 600};
+    window_manager_tools.modify_window(window, move);
+
+    EXPECT_THAT(window_manager_tools.windows_intersecting({{0, 0}, {100, 100}}), IsEmpty());
+    EXPECT_THAT(window_manager_tools.windows_intersecting({{650, 650}, {1, 1}}), ElementsAre(window));
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/spatial_index.h"
+
+#include <mir/test/doubles/stub_surface.h>
+#include <mir/test/doubles/stub_session.h>
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+using mir::geometry::Point;
+using mir::geometry::Rectangle;
+using mir::geometry::Size;
+
+namespace
+{
+struct PlacedSurface : mir::test::doubles::StubSurface
+{
+    PlacedSurface(Rectangle const& rect) : rect{rect} {}
+
+    Point top_left() const override { return rect.top_left; }
+    Size size() const override { return rect.size; }
+    void move_to(Point const& top_left) override { rect.top_left = top_left; }
+    void resize(Size const& size) override { rect.size = size; }
+
+    Rectangle rect;
+};
+
+// Windows of assorted sizes scattered over a pair of 1920x1080 outputs
+struct Fixture
+{
+    explicit Fixture(int count) : app{std::make_shared<mir::test::doubles::StubSession>()}
+    {
+        std::default_random_engine random;
+        std::uniform_int_distribution<int> x(0, 3840 - 1);
+        std::uniform_int_distribution<int> y(0, 1080 - 1);
+        std::uniform_int_distribution<int> extent(100, 800);
+
+        for (auto i = 0; i != count; ++i)
+        {
+            surfaces.push_back(std::make_shared<PlacedSurface>(Rectangle{{x(random), y(random)}, {extent(random), extent(random)}}));
+            windows.emplace_back(app, surfaces.back());
+            index.insert(windows.back());
+        }
+
+        for (auto i = 0; i != 1000; ++i)
+            points.push_back({x(random), y(random)});
+    }
+
+    miral::Application const app;
+    std::vector<std::shared_ptr<mir::scene::Surface>> surfaces;
+    std::vector<miral::Window> windows;
+    std::vector<Point> points;
+    miral::SpatialIndex index;
+};
+
+// Hover hit-testing: the windows under the cursor
+void windows_at(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    std::vector<miral::Window> result;
+    auto point = fixture.points.begin();
+
+    for (auto _ : state)
+    {
+        fixture.index.windows_at(*point, result);
+        benchmark::DoNotOptimize(result.data());
+
+        if (++point == fixture.points.end())
+            point = fixture.points.begin();
+    }
+}
+
+// Titlebar hit-testing and overlap queries: the windows intersecting a small rectangle
+void windows_intersecting(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    std::vector<miral::Window> result;
+    auto point = fixture.points.begin();
+
+    for (auto _ : state)
+    {
+        fixture.index.windows_intersecting({*point, {300, 30}}, result);
+        benchmark::DoNotOptimize(result.data());
+
+        if (++point == fixture.points.end())
+            point = fixture.points.begin();
+    }
+}
+
+// Dragging a window
+void move_window(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto& window = fixture.windows.front();
+    auto point = fixture.points.begin();
+
+    for (auto _ : state)
+    {
+        window.move_to(*point);
+
+        if (++point == fixture.points.end())
+            point = fixture.points.begin();
+    }
+}
+}
+
+BENCHMARK(windows_at)->Arg(10)->Arg(100)->Arg(500);
+BENCHMARK(windows_intersecting)->Arg(10)->Arg(100)->Arg(500);
+BENCHMARK(move_window)->Arg(10)->Arg(100)->Arg(500);
@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/trace_recorder.h"
+
+#include "test_window_manager_tools.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+using miral::TraceCall;
+using miral::TraceRecord;
+using miral::TraceRecorder;
+using namespace testing;
+
+namespace
+{
+auto text_of(TraceRecord const& record) -> std::string
+{
+    std::stringstream out;
+    TraceRecorder::decode(record, out);
+    return out.str();
+}
+
+auto values_of(std::vector<TraceRecord> const& records) -> std::vector<std::uint32_t>
+{
+    std::vector<std::uint32_t> result;
+    for (auto const& record : records)
+        result.push_back(record.value);
+    return result;
+}
+
+struct TraceRecorderWithWindow : TestWindowManagerTools
+{
+    miral::Window window;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display({{0, 0}, {640, 480}});
+        basic_window_manager.add_session(session);
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.name = "a window";
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.size = mir::geometry::Size{100, 100};
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](miral::WindowInfo const& window_info){ window = window_info.window(); }));
+
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+    }
+};
+}
+
+TEST(TraceRecorder, records_are_held_oldest_first)
+{
+    TraceRecorder recorder{16};
+
+    for (std::uint32_t i = 0; i != 5; ++i)
+        recorder.record(TraceCall::count_applications, i);
+
+    EXPECT_THAT(values_of(recorder.snapshot()), ElementsAre(0, 1, 2, 3, 4));
+}
+
+TEST(TraceRecorder, when_full_the_oldest_records_are_overwritten)
+{
+    TraceRecorder recorder{4};
+
+    for (std::uint32_t i = 0; i != 10; ++i)
+        recorder.record(TraceCall::count_applications, i);
+
+    EXPECT_THAT(values_of(recorder.snapshot()), ElementsAre(6, 7, 8, 9));
+}
+
+TEST(TraceRecorder, each_thread_has_its_own_ring)
+{
+    TraceRecorder recorder{4};
+
+    for (std::uint32_t i = 0; i != 4; ++i)
+        recorder.record(TraceCall::count_applications, i);
+
+    std::thread{[&]
+        {
+            for (std::uint32_t i = 4; i != 8; ++i)
+                recorder.record(TraceCall::count_applications, i);
+        }}.join();
+
+    auto const records = recorder.snapshot();
+
+    EXPECT_THAT(values_of(records), ElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+    EXPECT_THAT(records.front().thread, Ne(records.back().thread));
+}
+
+TEST(TraceRecorder, snapshots_taken_while_recording_hold_only_whole_records)
+{
+    TraceRecorder recorder{8};
+    std::atomic<bool> done{false};
+
+    std::thread writer{[&]
+        {
+            for (std::uint32_t i = 0; !done; ++i)
+                recorder.record(TraceCall::drag_window, i, int(i), int(i), int(i), int(i));
+        }};
+
+    for (auto snapshot = 0; snapshot != 1000; ++snapshot)
+    {
+        auto const records = recorder.snapshot();
+
+        for (auto const& record : records)
+        {
+            ASSERT_THAT(record.x, Eq(int(record.value)));
+            ASSERT_THAT(record.height, Eq(int(record.value)));
+        }
+
+        for (auto i = 1u; i < records.size(); ++i)
+            ASSERT_THAT(records[i].value, Eq(records[i-1].value + 1));
+    }
+
+    done = true;
+    writer.join();
+}
+
+TEST(TraceRecorder, records_are_decoded_in_the_trace_format)
+{
+    TraceRecorder recorder;
+
+    recorder.record(TraceCall::count_applications, 3u);
+    recorder.record(TraceCall::drag_active_window, 0u, 5, -7);
+    recorder.record(TraceCall::active_window, miral::Window{});
+    recorder.record(TraceCall::active_display, 0u, 0, 0, 640, 480);
+    recorder.record(TraceCall::advise_end);
+
+    auto const records = recorder.snapshot();
+    ASSERT_THAT(records.size(), Eq(5u));
+
+    EXPECT_THAT(text_of(records[0]), Eq("count_applications -> 3"));
+    EXPECT_THAT(text_of(records[1]), Eq("drag_active_window movement=(5, -7)"));
+    EXPECT_THAT(text_of(records[2]), Eq("active_window -> (null)"));
+    EXPECT_THAT(text_of(records[3]), Eq("active_display -> ((0, 0), (640, 480))"));
+    EXPECT_THAT(text_of(records[4]), Eq("===="));
+}
+
+TEST(TraceRecorder, written_records_can_be_decoded)
+{
+    TraceRecorder recorder;
+
+    recorder.record(TraceCall::focus_next_application);
+    recorder.record(TraceCall::advise_end);
+
+    std::stringstream binary;
+    recorder.write(binary);
+
+    std::stringstream text;
+    TraceRecorder::decode(binary, text);
+
+    EXPECT_THAT(text.str(), MatchesRegex(
+        "\\[[0-9]+\\.[0-9]{6}\\] miral::Window Management: focus_next_application\n"
+        "\\[[0-9]+\\.[0-9]{6}\\] miral::Window Management: ====\n"));
+}
+
+TEST(TraceRecorder, decoding_something_else_throws)
+{
+    std::stringstream binary{"this is not a trace"};
+    std::stringstream text;
+
+    EXPECT_THROW(TraceRecorder::decode(binary, text), std::runtime_error);
+}
+
+TEST_F(TraceRecorderWithWindow, records_identify_the_window)
+{
+    TraceRecorder recorder;
+    auto const& info = window_manager_tools.info_for(window);
+
+    recorder.record(TraceCall::advise_move_to, info, 10, 20);
+    recorder.record(TraceCall::raise_tree, window);
+
+    auto const records = recorder.snapshot();
+    ASSERT_THAT(records.size(), Eq(2u));
+
+    EXPECT_THAT(records[0].window, Ne(0u));
+    EXPECT_THAT(records[1].window, Eq(records[0].window));
+    EXPECT_THAT(text_of(records[0]), StartsWith("advise_move_to window_info={name=a window, type="));
+    EXPECT_THAT(text_of(records[0]), EndsWith(", top_left=(10, 20)"));
+    EXPECT_THAT(text_of(records[1]), Eq("raise_tree root=a window"));
+}
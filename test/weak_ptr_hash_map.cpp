@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/weak_ptr_hash_map.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+
+using namespace testing;
+
+namespace
+{
+struct Thing {};
+
+using Map = miral::WeakPtrHashMap<Thing, int>;
+
+struct WeakPtrHashMap : Test
+{
+    Map map;
+
+    std::vector<std::shared_ptr<Thing>> make_things(int count)
+    {
+        std::vector<std::shared_ptr<Thing>> result;
+        for (auto i = 0; i != count; ++i)
+            result.push_back(std::make_shared<Thing>());
+        return result;
+    }
+};
+}
+
+TEST_F(WeakPtrHashMap, finds_values_by_live_key)
+{
+    auto const things = make_things(100);
+
+    for (auto i = 0u; i != things.size(); ++i)
+        map.emplace(things[i], i);
+
+    ASSERT_THAT(map.size(), Eq(things.size()));
+
+    for (auto i = 0u; i != things.size(); ++i)
+        EXPECT_THAT(map.at(things[i]), Eq(int(i)));
+}
+
+TEST_F(WeakPtrHashMap, unknown_key_is_not_found)
+{
+    auto const things = make_things(2);
+    map.emplace(things[0], 0);
+
+    EXPECT_THROW(map.at(things[1]), std::out_of_range);
+    EXPECT_THAT(map.find(things[1]), Eq(map.end()));
+    EXPECT_THAT(map.erase(things[1]), Eq(0u));
+}
+
+TEST_F(WeakPtrHashMap, emplace_does_not_replace_an_existing_value)
+{
+    auto const thing = std::make_shared<Thing>();
+
+    EXPECT_TRUE(map.emplace(thing, 1).second);
+    EXPECT_FALSE(map.emplace(thing, 2).second);
+    EXPECT_THAT(map.at(thing), Eq(1));
+}
+
+TEST_F(WeakPtrHashMap, finds_and_erases_values_by_expired_key)
+{
+    auto things = make_things(10);
+    std::weak_ptr<Thing> const expired = things[3];
+
+    for (auto i = 0u; i != things.size(); ++i)
+        map.emplace(things[i], i);
+
+    things[3].reset();
+
+    EXPECT_THAT(map.at(expired), Eq(3));
+    EXPECT_THAT(map.erase(expired), Eq(1u));
+    EXPECT_THROW(map.at(expired), std::out_of_range);
+    EXPECT_THAT(map.size(), Eq(9u));
+}
+
+TEST_F(WeakPtrHashMap, new_owner_at_reused_address_is_distinct_from_expired_owner)
+{
+    static Thing thing;
+    auto first = std::shared_ptr<Thing>(&thing, [](Thing*){});
+    std::weak_ptr<Thing> const expired = first;
+
+    map.emplace(first, 1);
+    first.reset();
+
+    auto const second = std::shared_ptr<Thing>(&thing, [](Thing*){});
+
+    EXPECT_THROW(map.at(second), std::out_of_range);
+    EXPECT_TRUE(map.emplace(second, 2).second);
+
+    EXPECT_THAT(map.at(second), Eq(2));
+    EXPECT_THAT(map.at(expired), Eq(1));
+}
+
+TEST_F(WeakPtrHashMap, references_remain_valid_as_the_map_grows)
+{
+    auto const things = make_things(1000);
+
+    auto& first_value = map.emplace(things[0], 0).first->second;
+
+    for (auto i = 1u; i != things.size(); ++i)
+        map.emplace(things[i], i);
+
+    EXPECT_THAT(&map.at(things[0]), Eq(&first_value));
+}
+
+TEST_F(WeakPtrHashMap, erasing_keeps_other_values_reachable)
+{
+    auto const things = make_things(1000);
+
+    for (auto i = 0u; i != things.size(); ++i)
+        map.emplace(things[i], i);
+
+    for (auto i = 0u; i < things.size(); i += 2)
+        EXPECT_THAT(map.erase(things[i]), Eq(1u));
+
+    EXPECT_THAT(map.size(), Eq(things.size()/2));
+
+    for (auto i = 0u; i != things.size(); ++i)
+    {
+        if (i % 2)
+            EXPECT_THAT(map.at(things[i]), Eq(int(i)));
+        else
+            EXPECT_THAT(map.find(things[i]), Eq(map.end()));
+    }
+}
+
+TEST_F(WeakPtrHashMap, iterates_over_every_value_once)
+{
+    auto const things = make_things(100);
+
+    for (auto i = 0u; i != things.size(); ++i)
+        map.emplace(things[i], i);
+
+    std::vector<int> seen;
+    for (auto const& entry : map)
+        seen.push_back(entry.second);
+
+    std::sort(begin(seen), end(seen));
+
+    ASSERT_THAT(seen.size(), Eq(things.size()));
+    for (auto i = 0u; i != seen.size(); ++i)
+        EXPECT_THAT(seen[i], Eq(int(i)));
+}
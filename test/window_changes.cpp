@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_tools.h"
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+X const display_left{0};
+Y const display_top{0};
+Width const display_width{640};
+Height const display_height{480};
+
+Rectangle const display_area{{display_left, display_top}, {display_width, display_height}};
+
+struct WindowChangesTest : TestWindowManagerTools
+{
+    Window window;
+    Window other;
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display(display_area);
+        basic_window_manager.add_session(session);
+
+        window = create_window(mir_window_type_normal);
+        other = create_window(mir_window_type_normal);
+    }
+
+    auto create_window(MirWindowType type, Window const& parent = {}) -> Window
+    {
+        Window result;
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = type;
+        creation_parameters.size = Size{100, 100};
+        if (parent)
+            creation_parameters.parent = std::weak_ptr<mir::scene::Surface>(parent);
+
+        EXPECT_CALL(*window_manager_policy, advise_new_window(_))
+            .WillOnce(Invoke([&result](WindowInfo const& window_info){ result = window_info.window(); }));
+
+        basic_window_manager.add_surface(session, creation_parameters, &create_surface);
+        return result;
+    }
+
+    auto changes_for(WindowSpecification const& modifications) -> WindowChanges
+    {
+        WindowChanges result;
+
+        EXPECT_CALL(*window_manager_policy, advise_window_changed(_, _))
+            .Times(AtMost(1))
+            .WillOnce(SaveArg<1>(&result));
+
+        window_manager_tools.modify_window(window, modifications);
+        Mock::VerifyAndClearExpectations(window_manager_policy);
+        return result;
+    }
+};
+}
+
+TEST_F(WindowChangesTest, reports_the_fields_that_change)
+{
+    WindowSpecification modifications;
+    modifications.name() = "new name";
+    modifications.min_width() = Width{10};
+    modifications.top_left() = Point{20, 30};
+
+    auto const changes = changes_for(modifications);
+
+    EXPECT_TRUE(changes.contains(WindowChange::name));
+    EXPECT_TRUE(changes.contains(WindowChange::min_width));
+    EXPECT_TRUE(changes.contains(WindowChange::top_left));
+
+    EXPECT_FALSE(changes.contains(WindowChange::size));
+    EXPECT_FALSE(changes.contains(WindowChange::type));
+    EXPECT_FALSE(changes.contains(WindowChange::state));
+
+    EXPECT_THAT(window_manager_tools.info_for(window).name(), Eq("new name"));
+    EXPECT_THAT(window_manager_tools.info_for(window).min_width(), Eq(Width{10}));
+    EXPECT_THAT(window.top_left(), Eq(Point{20, 30}));
+}
+
+TEST_F(WindowChangesTest, setting_fields_to_their_current_values_is_not_a_change)
+{
+    auto const& info = window_manager_tools.info_for(window);
+
+    WindowSpecification modifications;
+    modifications.name() = info.name();
+    modifications.type() = info.type();
+    modifications.max_width() = info.max_width();
+    modifications.top_left() = window.top_left();
+    modifications.size() = window.size();
+
+    EXPECT_CALL(*window_manager_policy, advise_window_changed(_, _)).Times(0);
+
+    window_manager_tools.modify_window(window, modifications);
+}
+
+TEST_F(WindowChangesTest, reports_a_state_change)
+{
+    WindowSpecification modifications;
+    modifications.state() = mir_window_state_maximized;
+
+    auto const changes = changes_for(modifications);
+
+    EXPECT_TRUE(changes.contains(WindowChange::state));
+    EXPECT_FALSE(changes.contains(WindowChange::name));
+}
+
+TEST_F(WindowChangesTest, reports_a_resize)
+{
+    WindowSpecification modifications;
+    modifications.size() = Size{200, 150};
+
+    auto const changes = changes_for(modifications);
+
+    EXPECT_TRUE(changes.contains(WindowChange::size));
+    EXPECT_FALSE(changes.contains(WindowChange::top_left));
+    EXPECT_THAT(window.size(), Eq(Size{200, 150}));
+}
+
+TEST_F(WindowChangesTest, reports_a_new_parent)
+{
+    window = create_window(mir_window_type_dialog);
+
+    WindowSpecification modifications;
+    modifications.parent() = std::weak_ptr<mir::scene::Surface>(other);
+
+    auto const changes = changes_for(modifications);
+
+    EXPECT_TRUE(changes.contains(WindowChange::parent));
+    EXPECT_THAT(window_manager_tools.info_for(window).parent(), Eq(other));
+    EXPECT_THAT(window_manager_tools.info_for(other).children(), ElementsAre(window));
+}
+
+TEST_F(WindowChangesTest, morphing_to_a_type_without_parent_reports_losing_the_parent)
+{
+    window = create_window(mir_window_type_dialog, other);
+
+    WindowSpecification modifications;
+    modifications.type() = mir_window_type_normal;
+
+    auto const changes = changes_for(modifications);
+
+    EXPECT_TRUE(changes.contains(WindowChange::type));
+    EXPECT_TRUE(changes.contains(WindowChange::parent));
+    EXPECT_FALSE(window_manager_tools.info_for(window).parent());
+    EXPECT_THAT(window_manager_tools.info_for(other).children(), IsEmpty());
+}
+
+TEST_F(WindowChangesTest, an_invalid_change_changes_nothing)
+{
+    WindowSpecification modifications;
+    modifications.name() = "new name";
+    modifications.type() = mir_window_type_tip;
+
+    EXPECT_CALL(*window_manager_policy, advise_window_changed(_, _)).Times(0);
+
+    EXPECT_THROW(window_manager_tools.modify_window(window, modifications), std::runtime_error);
+
+    EXPECT_THAT(window_manager_tools.info_for(window).name(), Ne("new name"));
+    EXPECT_THAT(window_manager_tools.info_for(window).type(), Eq(mir_window_type_normal));
+}
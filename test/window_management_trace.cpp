@@ -0,0 +1,124 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/window_management_trace.h"
+
+#include "test_window_manager_tools.h"
+
+#include <miral/workspace_policy.h>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+struct MockTracedPolicy : MockWindowManagerPolicy, WorkspacePolicy
+{
+    using MockWindowManagerPolicy::MockWindowManagerPolicy;
+
+    MOCK_METHOD2(advise_adding_to_workspace,
+                 void(std::shared_ptr<Workspace> const&, std::vector<Window> const&));
+
+    MOCK_METHOD2(advise_removing_from_workspace,
+                 void(std::shared_ptr<Workspace> const&, std::vector<Window> const&));
+};
+
+// A window manager with the policy wrapped in a WindowManagementTrace
+struct WindowManagementTraceTest : Test
+{
+    std::shared_ptr<TraceRecorder> const recorder{std::make_shared<TraceRecorder>()};
+
+    StubFocusController focus_controller;
+    StubDisplayLayout display_layout;
+    StubPersistentSurfaceStore persistent_surface_store;
+    std::shared_ptr<StubStubSession> session{std::make_shared<StubStubSession>()};
+
+    MockTracedPolicy* traced_policy{nullptr};
+    WindowManagerTools tools{nullptr};
+    Window window;
+
+    BasicWindowManager basic_window_manager{
+        &focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                this->tools = tools;
+
+                return std::make_unique<WindowManagementTrace>(tools,
+                    [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+                    {
+                        auto policy = std::make_unique<NiceMock<MockTracedPolicy>>(tools);
+                        traced_policy = policy.get();
+                        return std::move(policy);
+                    },
+                    recorder);
+            }
+    };
+
+    void SetUp() override
+    {
+        basic_window_manager.add_display({{0, 0}, {640, 480}});
+        basic_window_manager.add_session(session);
+
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.type = mir_window_type_normal;
+        creation_parameters.size = Size{100, 100};
+
+        EXPECT_CALL(*traced_policy, advise_new_window(_))
+            .WillOnce(Invoke([this](WindowInfo const& window_info){ window = window_info.window(); }));
+
+        basic_window_manager.add_surface(session, creation_parameters, &TestWindowManagerTools::create_surface);
+    }
+
+    auto recorded(TraceCall call) const -> bool
+    {
+        for (auto const& record : recorder->snapshot())
+        {
+            if (record.call == std::uint16_t(call))
+                return true;
+        }
+        return false;
+    }
+};
+}
+
+TEST_F(WindowManagementTraceTest, forwards_workspace_advice_to_the_policy)
+{
+    auto const workspace = tools.create_workspace();
+
+    EXPECT_CALL(*traced_policy, advise_adding_to_workspace(workspace, ElementsAre(window)));
+    tools.add_tree_to_workspace(window, workspace);
+
+    EXPECT_CALL(*traced_policy, advise_removing_from_workspace(workspace, ElementsAre(window)));
+    tools.remove_tree_from_workspace(window, workspace);
+
+    EXPECT_TRUE(recorded(TraceCall::advise_adding_to_workspace));
+    EXPECT_TRUE(recorded(TraceCall::advise_removing_from_workspace));
+}
+
+TEST_F(WindowManagementTraceTest, forwards_window_changes_to_the_policy)
+{
+    WindowSpecification modifications;
+    modifications.top_left() = Point{10, 10};
+
+    EXPECT_CALL(*traced_policy, advise_window_changed(Property(&WindowInfo::window, Eq(window)), _));
+    tools.modify_window(window, modifications);
+
+    EXPECT_TRUE(recorded(TraceCall::advise_window_changed));
+}
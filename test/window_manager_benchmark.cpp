@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "test_window_manager_stubs.h"
+
+#include "../miral/basic_window_manager.h"
+
+#include <miral/window_info.h>
+
+#include <mir/test/fake_shared.h>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+using namespace miral;
+
+// A window manager with the canonical policy ignoring input and "windows" normal
+// windows, ten to each application (so that there are applications to switch between)
+struct Fixture
+{
+    static auto const windows_per_application = 10;
+
+    explicit Fixture(int windows)
+    {
+        window_manager.add_display(Rectangle{{0, 0}, {1920, 1080}});
+
+        for (auto i = 0; i != windows; ++i)
+        {
+            if (i % windows_per_application == 0)
+            {
+                sessions.push_back(std::make_shared<StubStubSession>());
+                window_manager.add_session(sessions.back());
+            }
+
+            this->windows.push_back(add_window(sessions.back()));
+        }
+    }
+
+    // A normal window, or a menu if parent is given
+    auto add_window(std::shared_ptr<mir::scene::Session> const& session, Window const& parent = {}) -> Window
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.name = "window";
+        creation_parameters.type = parent ? mir_window_type_menu : mir_window_type_normal;
+        creation_parameters.size = Size{100, 100};
+        if (parent)
+            creation_parameters.parent = std::weak_ptr<mir::scene::Surface>(parent);
+
+        auto const id = window_manager.add_surface(session, creation_parameters, &build);
+        return tools.info_for(session->surface(id)).window();
+    }
+
+    void remove_window(Window const& window)
+    {
+        window_manager.remove_surface(window.application(), window);
+    }
+
+    static auto build(
+        std::shared_ptr<mir::scene::Session> const& session,
+        mir::scene::SurfaceCreationParameters const& params) -> mir::frontend::SurfaceId
+    {
+        return session->create_surface(params, {});
+    }
+
+    StubFocusController focus_controller;
+    StubDisplayLayout display_layout;
+    StubPersistentSurfaceStore persistent_surface_store;
+    WindowManagerTools tools{nullptr};
+
+    BasicWindowManager window_manager{
+        &focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        [this](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            {
+                this->tools = tools;
+                return std::make_unique<StubWindowManagerPolicy>(tools);
+            }};
+
+    std::vector<std::shared_ptr<mir::scene::Session>> sessions;
+    std::vector<Window> windows;
+};
+
+void add_surface(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto const& session = fixture.sessions.front();
+
+    for (auto _ : state)
+    {
+        auto const window = fixture.add_window(session);
+
+        state.PauseTiming();
+        fixture.remove_window(window);
+        state.ResumeTiming();
+    }
+}
+
+void remove_surface(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto const& session = fixture.sessions.front();
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto const window = fixture.add_window(session);
+        state.ResumeTiming();
+
+        fixture.remove_window(window);
+    }
+}
+
+void modify_window(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto i = 0u;
+
+    for (auto _ : state)
+    {
+        auto const& window = fixture.windows[i++ % fixture.windows.size()];
+
+        WindowSpecification modifications;
+        modifications.top_left() = Point{int(i % 100), int(i % 50)};
+        fixture.tools.modify_window(window, modifications);
+    }
+}
+
+void raise_tree(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto i = 0u;
+
+    for (auto _ : state)
+        fixture.tools.raise_tree(fixture.windows[i++ % fixture.windows.size()]);
+}
+
+// Raises the innermost of a window and a chain of "range" nested menus
+void raise_tree_of_nested_menus(benchmark::State& state)
+{
+    Fixture fixture(1);
+    auto window = fixture.windows.front();
+
+    for (auto i = 0; i != state.range(0); ++i)
+        window = fixture.add_window(fixture.sessions.front(), window);
+
+    for (auto _ : state)
+        fixture.tools.raise_tree(window);
+
+    state.SetItemsProcessed(state.iterations()*(state.range(0) + 1));
+}
+
+void select_active_window(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto i = 0u;
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(fixture.tools.select_active_window(fixture.windows[i++ % fixture.windows.size()]));
+}
+
+void focus_next_application(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    fixture.tools.select_active_window(fixture.windows.front());
+
+    for (auto _ : state)
+        fixture.tools.focus_next_application();
+}
+
+void add_and_remove_tree_from_workspace(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto const workspace = fixture.tools.create_workspace();
+    auto i = 0u;
+
+    for (auto _ : state)
+    {
+        auto const& window = fixture.windows[i++ % fixture.windows.size()];
+        fixture.tools.add_tree_to_workspace(window, workspace);
+        fixture.tools.remove_tree_from_workspace(window, workspace);
+    }
+}
+
+// Moves every window between two workspaces
+void move_workspace_content_to_workspace(benchmark::State& state)
+{
+    Fixture fixture(state.range(0));
+    auto from = fixture.tools.create_workspace();
+    auto to = fixture.tools.create_workspace();
+
+    for (auto const& window : fixture.windows)
+        fixture.tools.add_tree_to_workspace(window, from);
+
+    for (auto _ : state)
+    {
+        fixture.tools.move_workspace_content_to_workspace(to, from);
+        std::swap(from, to);
+    }
+
+    state.SetItemsProcessed(state.iterations()*state.range(0));
+}
+}
+
+// The argument is the number of windows. The benchmarks write JSON with
+// --benchmark_format=json (or run the "miral-bench-json" target).
+BENCHMARK(add_surface)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(remove_surface)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(modify_window)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(raise_tree)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(raise_tree_of_nested_menus)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(select_active_window)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(focus_next_application)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(add_and_remove_tree_from_workspace)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(move_workspace_content_to_workspace)->RangeMultiplier(10)->Range(10, 10000);
@@ -0,0 +1,219 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/window_manager_recording.h"
+
+#include "test_window_manager_tools.h"
+
+#include <miral/application_info.h>
+
+#include <mir/events/event_builders.h>
+
+#include <sstream>
+
+using namespace miral;
+using namespace testing;
+
+namespace
+{
+Rectangle const display_area{{0, 0}, {640, 480}};
+
+// Calls are recorded on a window manager with the canonical policy, and replayed
+// on the one provided by TestWindowManagerTools
+struct WindowManagerRecording : TestWindowManagerTools
+{
+    StubFocusController recorded_focus_controller;
+    std::shared_ptr<StubStubSession> const recorded_session{std::make_shared<StubStubSession>()};
+
+    std::shared_ptr<BasicWindowManager> const recorded_window_manager{std::make_shared<BasicWindowManager>(
+        &recorded_focus_controller,
+        mir::test::fake_shared(display_layout),
+        mir::test::fake_shared(persistent_surface_store),
+        [](WindowManagerTools const& tools) -> std::unique_ptr<WindowManagementPolicy>
+            { return std::make_unique<StubWindowManagerPolicy>(tools); })};
+
+    std::shared_ptr<std::stringstream> const recording{std::make_shared<std::stringstream>()};
+    WindowManagerRecorder recorder{recorded_window_manager, recording};
+
+    void SetUp() override
+    {
+        recorder.add_display(display_area);
+        recorder.add_session(recorded_session);
+    }
+
+    auto create_surface(std::string const& name, std::shared_ptr<mir::scene::Surface> const& parent = {})
+    -> std::shared_ptr<mir::scene::Surface>
+    {
+        mir::scene::SurfaceCreationParameters creation_parameters;
+        creation_parameters.name = name;
+        creation_parameters.type = parent ? mir_window_type_dialog : mir_window_type_normal;
+        creation_parameters.size = Size{100, 100};
+        creation_parameters.parent = parent;
+
+        auto const id = recorder.add_surface(recorded_session, creation_parameters, &TestWindowManagerTools::create_surface);
+        return recorded_session->surface(id);
+    }
+
+    auto replay() -> std::size_t
+    {
+        recorder.flush();
+        std::istringstream in{recording->str()};
+
+        WindowManagerReplay replay{basic_window_manager,
+            [this](std::string const&) { return session; },
+            [](std::shared_ptr<mir::scene::Surface> const& surface)
+                { std::static_pointer_cast<StubSurface>(surface)->post_frame(); }};
+        return replay.replay(in);
+    }
+
+    auto replayed_windows() -> std::vector<Window>
+    {
+        return window_manager_tools.info_for(session).windows();
+    }
+};
+}
+
+TEST_F(WindowManagerRecording, replays_each_call)
+{
+    create_surface("a window");
+
+    EXPECT_THAT(replay(), Eq(3u));
+}
+
+TEST_F(WindowManagerRecording, replayed_windows_match_those_recorded)
+{
+    auto const surface = create_surface("a window");
+
+    mir::shell::SurfaceSpecification modifications;
+    modifications.width = Width{200};
+    modifications.height = Height{150};
+    modifications.name = std::string{"renamed"};
+    recorder.modify_surface(recorded_session, surface, modifications);
+    recorder.set_surface_attribute(recorded_session, surface, mir_window_attrib_state, mir_window_state_maximized);
+
+    replay();
+
+    auto const windows = replayed_windows();
+    ASSERT_THAT(windows.size(), Eq(1u));
+
+    auto const& info = window_manager_tools.info_for(windows[0]);
+    EXPECT_THAT(info.name(), Eq("renamed"));
+    EXPECT_THAT(info.state(), Eq(mir_window_state_maximized));
+    EXPECT_THAT(windows[0].top_left(), Eq(surface->top_left()));
+    EXPECT_THAT(windows[0].size(), Eq(surface->size()));
+}
+
+TEST_F(WindowManagerRecording, replayed_children_keep_their_parent)
+{
+    auto const parent = create_surface("parent");
+    create_surface("child", parent);
+
+    replay();
+
+    auto const windows = replayed_windows();
+    ASSERT_THAT(windows.size(), Eq(2u));
+
+    auto const& parent_info = window_manager_tools.info_for(windows[0]);
+    auto const& child_info = window_manager_tools.info_for(windows[1]);
+    EXPECT_THAT(parent_info.name(), Eq("parent"));
+    EXPECT_THAT(child_info.parent(), Eq(windows[0]));
+}
+
+TEST_F(WindowManagerRecording, removed_windows_are_removed_on_replay)
+{
+    auto const surface = create_surface("a window");
+    create_surface("another window");
+    recorder.remove_surface(recorded_session, surface);
+
+    replay();
+
+    auto const windows = replayed_windows();
+    ASSERT_THAT(windows.size(), Eq(1u));
+    EXPECT_THAT(window_manager_tools.info_for(windows[0]).name(), Eq("another window"));
+}
+
+TEST_F(WindowManagerRecording, surfaces_becoming_ready_are_replayed)
+{
+    auto const surface = create_surface("a window");
+    std::static_pointer_cast<StubSurface>(surface)->post_frame();
+
+    EXPECT_CALL(*window_manager_policy, handle_window_ready(Property(&WindowInfo::name, Eq("a window"))));
+
+    EXPECT_THAT(replay(), Eq(4u));
+}
+
+TEST_F(WindowManagerRecording, pointer_events_are_replayed)
+{
+    auto const event = mir::events::make_event(
+        MirInputDeviceId{7}, std::chrono::nanoseconds{42}, std::vector<uint8_t>{}, mir_input_event_modifier_none,
+        mir_pointer_action_motion, mir_pointer_button_primary, 12.5f, 34.5f, 0.0f, 0.0f, 1.0f, -1.0f);
+
+    recorder.handle_pointer_event(mir_input_event_get_pointer_event(mir_event_get_input_event(event.get())));
+
+    EXPECT_CALL(*window_manager_policy, handle_pointer_event(_)).WillOnce(Invoke([](MirPointerEvent const* event)
+        {
+            EXPECT_THAT(mir_input_event_get_event_time(mir_pointer_event_input_event(event)), Eq(42));
+            EXPECT_THAT(mir_pointer_event_action(event), Eq(mir_pointer_action_motion));
+            EXPECT_THAT(mir_pointer_event_buttons(event), Eq(mir_pointer_button_primary));
+            EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_x), Eq(12.5f));
+            EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_y), Eq(34.5f));
+            EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y), Eq(-1.0f));
+            return false;
+        }));
+
+    replay();
+}
+
+TEST_F(WindowManagerRecording, a_truncated_recording_is_rejected)
+{
+    create_surface("a window");
+    recorder.flush();
+
+    auto const bytes = recording->str();
+    std::istringstream in{bytes.substr(0, bytes.size() - 3)};
+    WindowManagerReplay replay{basic_window_manager, [this](std::string const&) { return session; }};
+
+    EXPECT_THROW(replay.replay(in), std::runtime_error);
+}
+
+TEST_F(WindowManagerRecording, other_files_are_rejected)
+{
+    std::istringstream in{"not a recording"};
+    WindowManagerReplay replay{basic_window_manager, [this](std::string const&) { return session; }};
+
+    EXPECT_THROW(replay.replay(in), std::runtime_error);
+}
+
+TEST_F(WindowManagerRecording, recording_stops_when_writing_fails_but_calls_are_still_handled)
+{
+    recording->setstate(std::ios::badbit);
+
+    auto const surface = create_surface("a window");
+
+    EXPECT_FALSE(recorder.is_recording());
+    EXPECT_THAT(surface, NotNull());
+    EXPECT_THAT(create_surface("another window"), NotNull());
+}
+
+TEST_F(WindowManagerRecording, a_stream_that_cannot_be_written_is_rejected)
+{
+    auto const bad_stream = std::make_shared<std::stringstream>();
+    bad_stream->setstate(std::ios::badbit);
+
+    EXPECT_THROW((WindowManagerRecorder{recorded_window_manager, bad_stream}), std::runtime_error);
+}
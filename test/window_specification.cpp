@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include <miral/window_specification.h>
+
+#include <mir/shell/surface_specification.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace mir::geometry;
+using miral::WindowSpecification;
+
+namespace
+{
+auto surface_specification() -> mir::shell::SurfaceSpecification
+{
+    mir::shell::SurfaceSpecification result;
+    result.name = "original";
+    result.width = Width{100};
+    result.height = Height{200};
+    result.input_shape = std::vector<Rectangle>{{{0, 0}, {100, 10}}};
+    return result;
+}
+}
+
+TEST(WindowSpecification, is_converted_from_a_surface_specification)
+{
+    WindowSpecification const spec{surface_specification()};
+
+    EXPECT_THAT(spec.name().value(), Eq("original"));
+    EXPECT_THAT(spec.size().value(), Eq(Size{100, 200}));
+    EXPECT_THAT(spec.input_shape().value(), ElementsAre(Rectangle{{0, 0}, {100, 10}}));
+    EXPECT_FALSE(spec.top_left().is_set());
+    EXPECT_FALSE(spec.userdata().is_set());
+}
+
+TEST(WindowSpecification, modifying_a_copy_does_not_modify_the_original)
+{
+    WindowSpecification const original{surface_specification()};
+    WindowSpecification copy{original};
+
+    copy.name() = "copy";
+    copy.size() = Size{1, 2};
+    copy.input_shape().consume();
+
+    EXPECT_THAT(original.name().value(), Eq("original"));
+    EXPECT_THAT(original.size().value(), Eq(Size{100, 200}));
+    EXPECT_TRUE(original.input_shape().is_set());
+
+    EXPECT_THAT(copy.name().value(), Eq("copy"));
+    EXPECT_THAT(copy.size().value(), Eq(Size{1, 2}));
+    EXPECT_FALSE(copy.input_shape().is_set());
+}
+
+TEST(WindowSpecification, modifying_the_original_does_not_modify_a_copy)
+{
+    WindowSpecification original{surface_specification()};
+    WindowSpecification copy;
+    copy = original;
+
+    original.name() = "modified";
+
+    EXPECT_THAT(copy.name().value(), Eq("original"));
+}
+
+TEST(WindowSpecification, copies_are_not_modified_through_a_reference_obtained_earlier)
+{
+    WindowSpecification original;
+    auto& name = original.name();
+    name = "before";
+
+    WindowSpecification const copy{original};
+    name = "after";
+
+    EXPECT_THAT(copy.name().value(), Eq("before"));
+    EXPECT_THAT(original.name().value(), Eq("after"));
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include <miral/window_specification.h>
+
+#include <mir/shell/surface_specification.h>
+
+#include <benchmark/benchmark.h>
+
+using miral::WindowSpecification;
+
+namespace
+{
+// What a client sends when it is resized
+auto resize_specification() -> mir::shell::SurfaceSpecification
+{
+    mir::shell::SurfaceSpecification result;
+    result.width = mir::geometry::Width{640};
+    result.height = mir::geometry::Height{480};
+    return result;
+}
+
+// A specification that also sets fields that are costly to copy
+auto surface_specification() -> mir::shell::SurfaceSpecification
+{
+    mir::shell::SurfaceSpecification result;
+    result.name = "A window with a longish title to defeat the small string optimization";
+    result.width = mir::geometry::Width{640};
+    result.height = mir::geometry::Height{480};
+    result.input_shape = std::vector<mir::geometry::Rectangle>{{{0, 0}, {640, 480}}};
+    return result;
+}
+
+// What a policy does for a resize drag
+void construct(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        WindowSpecification modifications;
+        modifications.top_left() = mir::geometry::Point{10, 10};
+        modifications.size() = mir::geometry::Size{640, 480};
+        benchmark::DoNotOptimize(modifications.size().value());
+    }
+}
+
+// What a policy does with "auto mods = modifications"
+void copy(benchmark::State& state)
+{
+    WindowSpecification const modifications{surface_specification()};
+
+    for (auto _ : state)
+    {
+        auto const mods = modifications;
+        benchmark::DoNotOptimize(mods.name().value());
+    }
+}
+
+// Copying and adjusting a field that isn't shared
+void copy_and_modify(benchmark::State& state)
+{
+    WindowSpecification const modifications{surface_specification()};
+
+    for (auto _ : state)
+    {
+        auto mods = modifications;
+        mods.top_left() = mir::geometry::Point{10, 10};
+        benchmark::DoNotOptimize(mods.top_left().value());
+    }
+}
+
+// What BasicWindowManager::modify_surface() does for every client request
+void convert_resize(benchmark::State& state)
+{
+    auto const modifications = resize_specification();
+
+    for (auto _ : state)
+    {
+        WindowSpecification mods{modifications};
+        benchmark::DoNotOptimize(mods.size().value());
+    }
+}
+
+void convert(benchmark::State& state)
+{
+    auto const modifications = surface_specification();
+
+    for (auto _ : state)
+    {
+        WindowSpecification mods{modifications};
+        benchmark::DoNotOptimize(mods.size().value());
+    }
+}
+}
+
+BENCHMARK(construct);
+BENCHMARK(copy);
+BENCHMARK(copy_and_modify);
+BENCHMARK(convert_resize);
+BENCHMARK(convert);
@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/window_tree_walker.h"
+
+#include <mir/test/doubles/stub_surface.h>
+#include <mir/test/doubles/stub_session.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <map>
+
+using namespace testing;
+using miral::Window;
+using miral::WindowInfo;
+
+namespace
+{
+// WindowInfo needs these to be set
+auto window_specification() -> miral::WindowSpecification
+{
+    miral::WindowSpecification result;
+    result.name() = "";
+    result.top_left() = mir::geometry::Point{};
+    result.size() = mir::geometry::Size{};
+    return result;
+}
+
+struct WindowTreeWalker : Test
+{
+    miral::Application const app{std::make_shared<mir::test::doubles::StubSession>()};
+    std::vector<std::shared_ptr<mir::scene::Surface>> surfaces;
+    std::vector<Window> windows;
+    std::map<Window, WindowInfo> info;
+    miral::WindowTreeScratch scratch;
+
+    // Creates window number n (and its info), optionally as a child of window number parent
+    Window const& add_window(int parent = -1)
+    {
+        surfaces.push_back(std::make_shared<mir::test::doubles::StubSurface>());
+        windows.emplace_back(app, surfaces.back());
+
+        auto& window = windows.back();
+        info.emplace(std::piecewise_construct, std::forward_as_tuple(window), std::forward_as_tuple(window, window_specification()));
+
+        if (parent >= 0)
+        {
+            info.at(window).parent(windows[parent]);
+            info.at(windows[parent]).add_child(window);
+        }
+
+        return window;
+    }
+
+    auto info_for() -> std::function<WindowInfo const&(Window const&)>
+    {
+        return [this](Window const& window) -> WindowInfo const& { return info.at(window); };
+    }
+};
+}
+
+TEST_F(WindowTreeWalker, collects_a_window_without_children)
+{
+    auto const window = add_window();
+
+    miral::WindowTreeWalker walker{scratch};
+
+    EXPECT_THAT(walker.collect(window, info_for()), ElementsAre(window));
+}
+
+TEST_F(WindowTreeWalker, collects_descendants_parents_first_and_children_in_order)
+{
+    windows.reserve(7);
+    add_window();   // 0
+    add_window(0);  // 1
+    add_window(1);  // 2
+    add_window(2);  // 3
+    add_window(0);  // 4
+    add_window(4);  // 5
+    add_window(1);  // 6
+
+    miral::WindowTreeWalker walker{scratch};
+
+    EXPECT_THAT(walker.collect(windows[0], info_for()),
+        ElementsAre(windows[0], windows[1], windows[2], windows[3], windows[6], windows[4], windows[5]));
+
+    EXPECT_THAT(walker.collect(windows[4], info_for()), ElementsAre(windows[4], windows[5]));
+}
+
+TEST_F(WindowTreeWalker, collects_for_raising_from_the_topmost_ancestor_with_the_branch_last)
+{
+    windows.reserve(7);
+    add_window();   // 0
+    add_window(0);  // 1
+    add_window(1);  // 2
+    add_window(2);  // 3
+    add_window(0);  // 4
+    add_window(4);  // 5
+    add_window(1);  // 6
+
+    miral::WindowTreeWalker walker{scratch};
+
+    EXPECT_THAT(walker.collect_raising(windows[2], info_for()),
+        ElementsAre(windows[0], windows[4], windows[5], windows[1], windows[6], windows[2], windows[3]));
+    EXPECT_THAT(walker.raising_branch(), ElementsAre(windows[0], windows[1], windows[2]));
+
+    std::vector<Window> const whole_tree = walker.collect(windows[0], info_for());
+    EXPECT_THAT(walker.collect_raising(windows[0], info_for()), ContainerEq(whole_tree));
+}
+
+TEST_F(WindowTreeWalker, walks_deep_trees)
+{
+    auto const depth = 100000;
+    windows.reserve(depth);
+
+    add_window();
+    for (auto i = 1; i != depth; ++i)
+        add_window(i-1);
+
+    miral::WindowTreeWalker walker{scratch};
+
+    EXPECT_THAT(walker.collect(windows[0], info_for()), ContainerEq(windows));
+    EXPECT_THAT(walker.collect_raising(windows.back(), info_for()), ContainerEq(windows));
+}
+
+TEST_F(WindowTreeWalker, nested_walk_does_not_disturb_outer_walk)
+{
+    windows.reserve(3);
+    add_window();
+    add_window(0);
+    add_window();
+
+    miral::WindowTreeWalker outer{scratch};
+    auto const& outer_windows = outer.collect(windows[0], info_for());
+
+    {
+        miral::WindowTreeWalker inner{scratch};
+        EXPECT_THAT(inner.collect(windows[2], info_for()), ElementsAre(windows[2]));
+    }
+
+    EXPECT_THAT(outer_windows, ElementsAre(windows[0], windows[1]));
+}
+
+TEST_F(WindowTreeWalker, scratch_storage_is_kept_between_walks)
+{
+    windows.reserve(10);
+    add_window();
+    for (auto i = 1; i != 10; ++i)
+        add_window(0);
+
+    {
+        miral::WindowTreeWalker walker{scratch};
+        walker.collect(windows[0], info_for());
+    }
+
+    auto const capacity = scratch.windows.capacity();
+    EXPECT_THAT(capacity, Ge(windows.size()));
+    EXPECT_THAT(scratch.windows.size(), Eq(0u));
+
+    {
+        miral::WindowTreeWalker walker{scratch};
+        walker.collect(windows[0], info_for());
+    }
+
+    EXPECT_THAT(scratch.windows.capacity(), Eq(capacity));
+}
+
+TEST_F(WindowTreeWalker, selected_storage_is_kept_between_walks)
+{
+    windows.reserve(10);
+    add_window();
+    for (auto i = 1; i != 10; ++i)
+        add_window(0);
+
+    {
+        miral::WindowTreeWalker walker{scratch};
+        auto& selected = walker.selected();
+        for (auto const& window : walker.collect(windows[0], info_for()))
+            selected.push_back(window);
+    }
+
+    auto const capacity = scratch.selected.capacity();
+    EXPECT_THAT(capacity, Ge(windows.size()));
+
+    {
+        miral::WindowTreeWalker walker{scratch};
+        EXPECT_THAT(walker.selected(), IsEmpty());
+    }
+
+    EXPECT_THAT(scratch.selected.capacity(), Eq(capacity));
+}
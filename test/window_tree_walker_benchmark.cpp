@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/window_tree_walker.h"
+
+#include <mir/test/doubles/stub_surface.h>
+#include <mir/test/doubles/stub_session.h>
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <map>
+
+namespace
+{
+using namespace miral;
+
+// WindowInfo needs these to be set
+auto window_specification() -> WindowSpecification
+{
+    WindowSpecification result;
+    result.name() = "";
+    result.top_left() = mir::geometry::Point{};
+    result.size() = mir::geometry::Size{};
+    return result;
+}
+
+// A root window with 1000 descendants: either a single chain (nested menus) or a
+// tree in which each window has up to "fan_out" children (dialogs of dialogs)
+struct Fixture
+{
+    static auto const descendants = 1000;
+
+    explicit Fixture(int fan_out) : app{std::make_shared<mir::test::doubles::StubSession>()}
+    {
+        windows.reserve(descendants + 1);
+
+        for (auto i = 0; i != descendants + 1; ++i)
+        {
+            surfaces.push_back(std::make_shared<mir::test::doubles::StubSurface>());
+            windows.emplace_back(app, surfaces.back());
+
+            auto const& window = windows.back();
+            info.emplace(
+                std::piecewise_construct, std::forward_as_tuple(window), std::forward_as_tuple(window, window_specification()));
+
+            if (i)
+            {
+                auto const& parent = windows[(i-1)/fan_out];
+                info.at(window).parent(parent);
+                info.at(parent).add_child(window);
+            }
+        }
+    }
+
+    auto info_for(Window const& window) const -> WindowInfo const& { return info.at(window); }
+
+    Application const app;
+    std::vector<std::shared_ptr<mir::scene::Surface>> surfaces;
+    std::vector<Window> windows;
+    std::map<Window, WindowInfo> info;
+};
+
+// What raise_tree() used to do
+void raise_tree_recursive(benchmark::State& state)
+{
+    Fixture const fixture(state.range(0));
+    auto const& root = fixture.windows.front();
+
+    for (auto _ : state)
+    {
+        std::vector<Window> windows;
+
+        std::function<void(WindowInfo const& info)> const add_children =
+            [&](WindowInfo const& info)
+                {
+                    for (auto const& child : info.children())
+                    {
+                        windows.push_back(child);
+                        add_children(fixture.info_for(child));
+                    }
+                };
+
+        windows.push_back(root);
+        add_children(fixture.info_for(root));
+
+        benchmark::DoNotOptimize(windows.data());
+    }
+
+    state.SetItemsProcessed(state.iterations()*(Fixture::descendants + 1));
+}
+
+void raise_tree_walker(benchmark::State& state)
+{
+    Fixture const fixture(state.range(0));
+    auto const& root = fixture.windows.front();
+    WindowTreeScratch scratch;
+
+    for (auto _ : state)
+    {
+        WindowTreeWalker walker{scratch};
+        auto const& windows = walker.collect(root, [&](Window const& window) -> WindowInfo const&
+            { return fixture.info_for(window); });
+
+        benchmark::DoNotOptimize(windows.data());
+    }
+
+    state.SetItemsProcessed(state.iterations()*(Fixture::descendants + 1));
+}
+}
+
+// The argument is the number of children of each window
+BENCHMARK(raise_tree_recursive)->Arg(1)->Arg(4)->Arg(Fixture::descendants);
+BENCHMARK(raise_tree_walker)->Arg(1)->Arg(4)->Arg(Fixture::descendants);
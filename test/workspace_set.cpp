@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Alan Griffiths <alan@octopull.co.uk>
+ */
+
+#include "../miral/workspace_set.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace
+{
+struct WorkspaceSet : Test
+{
+    miral::WorkspaceSet set;
+    miral::WorkspaceSet other;
+};
+}
+
+TEST_F(WorkspaceSet, when_created_is_empty)
+{
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(0));
+    EXPECT_FALSE(set.intersects(other));
+}
+
+TEST_F(WorkspaceSet, contains_inserted_ids)
+{
+    set.insert(0);
+    set.insert(63);
+    set.insert(64);
+    set.insert(200);
+
+    EXPECT_FALSE(set.empty());
+    EXPECT_TRUE(set.contains(0));
+    EXPECT_TRUE(set.contains(63));
+    EXPECT_TRUE(set.contains(64));
+    EXPECT_TRUE(set.contains(200));
+    EXPECT_FALSE(set.contains(1));
+    EXPECT_FALSE(set.contains(199));
+    EXPECT_FALSE(set.contains(1000));
+}
+
+TEST_F(WorkspaceSet, does_not_contain_erased_ids)
+{
+    set.insert(7);
+    set.insert(100);
+
+    set.erase(7);
+    set.erase(100);
+    set.erase(1000);
+
+    EXPECT_FALSE(set.contains(7));
+    EXPECT_FALSE(set.contains(100));
+    EXPECT_TRUE(set.empty());
+}
+
+TEST_F(WorkspaceSet, sets_sharing_an_id_intersect)
+{
+    set.insert(1);
+    set.insert(2);
+    other.insert(2);
+    other.insert(3);
+
+    EXPECT_TRUE(set.intersects(other));
+    EXPECT_TRUE(other.intersects(set));
+}
+
+TEST_F(WorkspaceSet, sets_sharing_a_large_id_intersect)
+{
+    set.insert(1);
+    set.insert(130);
+    other.insert(2);
+    other.insert(130);
+
+    EXPECT_TRUE(set.intersects(other));
+}
+
+TEST_F(WorkspaceSet, disjoint_sets_do_not_intersect)
+{
+    set.insert(1);
+    set.insert(130);
+    other.insert(2);
+    other.insert(65);
+
+    EXPECT_FALSE(set.intersects(other));
+    EXPECT_FALSE(other.intersects(set));
+}
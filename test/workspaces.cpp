@@ -681,3 +681,20 @@ TEST_F(Workspaces, when_workspace_content_is_moved_the_policy_is_notified)
             tools.move_workspace_content_to_workspace(to_workspace, from_workspace);
         });
 }
+
+TEST_F(Workspaces, when_workspace_is_closed_its_surfaces_can_be_added_to_a_new_workspace)
+{
+    auto workspace = create_workspace();
+
+    invoke_tools([&, this](WindowManagerTools& tools)
+        { tools.add_tree_to_workspace(server_window(dialog), workspace); });
+
+    workspace.reset();
+    auto const new_workspace = create_workspace();
+
+    invoke_tools([&, this](WindowManagerTools& tools)
+        { tools.add_tree_to_workspace(server_window(dialog), new_workspace); });
+
+    EXPECT_THAT(windows_in_workspace(new_workspace),
+        ElementsAre(server_window(top_level), server_window(dialog), server_window(tip)));
+}